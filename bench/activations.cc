@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Per-layer activation functions.
+ *
+ * Trains the same synthetic regression with every hidden activation,
+ * each net starting from the same weights, and prints the mean RMS
+ * error every few epochs, then the samples/s.  A linear output layer
+ * diverges at the fixed learning rate of the net, so it is left out.
+ * Then it trains classifiers with sigmoid and softmax output layers
+ * and prints their accuracy.  Finally it saves a net that mixes
+ * activations and checks that the loaded net and an InferenceModel of
+ * the file give the same outputs.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <activation.hh>
+#include <data_set.hh>
+#include <inference_model.hh>
+#include <net.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const unsigned kSeed = 1;
+const unsigned kTopology[] = {16, 16, 4};
+const unsigned kSamples = 4096;
+const unsigned kEpochs = 10;
+const unsigned kReportEvery = 2;
+const unsigned kClasses = 4;
+const char* kModelFile = "/tmp/minann_activations.model";
+
+
+// Synthetic set: a smooth function of the inputs, squashed to (-1, 1),
+// or as many one-hot classes as outputs, the largest of those values
+MinAnn::DataSet
+Synthetic(bool classes)
+{
+    std::vector<unsigned> topology(
+        kTopology, kTopology + sizeof(kTopology) / sizeof(kTopology[0]));
+    MinAnn::DataSet data_set(topology);
+    std::vector<double> input_values(topology.front());
+    std::vector<double> target_values(topology.back());
+
+    srand(kSeed);
+    for (unsigned s = 0; s < kSamples; ++s) {
+        for (unsigned i = 0; i < input_values.size(); ++i) {
+            input_values[i] = 2.0f * rand() / RAND_MAX - 1.0f;
+        }
+        unsigned best = 0;
+        for (unsigned n = 0; n < target_values.size(); ++n) {
+            double sum = 0.0f;
+            for (unsigned i = n; i < input_values.size(); i += 4) {
+                sum += input_values[i] * ((i + n) % 3 == 0 ? -1.0f : 1.0f);
+            }
+            target_values[n] = tanh(0.25f * sum);
+            if (target_values[n] > target_values[best]) {
+                best = n;
+            }
+        }
+        if (classes) {
+            for (unsigned n = 0; n < target_values.size(); ++n) {
+                target_values[n] = n == best ? 1.0f : 0.0f;
+            }
+        }
+        data_set.Add(&input_values[0], &target_values[0]);
+    }
+
+    return data_set;
+}
+
+
+// Mean RMS error of a net over a data set, and share of samples whose
+// largest output is that of the largest target
+void
+Evaluate(MinAnn::Net& net, const MinAnn::DataSet& data_set,
+         double& error, double& accuracy)
+{
+    unsigned num_inputs = data_set.Topology().front();
+    unsigned num_outputs = data_set.Topology().back();
+    std::vector<double> input_values, result_values;
+    unsigned hits = 0;
+
+    error = 0.0f;
+    for (std::size_t s = 0; s < data_set.NumSamples(); ++s) {
+        const double* targets = data_set.Targets(s);
+
+        input_values.assign(data_set.Inputs(s),
+                            data_set.Inputs(s) + num_inputs);
+        net.FeedForward(input_values);
+        net.Results(result_values);
+
+        double sum = 0.0f;
+        unsigned best = 0, expected = 0;
+        for (unsigned n = 0; n < num_outputs; ++n) {
+            double delta = targets[n] - result_values[n];
+            sum += delta * delta;
+            best = result_values[n] > result_values[best] ? n : best;
+            expected = targets[n] > targets[expected] ? n : expected;
+        }
+        error += sqrt(sum / num_outputs);
+        hits += best == expected;
+    }
+    error /= data_set.NumSamples();
+    accuracy = (double) hits / data_set.NumSamples();
+}
+
+
+// Train online for some epochs and print speed and progress
+void
+Run(const MinAnn::DataSet& data_set, bool classes,
+    MinAnn::Activation hidden, MinAnn::Activation output)
+{
+    unsigned num_inputs = data_set.Topology().front();
+    unsigned num_outputs = data_set.Topology().back();
+    std::vector<MinAnn::Activation> activations(data_set.Topology().size(),
+                                                hidden);
+    activations.back() = output;
+    std::vector<double> input_values, target_values;
+    double seconds = 0.0f;
+
+    srand(kSeed);
+    MinAnn::Net net(data_set.Topology(), activations);
+
+    printf("%-10s %-8s", MinAnn::ActivationFunction::Name(hidden),
+           MinAnn::ActivationFunction::Name(output));
+    for (unsigned e = 1; e <= kEpochs; ++e) {
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        for (std::size_t s = 0; s < data_set.NumSamples(); ++s) {
+            input_values.assign(data_set.Inputs(s),
+                                data_set.Inputs(s) + num_inputs);
+            target_values.assign(data_set.Targets(s),
+                                 data_set.Targets(s) + num_outputs);
+            net.FeedForward(input_values);
+            net.BackPropagation(target_values);
+        }
+        seconds += Bench::Seconds(start);
+
+        if (e % kReportEvery == 0) {
+            double error, accuracy;
+            Evaluate(net, data_set, error, accuracy);
+            printf(" %9.6f", classes ? accuracy : error);
+        }
+    }
+    printf(" %12.0f\n", kEpochs * data_set.NumSamples() / seconds);
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    MinAnn::DataSet regression = Synthetic(false);
+    MinAnn::DataSet classification = Synthetic(true);
+
+    printf("# mean error every %u epochs, then samples/s\n", kReportEvery);
+    Run(regression, false, MinAnn::kTanh, MinAnn::kTanh);
+    Run(regression, false, MinAnn::kSigmoid, MinAnn::kTanh);
+    Run(regression, false, MinAnn::kRelu, MinAnn::kTanh);
+    Run(regression, false, MinAnn::kLeakyRelu, MinAnn::kTanh);
+
+    printf("# accuracy every %u epochs, then samples/s\n", kReportEvery);
+    Run(classification, true, MinAnn::kTanh, MinAnn::kSigmoid);
+    Run(classification, true, MinAnn::kTanh, MinAnn::kSoftmax);
+    Run(classification, true, MinAnn::kRelu, MinAnn::kSoftmax);
+
+    // Activations survive a round trip through a model file
+    std::vector<unsigned> topology = {8, 16, 16, 4};
+    std::vector<MinAnn::Activation> activations = {
+        MinAnn::kLinear, MinAnn::kRelu, MinAnn::kSigmoid, MinAnn::kSoftmax
+    };
+    srand(kSeed);
+    MinAnn::Net net(topology, activations);
+    MinAnn::Net loaded(topology);
+    bool same = net.Save(kModelFile) && loaded.Load(kModelFile) &&
+        loaded.Activations() == net.Activations();
+    MinAnn::InferenceModel model(kModelFile);
+    same = same && model.IsOpen();
+
+    std::vector<double> input_values(topology.front(), 0.5f);
+    std::vector<double> results, loaded_results;
+    std::vector<double> model_results(topology.back());
+    net.FeedForward(input_values);
+    net.Results(results);
+    loaded.FeedForward(input_values);
+    loaded.Results(loaded_results);
+    if (same) {
+        model.Predict(&input_values[0], &model_results[0]);
+    }
+    same = same && results == loaded_results && results == model_results;
+    remove(kModelFile);
+    printf("round trip: %s\n", same ? "yes" : "NO");
+
+    return same ? 0 : 1;
+}
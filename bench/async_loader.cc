@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Overlapping training data reads with training.
+ *
+ * Writes a training file (16 MiB by default, or the number of MiB given
+ * as first argument) to the temporary directory, then trains a net on
+ * it in batches twice: reading each batch right before training on it,
+ * and reading ahead with 'AsyncLoader' at several queue depths.  Prints
+ * samples/s and the stall counters of both sides of the queue.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <async_loader.hh>
+#include <net.hh>
+#include <training_data.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const char* kFileName = "/tmp/minann_bench_loader.dat";
+const unsigned kBatchSize = 64;
+const unsigned kDepths[] = {2, 4, 8};
+
+
+// Read a batch of samples back to back; returns how many
+unsigned
+ReadBatch(TrainingData& training_data,
+          const std::vector<unsigned>& topology,
+          std::vector<double>& inputs, std::vector<double>& targets)
+{
+    std::vector<double> values;
+    unsigned size = 0;
+
+    inputs.clear();
+    targets.clear();
+    while (size < kBatchSize && !training_data.IsEof()) {
+        if (training_data.NextInputs(values) != topology.front()) {
+            break;
+        }
+        inputs.insert(inputs.end(), values.begin(), values.end());
+        training_data.TargetOutputs(values);
+        targets.insert(targets.end(), values.begin(), values.end());
+        ++size;
+    }
+
+    return size;
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(int argc, char* argv[])
+{
+    unsigned long megabytes = argc > 1 ? atol(argv[1]) : 16;
+    unsigned long target_size = megabytes << 20;
+
+    // Generate a file shaped like 'training_data.dat', but wider
+    std::FILE* file = std::fopen(kFileName, "w");
+    if (file == 0) {
+        perror(kFileName);
+        return 1;
+    }
+    unsigned long size = std::fprintf(file, "Topology: 16 32 8\n");
+    srand(1);
+    while (size < target_size) {
+        size += std::fprintf(file, "i:");
+        for (unsigned i = 0; i < 16; ++i) {
+            size += std::fprintf(file, " %.5f", rand() / double(RAND_MAX));
+        }
+        size += std::fprintf(file, "\no:");
+        for (unsigned i = 0; i < 8; ++i) {
+            size += std::fprintf(file, " %.5f", rand() / double(RAND_MAX));
+        }
+        size += std::fprintf(file, "\n");
+    }
+    std::fclose(file);
+
+    std::vector<unsigned> topology;
+    std::vector<double> inputs, targets;
+    unsigned long samples = 0;
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    {
+        TrainingData training_data(kFileName);
+        training_data.Topology(topology);
+        MinAnn::Net net(topology);
+
+        while (unsigned batch_size =
+                   ReadBatch(training_data, topology, inputs, targets)) {
+            net.TrainBatch(inputs, targets, batch_size);
+            samples += batch_size;
+        }
+    }
+    double seconds = Bench::Seconds(start);
+
+    printf("# %.1f MB of training data, %lu samples, batches of %u\n",
+           size / 1e6, samples, kBatchSize);
+    printf("%-8s %6s %10s %12s %10s %10s\n", "loader", "depth", "seconds",
+           "samples/s", "p-stalls", "c-stalls");
+    printf("%-8s %6s %10.3f %12.0f %10s %10s\n", "serial", "-", seconds,
+           samples / seconds, "-", "-");
+
+    for (unsigned d = 0; d < sizeof(kDepths) / sizeof(kDepths[0]); ++d) {
+        start = std::chrono::steady_clock::now();
+
+        TrainingData training_data(kFileName);
+        MinAnn::AsyncLoader loader(training_data, kBatchSize, kDepths[d]);
+        MinAnn::Net net(loader.Topology());
+        unsigned long loaded = 0;
+
+        while (const MinAnn::AsyncLoader::Batch* batch = loader.Next()) {
+            net.TrainBatch(batch->inputs, batch->targets, batch->size);
+            loaded += batch->size;
+        }
+        seconds = Bench::Seconds(start);
+
+        printf("%-8s %6u %10.3f %12.0f %10lu %10lu\n", "async", kDepths[d],
+               seconds, loaded / seconds, loader.ProducerStalls(),
+               loader.ConsumerStalls());
+        if (loaded != samples) {
+            std::remove(kFileName);
+            return 1;
+        }
+    }
+
+    std::remove(kFileName);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+/*
+ * Throughput of batched inference.
+ *
+ * Scores random rows against a read-only model one row at a time and
+ * in batches of several sizes, on the calling thread and on a pool of
+ * threads (as many as the hardware concurrency, or the first argument
+ * when given), and prints rows per second.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <inference_model.hh>
+#include <net.hh>
+#include <thread_pool.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const unsigned kNumRows = 16384;
+
+} // ! namespace
+
+
+// Main entry
+int main(int argc, char* argv[])
+{
+    unsigned num_threads = argc > 1
+        ? (unsigned) atoi(argv[1])
+        : std::thread::hardware_concurrency();
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+
+    std::vector<unsigned> topology = {64, 256, 256, 8};
+    srand(1);
+    MinAnn::Net net(topology);
+    MinAnn::InferenceModel model(net);
+    MinAnn::ThreadPool pool(num_threads);
+
+    std::vector<double> input_values(kNumRows * model.NumInputs());
+    std::vector<double> single(kNumRows * model.NumOutputs());
+    std::vector<double> batched(kNumRows * model.NumOutputs());
+    for (unsigned i = 0; i < input_values.size(); ++i) {
+        input_values[i] = rand() / double(RAND_MAX);
+    }
+
+    printf("# topology 64-256-256-8, %u rows, %u threads\n",
+           kNumRows, num_threads);
+    printf("%-10s %8s %14s %12s\n", "mode", "batch", "rows/s", "max diff");
+
+    // One row at a time, the reference for every other mode
+    MinAnn::InferenceModel::Context context(model);
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < kNumRows; ++r) {
+        model.Predict(&input_values[r * model.NumInputs()],
+                      &single[r * model.NumOutputs()], context);
+    }
+    printf("%-10s %8u %14.0f %12s\n", "row", 1u,
+           kNumRows / Bench::Seconds(start), "-");
+
+    const unsigned batch_sizes[] = {1, 8, 64, 512, 4096, kNumRows};
+    for (unsigned threaded = 0; threaded < 2; ++threaded) {
+        for (unsigned b = 0; b < sizeof(batch_sizes) / sizeof(unsigned);
+             ++b) {
+            unsigned batch_size = batch_sizes[b];
+
+            start = std::chrono::steady_clock::now();
+            for (unsigned first = 0; first < kNumRows; first += batch_size) {
+                const double* inputs =
+                    &input_values[first * model.NumInputs()];
+                double* outputs = &batched[first * model.NumOutputs()];
+
+                if (threaded) {
+                    model.Predict(inputs, batch_size, outputs, pool);
+                } else {
+                    model.Predict(inputs, batch_size, outputs);
+                }
+            }
+            double seconds = Bench::Seconds(start);
+
+            double diff = 0.0f;
+            for (unsigned i = 0; i < batched.size(); ++i) {
+                diff = std::max(diff, fabs(batched[i] - single[i]));
+            }
+            printf("%-10s %8u %14.0f %12.3g\n",
+                   threaded ? "batch/pool" : "batch", batch_size,
+                   kNumRows / seconds, diff);
+        }
+    }
+
+    return 0;
+}
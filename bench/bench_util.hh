@@ -0,0 +1,102 @@
+/**
+ * @file bench_util.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+
+#ifndef BENCH_UTIL_HH
+#define BENCH_UTIL_HH
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <data_set.hh>
+
+
+/**
+ * @brief Helpers shared by the benchmarks; not part of the library
+ */
+namespace Bench {
+
+/**
+ * @brief Seconds elapsed since @e start
+ */
+inline double
+Seconds(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+
+/**
+ * @brief Synthetic regression set: a smooth function of the inputs,
+ *        squashed to (-1, 1)
+ *
+ * @details Inputs are uniform in [-1, 1), drawn with @c rand() after
+ *          seeding it with @e seed.
+ *
+ * @param layers     Topology of the net, @e num_layers sizes
+ */
+inline MinAnn::DataSet
+Synthetic(const unsigned* layers, unsigned num_layers, unsigned samples,
+          unsigned seed)
+{
+    std::vector<unsigned> topology(layers, layers + num_layers);
+    MinAnn::DataSet data_set(topology);
+    std::vector<double> input_values(topology.front());
+    std::vector<double> target_values(topology.back());
+
+    srand(seed);
+    for (unsigned s = 0; s < samples; ++s) {
+        for (unsigned i = 0; i < input_values.size(); ++i) {
+            input_values[i] = 2.0f * rand() / RAND_MAX - 1.0f;
+        }
+        for (unsigned n = 0; n < target_values.size(); ++n) {
+            double sum = 0.0f;
+            for (unsigned i = n; i < input_values.size(); i += 4) {
+                sum += input_values[i] * ((i + n) % 3 == 0 ? -1.0f : 1.0f);
+            }
+            target_values[n] = tanh(0.25f * sum);
+        }
+        data_set.Add(&input_values[0], &target_values[0]);
+    }
+
+    return data_set;
+}
+
+} // ! namespace Bench
+
+
+#endif // ! BENCH_UTIL_HH
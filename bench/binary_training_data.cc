@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+/*
+ * Binary training files.
+ *
+ * Converts a small text data set, whose last chunk is a short one, and
+ * checks that the mapped file holds the same samples.  Then checks that
+ * an empty file, a truncated one and files whose header offsets, chunk
+ * size or sample count would wrap around are all rejected.
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdint.h>
+#include <vector>
+
+#include <binary_training_data.hh>
+#include <training_data.hh>
+
+
+namespace {
+
+const unsigned kNumInputs = 3;
+const unsigned kNumOutputs = 2;
+const unsigned kNumSamples = 10;
+const uint64_t kChunkSize = 4;
+const char* kTextFile = "/tmp/minann_bench_binary_training_data.dat";
+const char* kBinaryFile = "/tmp/minann_bench_binary_training_data.bin";
+const char* kBadFile = "/tmp/minann_bench_binary_training_data.bad";
+
+
+// Values exact in both text and binary, different for every sample
+double
+Value(unsigned sample, unsigned n)
+{
+    return (sample * 8 + n) / 8.0f - 4.0f;
+}
+
+
+std::vector<char>
+ReadFile(const char* filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+
+    return std::vector<char>(std::istreambuf_iterator<char>(file),
+                             std::istreambuf_iterator<char>());
+}
+
+
+void
+WriteFile(const char* filename, const std::vector<char>& bytes)
+{
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+
+    file.write(bytes.empty() ? "" : &bytes[0], bytes.size());
+}
+
+
+// Whether the file is refused
+bool
+Rejected(const char* label, const std::vector<char>& bytes)
+{
+    WriteFile(kBadFile, bytes);
+    bool rejected = !BinaryTrainingData(kBadFile).IsOpen();
+    std::remove(kBadFile);
+
+    printf("%-28s %s\n", label, rejected ? "rejected" : "ACCEPTED");
+    return rejected;
+}
+
+
+// The valid file with a header field changed
+template <typename Field>
+std::vector<char>
+Patched(const std::vector<char>& bytes, std::size_t offset, Field value)
+{
+    std::vector<char> patched(bytes);
+
+    memcpy(&patched[offset], &value, sizeof(value));
+    return patched;
+}
+
+
+// Whether the mapped file holds the samples written as text
+bool
+RoundTrip(void)
+{
+    {
+        FILE* file = fopen(kTextFile, "w");
+        if (file == 0) {
+            return false;
+        }
+        fprintf(file, "Topology: %u 4 %u\n", kNumInputs, kNumOutputs);
+        for (unsigned s = 0; s < kNumSamples; ++s) {
+            fprintf(file, "i:");
+            for (unsigned n = 0; n < kNumInputs; ++n) {
+                fprintf(file, " %.6f", Value(s, n));
+            }
+            fprintf(file, "\no:");
+            for (unsigned n = 0; n < kNumOutputs; ++n) {
+                fprintf(file, " %.6f", -Value(s, n));
+            }
+            fprintf(file, "\n");
+        }
+        fclose(file);
+
+        TrainingData training_data(kTextFile);
+        BinaryTrainingData::Convert(training_data, kBinaryFile,
+                                    sizeof(double), kChunkSize);
+    }
+    std::remove(kTextFile);
+
+    BinaryTrainingData training_data(kBinaryFile);
+    bool same = training_data.IsOpen() &&
+                training_data.NumSamples() == kNumSamples;
+
+    for (unsigned s = 0; same && s < kNumSamples; ++s) {
+        const double* inputs = training_data.Inputs<double>(s);
+        const double* targets = training_data.Targets<double>(s);
+
+        for (unsigned n = 0; n < kNumInputs; ++n) {
+            same = same && inputs[n] == Value(s, n);
+        }
+        for (unsigned n = 0; n < kNumOutputs; ++n) {
+            same = same && targets[n] == -Value(s, n);
+        }
+    }
+
+    return same;
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    typedef BinaryTrainingData::Header Header;
+
+    bool ok = RoundTrip();
+    printf("%-28s %s\n", "round trip", ok ? "yes" : "NO");
+
+    std::vector<char> bytes = ReadFile(kBinaryFile);
+    std::remove(kBinaryFile);
+    if (bytes.size() < sizeof(Header)) {
+        fprintf(stderr, "FAILED: no binary file to patch\n");
+        return 1;
+    }
+
+    ok = Rejected("empty file", std::vector<char>()) && ok;
+    ok = Rejected("truncated data",
+                  std::vector<char>(bytes.begin(), bytes.end() - 8)) && ok;
+    ok = Rejected("topology in the header",
+                  Patched(bytes, offsetof(Header, topology_offset),
+                          (uint64_t) 0)) && ok;
+    ok = Rejected("topology offset wraps",
+                  Patched(bytes, offsetof(Header, topology_offset),
+                          (uint64_t) -8)) && ok;
+    ok = Rejected("layer count wraps",
+                  Patched(bytes, offsetof(Header, num_layers),
+                          (uint32_t) -1)) && ok;
+    ok = Rejected("data offset wraps",
+                  Patched(bytes, offsetof(Header, data_offset),
+                          (uint64_t) -64)) && ok;
+    ok = Rejected("chunk size wraps",
+                  Patched(Patched(bytes, offsetof(Header, chunk_size),
+                                  (uint64_t) 1 << 62),
+                          offsetof(Header, num_samples),
+                          (uint64_t) 1 << 40)) && ok;
+    ok = Rejected("chunk bytes wrap",
+                  Patched(bytes, offsetof(Header, chunk_size),
+                          (uint64_t) 1 << 60)) && ok;
+    ok = Rejected("sample count wraps",
+                  Patched(bytes, offsetof(Header, num_samples),
+                          (uint64_t) -1)) && ok;
+    ok = Rejected("chunk count wraps",
+                  Patched(Patched(bytes, offsetof(Header, chunk_size),
+                                  (uint64_t) 1),
+                          offsetof(Header, num_samples),
+                          (uint64_t) 1 << 61)) && ok;
+
+    return ok ? 0 : 1;
+}
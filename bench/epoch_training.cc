@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Multi-epoch training from memory.
+ *
+ * Loads the first 400 samples of 'training_data.dat' (or as many as
+ * given as first argument) once, holds a fifth of them out for
+ * validation, and trains over the rest for several epochs with early
+ * stopping.  For comparison, it also trains a net with a single pass
+ * over the whole file.  Prints the validation error of both nets and
+ * checks that a second run with the same seed gives the same net.
+ * Epochs are printed every ten.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <data_set.hh>
+#include <epoch_trainer.hh>
+#include <net.hh>
+#include <training_data.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const char* kFileName = "training_data.dat";
+const unsigned long kSeed = 42;
+
+} // ! namespace
+
+
+// Main entry
+int main(int argc, char* argv[])
+{
+    unsigned long num_samples = argc > 1 ? atol(argv[1]) : 400;
+
+    TrainingData whole_file(kFileName);
+    MinAnn::DataSet all_samples(whole_file);
+    MinAnn::DataSet training_set(all_samples.Topology());
+    MinAnn::DataSet validation_set(all_samples.Topology());
+
+    for (unsigned long s = 0;
+         s < num_samples && s < all_samples.NumSamples();
+         ++s) {
+        training_set.Add(all_samples.Inputs(s), all_samples.Targets(s));
+    }
+    training_set.Split(0.2f, kSeed, validation_set);
+
+    // One pass over the whole file, as 'main' does
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    MinAnn::Net one_pass(all_samples.Topology());
+    std::vector<double> input_values, target_values;
+    for (unsigned long s = 0; s < all_samples.NumSamples(); ++s) {
+        const double* inputs = all_samples.Inputs(s);
+        const double* targets = all_samples.Targets(s);
+
+        input_values.assign(inputs, inputs + all_samples.Topology().front());
+        target_values.assign(targets,
+                             targets + all_samples.Topology().back());
+        one_pass.FeedForward(input_values);
+        one_pass.BackPropagation(target_values);
+    }
+    double one_pass_seconds = Bench::Seconds(start);
+
+    // Epochs over a small in-memory share of it
+    MinAnn::EpochTrainer::Options options;
+    options.seed = kSeed;
+    options.patience = 10;
+
+    start = std::chrono::steady_clock::now();
+    MinAnn::Net net(training_set.Topology());
+    MinAnn::Net initial_net(net);
+    MinAnn::EpochTrainer trainer(net, training_set, validation_set,
+                                 options);
+
+    printf("# %lu training and %lu validation samples\n",
+           (unsigned long) training_set.NumSamples(),
+           (unsigned long) validation_set.NumSamples());
+    printf("%6s %12s\n", "epoch", "val. error");
+    for (bool more = true; more; ) {
+        more = trainer.Epoch();
+        if (!more || trainer.Epochs() % 10 == 0) {
+            printf("%6u %12.6f\n", trainer.Epochs(), trainer.LastError());
+        }
+    }
+    double seconds = Bench::Seconds(start);
+
+    printf("%-10s %8s %10s %12s\n", "training", "samples", "seconds",
+           "val. error");
+    printf("%-10s %8lu %10.4f %12.6f\n", "one pass",
+           (unsigned long) all_samples.NumSamples(), one_pass_seconds,
+           MinAnn::EpochTrainer::Error(one_pass, validation_set));
+    printf("%-10s %8lu %10.4f %12.6f  (best of epoch %u)\n", "epochs",
+           (unsigned long) training_set.NumSamples(), seconds,
+           MinAnn::EpochTrainer::Error(net, validation_set),
+           trainer.BestEpoch());
+
+    // Same seed and initial weights, same net
+    MinAnn::Net again(initial_net);
+    MinAnn::EpochTrainer(again, training_set, validation_set,
+                         options).Train();
+    bool same = MinAnn::EpochTrainer::Error(again, validation_set) ==
+        MinAnn::EpochTrainer::Error(net, validation_set);
+    printf("reproducible: %s\n", same ? "yes" : "NO");
+
+    return same ? 0 : 1;
+}
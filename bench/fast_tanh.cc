@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Exact against fast transfer function.
+ *
+ * Checks the largest error of the fast tanh against std::tanh on every
+ * instruction set available, in both precisions, then times Tanh() on
+ * its own and within a forward pass of a narrow net.  Finally it trains
+ * the same nets, from the same weights, once with each implementation
+ * and compares their mean RMS errors.  Fails if the error of the
+ * approximation exceeds its documented bound or if it makes training
+ * converge to a noticeably worse net.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <data_set.hh>
+#include <kernels.hh>
+#include <net.hh>
+#include <training_data.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const unsigned kSeed = 1;
+const unsigned kSweepPoints = 1000001;
+const double kSweepRange = 10.0f;
+const double kMaxDoubleError = 3e-7;
+const double kMaxFloatError = 4e-7;
+const unsigned kTanhValues = 4096;
+const unsigned kTanhRepeats = 2000;
+const unsigned kNarrowTopology[] = {16, 16, 4};
+const unsigned kNarrowSamples = 4096;
+const unsigned kNarrowEpochs = 5;
+const double kMaxErrorIncrease = 0.001f;
+
+
+// Largest difference with std::tanh over a dense sweep of inputs
+template <typename T>
+double
+MaxError(void)
+{
+    std::vector<T> values(kSweepPoints);
+
+    for (unsigned i = 0; i < kSweepPoints; ++i) {
+        values[i] = (T) (kSweepRange * (2.0f * i / (kSweepPoints - 1) - 1));
+    }
+    std::vector<T> inputs(values);
+    MinAnn::Kernels::Tanh(&values[0], kSweepPoints);
+
+    double max_error = 0.0f;
+    for (unsigned i = 0; i < kSweepPoints; ++i) {
+        max_error = std::max(max_error,
+                             fabs(values[i] - tanh((double) inputs[i])));
+    }
+
+    return max_error;
+}
+
+
+// Millions of values per second through Tanh()
+template <typename T>
+double
+TanhSpeed(void)
+{
+    std::vector<T> values(kTanhValues);
+    std::vector<T> inputs(kTanhValues);
+
+    for (unsigned i = 0; i < kTanhValues; ++i) {
+        inputs[i] = (T) (4.0f * rand() / RAND_MAX - 2.0f);
+    }
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < kTanhRepeats; ++r) {
+        std::copy(inputs.begin(), inputs.end(), values.begin());
+        MinAnn::Kernels::Tanh(&values[0], kTanhValues);
+    }
+
+    return kTanhValues * (double) kTanhRepeats / Bench::Seconds(start) / 1e6;
+}
+
+
+// Mean RMS error of a net over a data set, with exact outputs
+double
+MeanError(MinAnn::Net& net, const MinAnn::DataSet& data_set)
+{
+    unsigned num_inputs = data_set.Topology().front();
+    unsigned num_outputs = data_set.Topology().back();
+    std::vector<double> input_values, result_values;
+    double sum = 0.0f;
+
+    MinAnn::Kernels::SelectTanhMode(MinAnn::Kernels::kExact);
+    for (std::size_t s = 0; s < data_set.NumSamples(); ++s) {
+        input_values.assign(data_set.Inputs(s),
+                            data_set.Inputs(s) + num_inputs);
+        net.FeedForward(input_values);
+        net.Results(result_values);
+
+        double error = 0.0f;
+        for (unsigned n = 0; n < num_outputs; ++n) {
+            double delta = data_set.Targets(s)[n] - result_values[n];
+            error += delta * delta;
+        }
+        sum += sqrt(error / num_outputs);
+    }
+
+    return sum / data_set.NumSamples();
+}
+
+
+// Train a net online with one implementation; print speed and error
+double
+Train(const char* name, const MinAnn::DataSet& data_set, unsigned epochs,
+      MinAnn::Kernels::TanhMode tanh_mode)
+{
+    unsigned num_inputs = data_set.Topology().front();
+    unsigned num_outputs = data_set.Topology().back();
+    std::vector<double> input_values, target_values;
+
+    srand(kSeed);
+    MinAnn::Net net(data_set.Topology());
+    MinAnn::Kernels::SelectTanhMode(tanh_mode);
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (unsigned e = 0; e < epochs; ++e) {
+        for (std::size_t s = 0; s < data_set.NumSamples(); ++s) {
+            input_values.assign(data_set.Inputs(s),
+                                data_set.Inputs(s) + num_inputs);
+            target_values.assign(data_set.Targets(s),
+                                 data_set.Targets(s) + num_outputs);
+            net.FeedForward(input_values);
+            net.BackPropagation(target_values);
+        }
+    }
+    double seconds = Bench::Seconds(start);
+    double error = MeanError(net, data_set);
+
+    printf("%-8s %6s %12.0f %12.6f\n", name,
+           tanh_mode == MinAnn::Kernels::kFast ? "fast" : "exact",
+           epochs * data_set.NumSamples() / seconds, error);
+
+    return error;
+}
+
+
+// Forward passes per second of a net with one implementation
+double
+ForwardSpeed(MinAnn::Net& net, const MinAnn::DataSet& data_set,
+             MinAnn::Kernels::TanhMode tanh_mode)
+{
+    unsigned num_inputs = data_set.Topology().front();
+    std::vector<double> input_values;
+
+    MinAnn::Kernels::SelectTanhMode(tanh_mode);
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (std::size_t s = 0; s < data_set.NumSamples(); ++s) {
+        input_values.assign(data_set.Inputs(s),
+                            data_set.Inputs(s) + num_inputs);
+        net.FeedForward(input_values);
+    }
+
+    return data_set.NumSamples() / Bench::Seconds(start);
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    MinAnn::Kernels::Isa best = MinAnn::Kernels::Detect();
+    bool ok = true;
+
+    MinAnn::Kernels::SelectTanhMode(MinAnn::Kernels::kFast);
+    printf("%-8s %12s %12s %12s %12s\n", "isa", "max error", "(float)",
+           "Mvalues/s", "(float)");
+    for (int isa = MinAnn::Kernels::kScalar; isa <= best; ++isa) {
+        MinAnn::Kernels::Select((MinAnn::Kernels::Isa) isa);
+        double double_error = MaxError<double>();
+        double float_error = MaxError<float>();
+
+        printf("%-8s %12.3g %12.3g %12.1f %12.1f\n",
+               MinAnn::Kernels::Name(MinAnn::Kernels::Selected()),
+               double_error, float_error, TanhSpeed<double>(),
+               TanhSpeed<float>());
+        ok = ok && double_error < kMaxDoubleError &&
+             float_error < kMaxFloatError;
+    }
+    MinAnn::Kernels::Select(best);
+    MinAnn::Kernels::SelectTanhMode(MinAnn::Kernels::kExact);
+    printf("%-8s %12s %12s %12.1f %12.1f\n", "exact", "", "",
+           TanhSpeed<double>(), TanhSpeed<float>());
+
+    TrainingData training_data("training_data.dat");
+    MinAnn::DataSet small_set(training_data);
+    MinAnn::DataSet narrow_set =
+        Bench::Synthetic(kNarrowTopology,
+                         sizeof(kNarrowTopology) / sizeof(kNarrowTopology[0]),
+                         kNarrowSamples, kSeed);
+
+    srand(kSeed);
+    MinAnn::Net net(narrow_set.Topology());
+    double exact_speed = ForwardSpeed(net, narrow_set,
+                                      MinAnn::Kernels::kExact);
+    double fast_speed = ForwardSpeed(net, narrow_set,
+                                     MinAnn::Kernels::kFast);
+    printf("\nforward passes/s on the narrow net: %.0f exact, %.0f fast\n\n",
+           exact_speed, fast_speed);
+
+    printf("%-8s %6s %12s %12s\n", "data", "tanh", "samples/s",
+           "mean error");
+    double exact_error = Train("small", small_set, 1,
+                               MinAnn::Kernels::kExact);
+    double fast_error = Train("small", small_set, 1,
+                              MinAnn::Kernels::kFast);
+    ok = ok && fast_error < exact_error + kMaxErrorIncrease;
+
+    exact_error = Train("narrow", narrow_set, kNarrowEpochs,
+                        MinAnn::Kernels::kExact);
+    fast_error = Train("narrow", narrow_set, kNarrowEpochs,
+                       MinAnn::Kernels::kFast);
+    ok = ok && fast_error < exact_error + kMaxErrorIncrease;
+
+    printf("within bounds: %s\n", ok ? "yes" : "NO");
+
+    return ok ? 0 : 1;
+}
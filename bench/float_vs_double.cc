@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Single against double precision nets.
+ *
+ * Trains a BasicNet<float> and a BasicNet<double>, both starting from
+ * the same zero mean, fan-in scaled weights, on the same data:
+ * 'training_data.dat', then two synthetic sets learnt online and in
+ * mini-batches.  Prints the samples/s of each and the mean RMS error
+ * over the data after training.  The medium set compares accuracy; the
+ * wide one, whose layers are large enough for memory traffic to
+ * dominate, compares speed.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <activation.hh>
+#include <data_set.hh>
+#include <initializer.hh>
+#include <net.hh>
+#include <training_data.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const unsigned kSeed = 1;
+const unsigned kMediumTopology[] = {16, 16, 4};
+const unsigned kMediumSamples = 4096;
+const unsigned kMediumEpochs = 5;
+const unsigned kWideTopology[] = {256, 512, 512, 16};
+const unsigned kWideSamples = 1024;
+const double kWideEta = 0.002f;          // Online steps on wide layers
+const unsigned kBatchSize = 32;
+
+
+// Samples of a data set, back to back, as values of type T
+template <typename T>
+void
+Flatten(const MinAnn::DataSet& data_set, std::vector<T>& inputs,
+        std::vector<T>& targets)
+{
+    std::size_t n = data_set.NumSamples();
+
+    inputs.assign(data_set.Inputs(0),
+                  data_set.Inputs(0) + n * data_set.Topology().front());
+    targets.assign(data_set.Targets(0),
+                   data_set.Targets(0) + n * data_set.Topology().back());
+}
+
+
+// Mean RMS error of a net over samples stored back to back
+template <typename T>
+double
+MeanError(MinAnn::BasicNet<T>& net, const std::vector<T>& inputs,
+          const std::vector<T>& targets)
+{
+    unsigned num_inputs = net.Topology().front();
+    unsigned num_outputs = net.Topology().back();
+    std::size_t num_samples = inputs.size() / num_inputs;
+    std::vector<T> input_values, result_values;
+    double sum = 0.0f;
+
+    for (std::size_t s = 0; s < num_samples; ++s) {
+        input_values.assign(inputs.begin() + s * num_inputs,
+                            inputs.begin() + (s + 1) * num_inputs);
+        net.FeedForward(input_values);
+        net.Results(result_values);
+
+        double error = 0.0f;
+        for (unsigned n = 0; n < num_outputs; ++n) {
+            double delta = targets[s * num_outputs + n] - result_values[n];
+            error += delta * delta;
+        }
+        sum += sqrt(error / num_outputs);
+    }
+
+    return sum / num_samples;
+}
+
+
+// Train a net for some epochs and print speed and error; a learning
+// rate of zero keeps the net's default one
+template <typename T>
+void
+Run(const char* name, const MinAnn::DataSet& data_set, unsigned epochs,
+    unsigned batch_size, double eta = 0.0f)
+{
+    std::vector<T> inputs, targets;
+    Flatten(data_set, inputs, targets);
+
+    std::vector<MinAnn::Activation> activations(
+        data_set.Topology().size(), MinAnn::kTanh);
+    MinAnn::BasicNet<T> net(data_set.Topology(), activations,
+                            MinAnn::Initializer(kSeed));
+    if (eta > 0.0f) {
+        net.LearningRate(eta);
+    }
+    unsigned num_inputs = data_set.Topology().front();
+    unsigned num_outputs = data_set.Topology().back();
+    std::size_t num_samples = data_set.NumSamples();
+    std::vector<T> input_values, target_values;
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (unsigned e = 0; e < epochs; ++e) {
+        if (batch_size > 1) {
+            net.TrainBatch(inputs, targets, batch_size);
+            continue;
+        }
+        for (std::size_t s = 0; s < num_samples; ++s) {
+            input_values.assign(inputs.begin() + s * num_inputs,
+                                inputs.begin() + (s + 1) * num_inputs);
+            target_values.assign(targets.begin() + s * num_outputs,
+                                 targets.begin() + (s + 1) * num_outputs);
+            net.FeedForward(input_values);
+            net.BackPropagation(target_values);
+        }
+    }
+    double seconds = Bench::Seconds(start);
+
+    printf("%-8s %6s %6u %12.0f %12.6f\n", name,
+           sizeof(T) == sizeof(float) ? "float" : "double", batch_size,
+           epochs * num_samples / seconds,
+           MeanError(net, inputs, targets));
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    TrainingData training_data("training_data.dat");
+    MinAnn::DataSet small_set(training_data);
+
+    MinAnn::DataSet medium_set =
+        Bench::Synthetic(kMediumTopology,
+                         sizeof(kMediumTopology) / sizeof(kMediumTopology[0]),
+                         kMediumSamples, kSeed);
+    MinAnn::DataSet wide_set =
+        Bench::Synthetic(kWideTopology,
+                         sizeof(kWideTopology) / sizeof(kWideTopology[0]),
+                         kWideSamples, kSeed);
+
+    printf("%-8s %6s %6s %12s %12s\n", "data", "type", "batch",
+           "samples/s", "mean error");
+    Run<double>("small", small_set, 1, 1);
+    Run<float>("small", small_set, 1, 1);
+    Run<double>("medium", medium_set, kMediumEpochs, 1);
+    Run<float>("medium", medium_set, kMediumEpochs, 1);
+    Run<double>("medium", medium_set, kMediumEpochs, kBatchSize);
+    Run<float>("medium", medium_set, kMediumEpochs, kBatchSize);
+    Run<double>("wide", wide_set, 1, 1, kWideEta);
+    Run<float>("wide", wide_set, 1, 1, kWideEta);
+    Run<double>("wide", wide_set, 1, kBatchSize);
+    Run<float>("wide", wide_set, 1, kBatchSize);
+
+    return 0;
+}
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+/*
+ * Convergence versus throughput of lock-free asynchronous SGD.
+ *
+ * Trains the net described by 'training_data.dat' with the serial
+ * online trainer and with the Hogwild trainer on 1, 2, 4, ... threads
+ * (up to the hardware concurrency, or to the first argument when
+ * given), and prints the throughput of each mode along with the RMS
+ * error over the whole data set after every few epochs.  Then checks,
+ * for every optimizer, that one epoch of Hogwild training on a single
+ * thread ends with the same error as serial training.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <hogwild_trainer.hh>
+#include <net.hh>
+#include <training_data.hh>
+
+
+namespace {
+
+const unsigned kEpochs = 20;
+const unsigned kReportEvery = 5;
+const double kAdaptiveEta = 0.01;       // For RMSProp and Adam
+const double kTolerance = 1e-6;
+
+
+// Mean RMS error of the net over every sample
+double
+DataSetError(MinAnn::Net& net, const std::vector<double>& input_values,
+             const std::vector<double>& target_values)
+{
+    unsigned num_inputs = net.Topology().front();
+    unsigned num_outputs = net.Topology().back();
+    unsigned num_samples = input_values.size() / num_inputs;
+    std::vector<double> input(num_inputs), result_values;
+    double sum = 0.0f;
+
+    for (unsigned s = 0; s < num_samples; ++s) {
+        input.assign(input_values.begin() + s * num_inputs,
+                     input_values.begin() + (s + 1) * num_inputs);
+        net.FeedForward(input);
+        net.Results(result_values);
+
+        double error = 0.0f;
+        for (unsigned n = 0; n < num_outputs; ++n) {
+            double delta = target_values[s * num_outputs + n] -
+                result_values[n];
+            error += delta * delta;
+        }
+        sum += sqrt(error / num_outputs);
+    }
+
+    return sum / num_samples;
+}
+
+
+// One serial epoch, or one Hogwild epoch on a single thread
+double
+OneEpoch(const std::vector<unsigned>& topology,
+         const std::vector<double>& input_values,
+         const std::vector<double>& target_values,
+         MinAnn::Optimizer kind, bool hogwild)
+{
+    unsigned num_inputs = topology.front();
+    unsigned num_outputs = topology.back();
+    unsigned num_samples = input_values.size() / num_inputs;
+
+    srand(1);
+    MinAnn::Net net(topology);
+    net.OptimizerKind(kind);
+    if (kind == MinAnn::kRmsProp || kind == MinAnn::kAdam) {
+        net.LearningRate(kAdaptiveEta);
+    }
+
+    if (hogwild) {
+        MinAnn::HogwildTrainer trainer(net, 1);
+        trainer.Train(input_values, target_values);
+    } else {
+        std::vector<double> input, target;
+
+        for (unsigned s = 0; s < num_samples; ++s) {
+            input.assign(input_values.begin() + s * num_inputs,
+                         input_values.begin() + (s + 1) * num_inputs);
+            target.assign(target_values.begin() + s * num_outputs,
+                          target_values.begin() + (s + 1) * num_outputs);
+            net.FeedForward(input);
+            net.BackPropagation(target);
+        }
+    }
+
+    return DataSetError(net, input_values, target_values);
+}
+
+
+void
+Report(const char* mode, double seconds, unsigned num_samples,
+       const std::vector<double>& errors)
+{
+    printf("%-12s %12.0f", mode, kEpochs * num_samples / seconds);
+    for (unsigned i = 0; i < errors.size(); ++i) {
+        printf(" %10.6f", errors[i]);
+    }
+    printf("\n");
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(int argc, char* argv[])
+{
+    unsigned max_threads = argc > 1
+        ? (unsigned) atoi(argv[1])
+        : std::thread::hardware_concurrency();
+    if (max_threads == 0) {
+        max_threads = 1;
+    }
+
+    std::vector<unsigned> topology;
+    std::vector<double> input_values, target_values, values;
+    TrainingData training_data("training_data.dat");
+    training_data.Topology(topology);
+    while (!training_data.IsEof()) {
+        if (training_data.NextInputs(values) != topology.front()) {
+            break;
+        }
+        input_values.insert(input_values.end(), values.begin(), values.end());
+        training_data.TargetOutputs(values);
+        target_values.insert(target_values.end(), values.begin(),
+                             values.end());
+    }
+    unsigned num_samples = input_values.size() / topology.front();
+
+    printf("# %u samples, %u epochs, error every %u epochs\n",
+           num_samples, kEpochs, kReportEvery);
+    printf("%-12s %12s %s\n", "mode", "samples/s", "  errors...");
+
+    std::chrono::duration<double> elapsed;
+    std::vector<double> errors;
+
+    // Serial online training
+    {
+        srand(1);
+        MinAnn::Net net(topology);
+        std::vector<double> input, target;
+
+        elapsed = std::chrono::duration<double>::zero();
+        errors.clear();
+        for (unsigned epoch = 1; epoch <= kEpochs; ++epoch) {
+            std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+            for (unsigned s = 0; s < num_samples; ++s) {
+                input.assign(input_values.begin() + s * topology.front(),
+                             input_values.begin() +
+                                 (s + 1) * topology.front());
+                target.assign(target_values.begin() + s * topology.back(),
+                              target_values.begin() +
+                                  (s + 1) * topology.back());
+                net.FeedForward(input);
+                net.BackPropagation(target);
+            }
+            elapsed += std::chrono::steady_clock::now() - start;
+
+            if (epoch % kReportEvery == 0) {
+                errors.push_back(DataSetError(net, input_values,
+                                              target_values));
+            }
+        }
+        Report("serial", elapsed.count(), num_samples, errors);
+    }
+
+    // Asynchronous training
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        srand(1);
+        MinAnn::Net net(topology);
+        MinAnn::HogwildTrainer trainer(net, threads);
+
+        elapsed = std::chrono::duration<double>::zero();
+        errors.clear();
+        for (unsigned epoch = 1; epoch <= kEpochs; ++epoch) {
+            std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+            trainer.Train(input_values, target_values);
+            elapsed += std::chrono::steady_clock::now() - start;
+
+            if (epoch % kReportEvery == 0) {
+                errors.push_back(DataSetError(net, input_values,
+                                              target_values));
+            }
+        }
+
+        char mode[32];
+        snprintf(mode, sizeof(mode), "hogwild/%u", threads);
+        Report(mode, elapsed.count(), num_samples, errors);
+
+        if (threads < max_threads && threads * 2 > max_threads) {
+            threads = max_threads / 2;
+        }
+    }
+
+    // Every optimizer follows its own rule on the shared path too
+    bool ok = true;
+    printf("\n%-12s %12s %12s\n", "optimizer", "serial", "hogwild/1");
+    for (int kind = 0; kind < MinAnn::kNumOptimizers; ++kind) {
+        MinAnn::Optimizer optimizer = (MinAnn::Optimizer) kind;
+        double serial = OneEpoch(topology, input_values, target_values,
+                                 optimizer, false);
+        double hogwild = OneEpoch(topology, input_values, target_values,
+                                  optimizer, true);
+
+        printf("%-12s %12.6f %12.6f\n",
+               MinAnn::BasicOptimizer<double>::Name(optimizer),
+               serial, hogwild);
+        if (!(std::fabs(serial - hogwild) <= kTolerance)) {
+            fprintf(stderr, "FAILED: %s, hogwild training differs from "
+                    "serial training\n",
+                    MinAnn::BasicOptimizer<double>::Name(optimizer));
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
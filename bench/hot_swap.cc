@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Training while serving.
+ *
+ * Trains a net on 'training_data.dat' a few times over, publishing a
+ * snapshot of it every so many samples, while several threads keep
+ * predicting with the latest snapshot.  Prints the samples trained and
+ * the predictions served per second, and checks that every prediction
+ * was finite, that every replaced snapshot was freed, and that the
+ * last snapshot predicts exactly as the trained net.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <data_set.hh>
+#include <inference_model.hh>
+#include <live_model.hh>
+#include <net.hh>
+#include <training_data.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const unsigned kSeed = 1;
+const unsigned kPasses = 20;
+const unsigned kPublishEvery = 100;     // Samples
+const unsigned kNumReaders = 3;
+
+
+// Predict sample after sample until told to stop
+void
+Serve(MinAnn::LiveModel& live_model, const MinAnn::DataSet& data_set,
+      const std::atomic<bool>& done, unsigned long& predictions,
+      bool& finite)
+{
+    MinAnn::LiveModel::Reader reader(live_model);
+    std::vector<double> result_values(data_set.Topology().back());
+
+    predictions = 0;
+    finite = true;
+    while (!done.load(std::memory_order_relaxed)) {
+        std::size_t s = predictions % data_set.NumSamples();
+
+        reader.Predict(data_set.Inputs(s), &result_values[0]);
+        for (unsigned n = 0; n < result_values.size(); ++n) {
+            finite = finite && std::isfinite(result_values[n]);
+        }
+        ++predictions;
+    }
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    TrainingData training_data("training_data.dat");
+    MinAnn::DataSet data_set(training_data);
+    unsigned num_inputs = data_set.Topology().front();
+    unsigned num_outputs = data_set.Topology().back();
+
+    srand(kSeed);
+    MinAnn::Net net(data_set.Topology());
+    MinAnn::LiveModel live_model(net);
+
+    std::atomic<bool> done(false);
+    std::vector<unsigned long> predictions(kNumReaders);
+    std::vector<char> finite(kNumReaders);
+    std::vector<std::thread> readers;
+    bool ok = true;
+
+    for (unsigned r = 0; r < kNumReaders; ++r) {
+        readers.push_back(std::thread([&, r]() {
+            bool reader_finite;
+
+            Serve(live_model, data_set, done, predictions[r],
+                  reader_finite);
+            finite[r] = reader_finite;
+        }));
+    }
+
+    std::vector<double> input_values, target_values, result_values;
+    unsigned long samples = 0;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    for (unsigned pass = 0; pass < kPasses; ++pass) {
+        for (std::size_t s = 0; s < data_set.NumSamples(); ++s) {
+            input_values.assign(data_set.Inputs(s),
+                                data_set.Inputs(s) + num_inputs);
+            target_values.assign(data_set.Targets(s),
+                                 data_set.Targets(s) + num_outputs);
+            net.FeedForward(input_values);
+            net.BackPropagation(target_values);
+
+            if (++samples % kPublishEvery == 0) {
+                live_model.Publish(net);
+            }
+        }
+    }
+    live_model.Publish(net);
+    double seconds = Bench::Seconds(start);
+
+    done.store(true);
+    unsigned long served = 0;
+    for (unsigned r = 0; r < kNumReaders; ++r) {
+        readers[r].join();
+        served += predictions[r];
+        ok = ok && finite[r];
+    }
+
+    std::size_t pending = live_model.Reclaim();
+    printf("%lu samples trained, %.0f/s, %lu snapshots\n", samples,
+           samples / seconds, (unsigned long) live_model.Version());
+    printf("%lu predictions served by %u threads, %.0f/s\n", served,
+           kNumReaders, served / seconds);
+    printf("snapshots left unreclaimed: %lu\n", (unsigned long) pending);
+    ok = ok && pending == 0;
+
+    // The last snapshot is the trained net
+    MinAnn::InferenceModel model(net);
+    MinAnn::LiveModel::Reader reader(live_model);
+    std::vector<double> expected(num_outputs), actual(num_outputs);
+    for (std::size_t s = 0; s < data_set.NumSamples(); ++s) {
+        model.Predict(data_set.Inputs(s), &expected[0]);
+        reader.Predict(data_set.Inputs(s), &actual[0]);
+        if (expected != actual) {
+            printf("last snapshot differs from the net at sample %lu\n",
+                   (unsigned long) s);
+            ok = false;
+            break;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
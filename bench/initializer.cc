@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Reproducible weight initialization.
+ *
+ * Builds a large net with rand() and with every initializer scheme,
+ * with one thread and with all of them, and prints the time taken by
+ * each.  Checks that a seed always gives the same weights, whether the
+ * layers are filled by one thread or several and whether several nets
+ * are built at once, that weights stay within their scheme's bounds,
+ * and that a net drawn with Xavier weights learns 'training_data.dat'.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <data_set.hh>
+#include <initializer.hh>
+#include <net.hh>
+#include <training_data.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const uint64_t kSeed = 42;
+const unsigned kNumNets = 4;            // Built at once
+const double kMaxTrainedError = 0.05;
+
+const char* const kSchemes[] = {"uniform", "xavier", "he"};
+
+
+bool
+SameWeights(const MinAnn::Net& a, const MinAnn::Net& b)
+{
+    for (unsigned l = 1; l < a.Layers().size(); ++l) {
+        const MinAnn::Layer& layer = a.Layers()[l];
+        std::size_t size = (std::size_t) layer.Size() * layer.NumInputs();
+
+        if (!std::equal(layer.Weights(), layer.Weights() + size,
+                        b.Layers()[l].Weights())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Largest weight of the first hidden layer, the one of widest fan in
+double
+MaxWeight(const MinAnn::Net& net)
+{
+    const MinAnn::Layer& layer = net.Layers()[1];
+    std::size_t size = (std::size_t) layer.Size() * layer.NumInputs();
+    double max_weight = 0.0f;
+
+    for (std::size_t w = 0; w < size; ++w) {
+        max_weight = std::max(max_weight, fabs(layer.Weights()[w]));
+    }
+    return max_weight;
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    const std::vector<unsigned> topology = {512, 1024, 1024, 10};
+    const std::vector<MinAnn::Activation> activations(topology.size(),
+                                                      MinAnn::kTanh);
+    // At least a few, so that the parallel fill is always checked
+    unsigned num_threads = std::max(4u, std::thread::hardware_concurrency());
+    bool ok = true;
+
+    printf("%-10s %8s %12s\n", "weights", "threads", "ms");
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    MinAnn::Net rand_net(topology);
+    printf("%-10s %8u %12.2f\n", "rand()", 1u, 1e3 * Bench::Seconds(start));
+
+    for (unsigned s = 0; s < 3; ++s) {
+        MinAnn::Initializer::Scheme scheme =
+            MinAnn::Initializer::Scheme(s);
+
+        start = std::chrono::steady_clock::now();
+        MinAnn::Net serial(topology, activations,
+                           MinAnn::Initializer(kSeed, scheme));
+        printf("%-10s %8u %12.2f\n", kSchemes[s], 1u,
+               1e3 * Bench::Seconds(start));
+
+        start = std::chrono::steady_clock::now();
+        MinAnn::Net parallel(topology, activations,
+                             MinAnn::Initializer(kSeed, scheme,
+                                                 num_threads));
+        printf("%-10s %8u %12.2f\n", kSchemes[s], num_threads,
+               1e3 * Bench::Seconds(start));
+
+        if (!SameWeights(serial, parallel)) {
+            printf("%s: parallel fill gives other weights\n", kSchemes[s]);
+            ok = false;
+        }
+
+        double limit = scheme == MinAnn::Initializer::kUniform ? 1.0f
+            : scheme == MinAnn::Initializer::kXavier
+                ? std::sqrt(6.0f / (topology[0] + topology[1]))
+                : std::sqrt(6.0f / topology[0]);
+        double max_weight = MaxWeight(serial);
+        if (max_weight > limit) {
+            printf("%s: weight %g above %g\n", kSchemes[s], max_weight,
+                   limit);
+            ok = false;
+        }
+    }
+
+    // Several nets built at once, all the same as a serial one
+    MinAnn::Initializer initializer(kSeed);
+    MinAnn::Net reference(topology, activations, initializer);
+    std::vector<MinAnn::Net*> nets(kNumNets);
+    std::vector<std::thread> builders;
+
+    for (unsigned n = 0; n < kNumNets; ++n) {
+        builders.push_back(std::thread([&, n]() {
+            nets[n] = new MinAnn::Net(topology, activations, initializer);
+        }));
+    }
+    for (unsigned n = 0; n < kNumNets; ++n) {
+        builders[n].join();
+        if (!SameWeights(reference, *nets[n])) {
+            printf("net %u built in parallel differs\n", n);
+            ok = false;
+        }
+        delete nets[n];
+    }
+
+    // A net drawn with Xavier weights still learns
+    TrainingData training_data("training_data.dat");
+    MinAnn::DataSet data_set(training_data);
+    MinAnn::Net net(data_set.Topology(),
+                    std::vector<MinAnn::Activation>(
+                        data_set.Topology().size(), MinAnn::kTanh),
+                    initializer);
+    unsigned num_inputs = data_set.Topology().front();
+    unsigned num_outputs = data_set.Topology().back();
+    std::vector<double> input_values, target_values;
+
+    for (std::size_t s = 0; s < data_set.NumSamples(); ++s) {
+        input_values.assign(data_set.Inputs(s),
+                            data_set.Inputs(s) + num_inputs);
+        target_values.assign(data_set.Targets(s),
+                             data_set.Targets(s) + num_outputs);
+        net.FeedForward(input_values);
+        net.BackPropagation(target_values);
+    }
+    printf("xavier net recent avg. error: %g\n", net.RecentAvgError());
+    if (!(net.RecentAvgError() <= kMaxTrainedError)) {
+        ok = false;
+    }
+
+    return ok ? 0 : 1;
+}
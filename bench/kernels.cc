@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Vectorized kernels against the scalar ones.
+ *
+ * Runs every kernel, in single and double precision, with every
+ * instruction set the CPU supports and with the portable scalar code,
+ * on odd shapes that exercise the vector tails and padded row strides.
+ * Prints the largest difference found for each instruction set, and
+ * fails if any goes past the tolerance of its precision (integer
+ * products must match exactly).
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdint.h>
+#include <vector>
+
+#include <kernels.hh>
+
+
+namespace {
+
+const unsigned kSeed = 1;
+const double kMaxDiffDouble = 1e-10;
+const double kMaxDiffFloat = 1e-4;
+
+struct Shape {
+    unsigned rows;
+    unsigned cols;
+};
+
+// Odd sizes, so that every vector loop leaves a tail
+const Shape kShapes[] = {
+    {1, 1}, {3, 5}, {7, 17}, {16, 33}, {37, 29}, {65, 131}
+};
+
+struct GemmShape {
+    unsigned m;
+    unsigned n;
+    unsigned k;
+};
+
+const GemmShape kGemmShapes[] = {
+    {1, 1, 1}, {3, 7, 5}, {17, 9, 33}, {37, 29, 41}, {64, 130, 67}
+};
+
+const unsigned kPadding = 3;    // Extra columns in every row stride
+
+
+template <typename T>
+std::vector<T>
+Random(std::size_t size)
+{
+    std::vector<T> values(size);
+
+    for (std::size_t i = 0; i < size; ++i) {
+        values[i] = 2.0f * rand() / double(RAND_MAX) - 1.0f;
+    }
+    return values;
+}
+
+
+/* Largest difference between the outputs of the scalar kernel and the
+ * ones of @e isa; @e op runs the kernel on buffers that start the same
+ * for both */
+template <typename T, typename Op>
+double
+Compare(MinAnn::Kernels::Isa isa,
+        const std::vector<std::vector<T> >& initial, Op op)
+{
+    std::vector<std::vector<T> > outputs[2] = {initial, initial};
+
+    for (unsigned run = 0; run < 2; ++run) {
+        MinAnn::Kernels::Select(run == 0 ? MinAnn::Kernels::kScalar : isa);
+        op(outputs[run]);
+    }
+
+    double max_diff = 0.0f;
+    for (std::size_t b = 0; b < initial.size(); ++b) {
+        for (std::size_t i = 0; i < initial[b].size(); ++i) {
+            double diff = std::fabs((double) outputs[0][b][i] -
+                                    (double) outputs[1][b][i]);
+            // A NaN on either side is as bad as it gets
+            if (!(diff <= max_diff)) {
+                max_diff = std::isnan(diff) ? HUGE_VAL : diff;
+            }
+        }
+    }
+    return max_diff;
+}
+
+
+// Largest difference over every floating point kernel
+template <typename T>
+double
+CheckFloating(MinAnn::Kernels::Isa isa)
+{
+    typedef std::vector<std::vector<T> > Buffers;
+    double max_diff = 0.0f;
+
+    for (unsigned s = 0; s < sizeof(kShapes) / sizeof(kShapes[0]); ++s) {
+        unsigned rows = kShapes[s].rows;
+        unsigned cols = kShapes[s].cols;
+        std::size_t size = (std::size_t) rows * cols;
+        std::vector<T> w = Random<T>(size);
+        std::vector<T> x = Random<T>(cols);
+        std::vector<T> g = Random<T>(rows);
+        Buffers one(1, Random<T>(std::max(rows, cols)));
+        Buffers state;
+
+        max_diff = std::max(max_diff, Compare(isa, one, [&](Buffers& b) {
+            MinAnn::Kernels::MatVec(&w[0], &x[0], &b[0][0], rows, cols);
+        }));
+        max_diff = std::max(max_diff, Compare(isa, one, [&](Buffers& b) {
+            MinAnn::Kernels::MatTVec(&w[0], &g[0], &b[0][0], rows, cols,
+                                     cols - cols / 3);
+        }));
+
+        // Squares must not be negative
+        for (unsigned b = 0; b < 3; ++b) {
+            state.push_back(Random<T>(size));
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            state[2][i] = std::fabs(state[2][i]);
+        }
+
+        max_diff = std::max(max_diff, Compare(isa, state, [&](Buffers& b) {
+            MinAnn::Kernels::MomentumUpdate(&b[0][0], &b[1][0], &x[0],
+                                            &g[0], rows, cols, 0.15f, 0.5f);
+        }));
+        max_diff = std::max(max_diff, Compare(isa, state, [&](Buffers& b) {
+            MinAnn::Kernels::NesterovUpdate(&b[0][0], &b[1][0], &x[0],
+                                            &g[0], rows, cols, 0.15f, 0.5f);
+        }));
+        max_diff = std::max(max_diff, Compare(isa, state, [&](Buffers& b) {
+            MinAnn::Kernels::RmsPropUpdate(&b[0][0], &b[2][0], &x[0],
+                                           &g[0], rows, cols,
+                                           0.01f, 0.9f, 1e-8f);
+        }));
+        max_diff = std::max(max_diff, Compare(isa, state, [&](Buffers& b) {
+            MinAnn::Kernels::AdamUpdate(&b[0][0], &b[1][0], &b[2][0],
+                                        &x[0], &g[0], rows, cols,
+                                        0.01f, 0.9f, 0.999f, 1e-8f);
+        }));
+
+        // Fast tanh over a wide range, clamped values included
+        Buffers values(1, Random<T>(size));
+        for (std::size_t i = 0; i < size; ++i) {
+            values[0][i] *= 10.0f;
+        }
+        MinAnn::Kernels::SelectTanhMode(MinAnn::Kernels::kFast);
+        max_diff = std::max(max_diff, Compare(isa, values, [&](Buffers& b) {
+            MinAnn::Kernels::Tanh(&b[0][0], size);
+        }));
+        MinAnn::Kernels::SelectTanhMode(MinAnn::Kernels::kExact);
+    }
+
+    for (unsigned s = 0; s < sizeof(kGemmShapes) / sizeof(kGemmShapes[0]);
+         ++s) {
+        unsigned m = kGemmShapes[s].m;
+        unsigned n = kGemmShapes[s].n;
+        unsigned k = kGemmShapes[s].k;
+        unsigned lda = k + kPadding;
+        unsigned ldb = n + kPadding;
+        unsigned ldc = n + kPadding;
+        std::vector<T> a = Random<T>((std::size_t) m * lda);
+        std::vector<T> b_nt = Random<T>((std::size_t) n * k);
+        std::vector<T> b_nn = Random<T>((std::size_t) k * ldb);
+
+        // The padding of C is compared too: it must be left alone
+        Buffers c(1, Random<T>((std::size_t) m * ldc));
+
+        max_diff = std::max(max_diff, Compare(isa, c, [&](Buffers& b) {
+            MinAnn::Kernels::GemmNT(&a[0], &b_nt[0], &b[0][0], m, n, k,
+                                    lda, ldc);
+        }));
+        max_diff = std::max(max_diff, Compare(isa, c, [&](Buffers& b) {
+            MinAnn::Kernels::GemmNN(&a[0], &b_nn[0], &b[0][0], m, n, k,
+                                    lda, ldb, ldc);
+        }));
+    }
+
+    return max_diff;
+}
+
+
+// Largest difference of the 8 bit product, which must be exact
+double
+CheckInt8(MinAnn::Kernels::Isa isa)
+{
+    typedef std::vector<std::vector<int32_t> > Buffers;
+    double max_diff = 0.0f;
+
+    for (unsigned s = 0; s < sizeof(kShapes) / sizeof(kShapes[0]); ++s) {
+        unsigned rows = kShapes[s].rows;
+        unsigned cols = kShapes[s].cols;
+        std::vector<int8_t> w((std::size_t) rows * cols);
+        std::vector<int8_t> x(cols);
+
+        // Full range, extremes included
+        for (std::size_t i = 0; i < w.size(); ++i) {
+            w[i] = (int8_t) (rand() % 255 - 127);
+        }
+        for (unsigned i = 0; i < cols; ++i) {
+            x[i] = (int8_t) (rand() % 255 - 127);
+        }
+
+        Buffers y(1, std::vector<int32_t>(rows, 0));
+        max_diff = std::max(max_diff, Compare(isa, y, [&](Buffers& b) {
+            MinAnn::Kernels::MatVec(&w[0], &x[0], &b[0][0], rows, cols);
+        }));
+    }
+
+    return max_diff;
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    MinAnn::Kernels::Isa best = MinAnn::Kernels::Detect();
+    bool ok = true;
+
+    srand(kSeed);
+    printf("%-8s %14s %14s %14s\n", "isa", "double", "float", "int8");
+    for (int i = MinAnn::Kernels::kSse2; i <= best; ++i) {
+        MinAnn::Kernels::Isa isa = (MinAnn::Kernels::Isa) i;
+        double double_diff = CheckFloating<double>(isa);
+        double float_diff = CheckFloating<float>(isa);
+        double int8_diff = CheckInt8(isa);
+
+        printf("%-8s %14.3g %14.3g %14.3g\n", MinAnn::Kernels::Name(isa),
+               double_diff, float_diff, int8_diff);
+        if (!(double_diff <= kMaxDiffDouble) ||
+            !(float_diff <= kMaxDiffFloat) || int8_diff != 0.0f) {
+            fprintf(stderr, "FAILED: %s kernels differ from the scalar "
+                    "ones\n", MinAnn::Kernels::Name(isa));
+            ok = false;
+        }
+    }
+    MinAnn::Kernels::Select(best);
+
+    if (best == MinAnn::Kernels::kScalar) {
+        printf("No vector instruction set on this CPU\n");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Model files.
+ *
+ * Saves a net and loads it back, checking that the loaded net and an
+ * InferenceModel of the file predict as the saved one, and that loading
+ * leaves the rand() sequence alone.  Then checks that an empty file, a
+ * truncated one and files whose header offsets or layer sizes would
+ * wrap around are all rejected, by Net::Load() and InferenceModel.
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdint.h>
+#include <vector>
+
+#include <inference_model.hh>
+#include <model_file.hh>
+#include <net.hh>
+
+
+namespace {
+
+const unsigned kSeed = 1;
+const char* kModelFile = "/tmp/minann_bench_model_file.model";
+const char* kBadFile = "/tmp/minann_bench_model_file.bad";
+
+
+std::vector<char>
+ReadFile(const char* filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+
+    return std::vector<char>(std::istreambuf_iterator<char>(file),
+                             std::istreambuf_iterator<char>());
+}
+
+
+void
+WriteFile(const char* filename, const std::vector<char>& bytes)
+{
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+
+    file.write(bytes.empty() ? "" : &bytes[0], bytes.size());
+}
+
+
+// Whether both loaders refuse the file
+bool
+Rejected(const char* label, const std::vector<char>& bytes)
+{
+    std::vector<unsigned> topology = {2, 2, 1};
+    MinAnn::Net net(topology);
+
+    WriteFile(kBadFile, bytes);
+    bool net_rejected = !net.Load(kBadFile);
+    bool model_rejected = !MinAnn::InferenceModel(kBadFile).IsOpen();
+    std::remove(kBadFile);
+
+    printf("%-28s %s\n", label,
+           net_rejected && model_rejected ? "rejected" : "ACCEPTED");
+    return net_rejected && model_rejected;
+}
+
+
+// The valid file with a header field changed
+template <typename Field>
+std::vector<char>
+Patched(const std::vector<char>& bytes, std::size_t offset, Field value)
+{
+    std::vector<char> patched(bytes);
+
+    memcpy(&patched[offset], &value, sizeof(value));
+    return patched;
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    typedef MinAnn::ModelFile::Header Header;
+    std::vector<unsigned> topology = {8, 16, 4};
+    bool ok = true;
+
+    srand(kSeed);
+    MinAnn::Net net(topology);
+    MinAnn::Net loaded(topology);
+    ok = net.Save(kModelFile);
+
+    // Loading must not draw from rand()
+    srand(kSeed);
+    int expected = rand();
+    srand(kSeed);
+    ok = loaded.Load(kModelFile) && ok;
+    bool same_sequence = rand() == expected;
+
+    MinAnn::InferenceModel model(kModelFile);
+    std::vector<double> input_values(topology.front(), 0.5f);
+    std::vector<double> results, loaded_results;
+    std::vector<double> model_results(topology.back());
+    net.FeedForward(input_values);
+    net.Results(results);
+    loaded.FeedForward(input_values);
+    loaded.Results(loaded_results);
+    if (model.IsOpen()) {
+        model.Predict(&input_values[0], &model_results[0]);
+    }
+    bool same = ok && model.IsOpen() && results == loaded_results &&
+                results == model_results;
+
+    printf("%-28s %s\n", "round trip", same ? "yes" : "NO");
+    printf("%-28s %s\n", "rand() left alone", same_sequence ? "yes" : "NO");
+    ok = same && same_sequence;
+
+    std::vector<char> bytes = ReadFile(kModelFile);
+    std::remove(kModelFile);
+
+    ok = Rejected("empty file", std::vector<char>()) && ok;
+    ok = Rejected("truncated weights",
+                  std::vector<char>(bytes.begin(), bytes.end() - 8)) && ok;
+    ok = Rejected("layers offset wraps",
+                  Patched(bytes, offsetof(Header, layers_offset),
+                          (uint64_t) -8)) && ok;
+    ok = Rejected("weights offset wraps",
+                  Patched(bytes, offsetof(Header, weights_offset),
+                          (uint64_t) -64)) && ok;
+    ok = Rejected("weight count wraps",
+                  Patched(bytes, offsetof(Header, num_weights),
+                          (uint64_t) 1 << 61)) && ok;
+    ok = Rejected("layer size wraps",
+                  Patched(bytes, sizeof(Header), (uint32_t) -1)) && ok;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Weight update rules.
+ *
+ * Checks first that the vectorized update kernels agree with the
+ * scalar ones.  Then trains the net of 'training_data.dat' with every
+ * optimizer, going over the file as many times as needed, until its
+ * mean RMS error over the whole file falls below a target, and prints
+ * the samples and the training time each one needed.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <data_set.hh>
+#include <epoch_trainer.hh>
+#include <kernels.hh>
+#include <net.hh>
+#include <optimizer.hh>
+#include <training_data.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const unsigned kSeed = 1;
+const unsigned kRows = 37;              // Odd, to exercise the tails
+const unsigned kCols = 29;
+const double kMaxDiffDouble = 1e-12;
+const double kMaxDiffFloat = 1e-4;
+const double kTargetError = 0.02;
+const unsigned kCheckEvery = 50;        // Samples between measures
+const unsigned kMaxPasses = 50;
+
+struct Rule {
+    MinAnn::Optimizer kind;
+    double eta;
+};
+
+const Rule kRules[] = {
+    {MinAnn::kMomentum, 0.15f},
+    {MinAnn::kNesterov, 0.15f},
+    {MinAnn::kRmsProp, 0.01f},
+    {MinAnn::kAdam, 0.02f}
+};
+
+
+// Largest difference between the scalar and the selected kernels
+template <typename T>
+double
+KernelDiff(MinAnn::Optimizer kind)
+{
+    unsigned long size = (unsigned long) kRows * kCols;
+    std::vector<T> x(kCols), g(kRows);
+    std::vector<T> state[2][3];
+
+    srand(kSeed);
+    for (unsigned i = 0; i < kCols; ++i) {
+        x[i] = rand() / double(RAND_MAX) - 0.5f;
+    }
+    for (unsigned j = 0; j < kRows; ++j) {
+        g[j] = rand() / double(RAND_MAX) - 0.5f;
+    }
+    for (unsigned b = 0; b < 3; ++b) {
+        state[0][b].resize(size);
+        for (unsigned long k = 0; k < size; ++k) {
+            state[0][b][k] = rand() / double(RAND_MAX);
+        }
+        state[1][b] = state[0][b];
+    }
+
+    MinAnn::Kernels::Isa best = MinAnn::Kernels::Selected();
+    for (unsigned run = 0; run < 2; ++run) {
+        MinAnn::Kernels::Select(run == 0 ? MinAnn::Kernels::kScalar : best);
+
+        std::vector<T>* s = state[run];
+        switch (kind) {
+          case MinAnn::kNesterov:
+            MinAnn::Kernels::NesterovUpdate(&s[0][0], &s[1][0], &x[0], &g[0],
+                                            kRows, kCols, 0.1f, 0.9f);
+            break;
+          case MinAnn::kRmsProp:
+            MinAnn::Kernels::RmsPropUpdate(&s[0][0], &s[1][0], &x[0], &g[0],
+                                           kRows, kCols, 0.01f, 0.9f, 1e-8f);
+            break;
+          case MinAnn::kAdam:
+            MinAnn::Kernels::AdamUpdate(&s[0][0], &s[1][0], &s[2][0],
+                                        &x[0], &g[0], kRows, kCols,
+                                        0.01f, 0.9f, 0.999f, 1e-8f);
+            break;
+          default:
+            MinAnn::Kernels::MomentumUpdate(&s[0][0], &s[1][0], &x[0], &g[0],
+                                            kRows, kCols, 0.15f, 0.5f);
+            break;
+        }
+    }
+
+    double max_diff = 0.0f;
+    for (unsigned b = 0; b < 3; ++b) {
+        for (unsigned long k = 0; k < size; ++k) {
+            max_diff = std::max(max_diff, (double) fabs(state[0][b][k] -
+                                                        state[1][b][k]));
+        }
+    }
+    return max_diff;
+}
+
+
+// Samples trained on until the target error, or zero
+unsigned long
+SamplesToTarget(const MinAnn::DataSet& data_set, const Rule& rule,
+               double& seconds, double& error)
+{
+    unsigned num_inputs = data_set.Topology().front();
+    unsigned num_outputs = data_set.Topology().back();
+    std::vector<double> input_values, target_values;
+
+    srand(kSeed);
+    MinAnn::Net net(data_set.Topology());
+    net.OptimizerKind(rule.kind);
+    net.LearningRate(rule.eta);
+
+    // Only training is timed, not measuring the error
+    seconds = 0.0f;
+    error = 0.0f;
+    unsigned long max_samples = kMaxPasses * data_set.NumSamples();
+    for (unsigned long sample = 0; sample < max_samples; ) {
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+
+        for (unsigned c = 0; c < kCheckEvery; ++c, ++sample) {
+            std::size_t s = sample % data_set.NumSamples();
+
+            input_values.assign(data_set.Inputs(s),
+                                data_set.Inputs(s) + num_inputs);
+            target_values.assign(data_set.Targets(s),
+                                 data_set.Targets(s) + num_outputs);
+            net.FeedForward(input_values);
+            net.BackPropagation(target_values);
+        }
+        seconds += Bench::Seconds(start);
+
+        error = MinAnn::EpochTrainer::Error(net, data_set);
+        if (error <= kTargetError) {
+            return sample;
+        }
+    }
+    return 0;
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    bool ok = true;
+
+    printf("kernels, %s against scalar:\n",
+           MinAnn::Kernels::Name(MinAnn::Kernels::Selected()));
+    for (unsigned r = 0; r < sizeof(kRules) / sizeof(kRules[0]); ++r) {
+        MinAnn::Optimizer kind = kRules[r].kind;
+        double diff_double = KernelDiff<double>(kind);
+        double diff_float = KernelDiff<float>(kind);
+
+        printf("  %-10s double %-10.3g float %-10.3g\n",
+               MinAnn::BasicOptimizer<double>::Name(kind),
+               diff_double, diff_float);
+        ok = ok && diff_double <= kMaxDiffDouble &&
+             diff_float <= kMaxDiffFloat;
+    }
+
+    TrainingData training_data("training_data.dat");
+    MinAnn::DataSet data_set(training_data);
+
+    printf("\n%-10s %8s %8s %12s %12s\n", "optimizer", "eta", "samples",
+           "ms", "error");
+    for (unsigned r = 0; r < sizeof(kRules) / sizeof(kRules[0]); ++r) {
+        double seconds, error;
+        unsigned long samples = SamplesToTarget(data_set, kRules[r],
+                                                seconds, error);
+
+        printf("%-10s %8.3f %8lu %12.3f %12.6f\n",
+               MinAnn::BasicOptimizer<double>::Name(kRules[r].kind),
+               kRules[r].eta, samples, 1e3 * seconds, error);
+        ok = ok && samples > 0;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+/*
+ * Scaling of data-parallel training with the number of threads.
+ *
+ * Trains copies of the same wide net on the same synthetic samples with
+ * 1, 2, 4, ... threads (up to the hardware concurrency, or to the
+ * first argument when given) and prints the throughput, the speed-up
+ * over one thread and the parallel efficiency (speed-up per thread).
+ * The net starts from zero mean, fan-in scaled weights and learns a
+ * smooth function of its inputs, so that it does not saturate; its
+ * outputs after training must agree with those of the single thread
+ * run: the fixed order reduction only changes the rounding of the
+ * summed gradients.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <activation.hh>
+#include <data_set.hh>
+#include <initializer.hh>
+#include <net.hh>
+#include <parallel_trainer.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const unsigned kTopology[] = {256, 512, 512, 16};
+const unsigned kNumSamples = 2048;
+const unsigned kBatchSize = 256;
+const unsigned kEpochs = 2;
+const unsigned kCheckedSamples = 64;
+const double kTolerance = 1e-9;
+
+
+// Outputs of the net for the first samples, back to back
+std::vector<double>
+Outputs(MinAnn::Net& net, const std::vector<double>& input_values)
+{
+    unsigned num_inputs = net.Topology().front();
+    std::vector<double> input, result_values, outputs;
+
+    for (unsigned s = 0; s < kCheckedSamples; ++s) {
+        input.assign(input_values.begin() + s * num_inputs,
+                     input_values.begin() + (s + 1) * num_inputs);
+        net.FeedForward(input);
+        net.Results(result_values);
+        outputs.insert(outputs.end(), result_values.begin(),
+                       result_values.end());
+    }
+
+    return outputs;
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(int argc, char* argv[])
+{
+    unsigned max_threads = argc > 1
+        ? (unsigned) atoi(argv[1])
+        : std::thread::hardware_concurrency();
+    if (max_threads == 0) {
+        max_threads = 1;
+    }
+
+    MinAnn::DataSet data_set =
+        Bench::Synthetic(kTopology, sizeof(kTopology) / sizeof(kTopology[0]),
+                         kNumSamples, 1);
+    const std::vector<unsigned>& topology = data_set.Topology();
+    std::vector<double> input_values(data_set.Inputs(0),
+                                     data_set.Inputs(0) +
+                                         kNumSamples * topology.front());
+    std::vector<double> target_values(data_set.Targets(0),
+                                      data_set.Targets(0) +
+                                          kNumSamples * topology.back());
+
+    printf("# topology 256-512-512-16, %u samples, batch %u, %u epochs\n",
+           kNumSamples, kBatchSize, kEpochs);
+    printf("%8s %14s %10s %11s %12s\n",
+           "threads", "samples/s", "speed-up", "efficiency", "avg. error");
+
+    std::vector<MinAnn::Activation> activations(topology.size(),
+                                                MinAnn::kTanh);
+    std::vector<double> base_outputs;
+    double base_rate = 0.0f;
+    bool ok = true;
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        MinAnn::Net net(topology, activations, MinAnn::Initializer(2));
+        MinAnn::ParallelTrainer trainer(net, threads);
+
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        for (unsigned epoch = 0; epoch < kEpochs; ++epoch) {
+            trainer.Train(input_values, target_values, kBatchSize);
+        }
+        double rate = kEpochs * kNumSamples / Bench::Seconds(start);
+        if (threads == 1) {
+            base_rate = rate;
+        }
+        printf("%8u %14.1f %10.2f %10.1f%% %12.6f\n", threads, rate,
+               rate / base_rate, 100.0f * rate / base_rate / threads,
+               net.RecentAvgError());
+
+        std::vector<double> outputs = Outputs(net, input_values);
+        if (threads == 1) {
+            base_outputs = outputs;
+        }
+        double max_diff = 0.0f;
+        for (std::size_t o = 0; o < outputs.size(); ++o) {
+            max_diff = std::max(max_diff,
+                                std::fabs(outputs[o] - base_outputs[o]));
+        }
+        if (!(max_diff <= kTolerance)) {
+            fprintf(stderr, "FAILED: %u threads, outputs differ from one "
+                    "thread's by %g\n", threads, max_diff);
+            ok = false;
+        }
+
+        if (threads < max_threads && threads * 2 > max_threads) {
+            threads = max_threads / 2;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+/*
+ * Training data parsing speed.
+ *
+ * Writes a large training file (32 MiB by default, or the number of
+ * MiB given as first argument) to the temporary directory, reads it
+ * back with the previous getline/stringstream reader and with the
+ * buffered reader, and prints the throughput of each in MB/s.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <training_data.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const char* kFileName = "/tmp/minann_bench_parse.dat";
+
+
+// The reader as it was before buffering, kept as a reference
+class LegacyTrainingData
+{
+  public:
+    LegacyTrainingData(const std::string filename)
+    {
+        training_data_file_.open(filename.c_str());
+    }
+
+    bool IsEof(void)
+    {
+        return training_data_file_.eof();
+    }
+
+    void Topology(std::vector<unsigned>& topology)
+    {
+        std::string line;
+        std::string label;
+
+        getline(training_data_file_, line);
+        std::stringstream ss(line);
+        ss >> label;
+        if (this->IsEof() || label.compare("Topology:") != 0 ) {
+            abort();
+        }
+
+        while (!ss.eof()) {
+            unsigned n;
+            ss >> n;
+            topology.push_back(n);
+        }
+    }
+
+    unsigned NextValues(const char* expected, std::vector<double>& values)
+    {
+        values.clear();
+
+        std::string line;
+        getline(training_data_file_, line);
+        std::stringstream ss(line);
+
+        std::string label;
+        ss >> label;
+        if (label.compare(expected) == 0) {
+            double value;
+            while (ss >> value) {
+                values.push_back(value);
+            }
+        }
+
+        return values.size();
+    }
+
+  private:
+    std::ifstream training_data_file_;
+};
+
+} // ! namespace
+
+
+// Main entry
+int main(int argc, char* argv[])
+{
+    unsigned long megabytes = argc > 1 ? atol(argv[1]) : 32;
+    unsigned long target_size = megabytes << 20;
+
+    // Generate a file shaped like 'training_data.dat', but wider
+    std::FILE* file = std::fopen(kFileName, "w");
+    if (file == 0) {
+        perror(kFileName);
+        return 1;
+    }
+    unsigned long size = std::fprintf(file, "Topology: 16 32 8\n");
+    srand(1);
+    while (size < target_size) {
+        size += std::fprintf(file, "i:");
+        for (unsigned i = 0; i < 16; ++i) {
+            size += std::fprintf(file, " %.5f", rand() / double(RAND_MAX));
+        }
+        size += std::fprintf(file, "\no:");
+        for (unsigned i = 0; i < 8; ++i) {
+            size += std::fprintf(file, " %.5f", rand() / double(RAND_MAX));
+        }
+        size += std::fprintf(file, "\n");
+    }
+    std::fclose(file);
+
+    std::vector<unsigned> topology;
+    std::vector<double> values;
+    double legacy_sum = 0.0f, sum = 0.0f;
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    {
+        LegacyTrainingData legacy(kFileName);
+        legacy.Topology(topology);
+        while (!legacy.IsEof()) {
+            if (legacy.NextValues("i:", values) == 0) {
+                break;
+            }
+            for (unsigned i = 0; i < values.size(); ++i) {
+                legacy_sum += values[i];
+            }
+            legacy.NextValues("o:", values);
+            for (unsigned i = 0; i < values.size(); ++i) {
+                legacy_sum += values[i];
+            }
+        }
+    }
+    double legacy_seconds = Bench::Seconds(start);
+
+    topology.clear();
+    start = std::chrono::steady_clock::now();
+    {
+        TrainingData training_data(kFileName);
+        training_data.Topology(topology);
+        while (!training_data.IsEof()) {
+            if (training_data.NextInputs(values) == 0) {
+                break;
+            }
+            for (unsigned i = 0; i < values.size(); ++i) {
+                sum += values[i];
+            }
+            training_data.TargetOutputs(values);
+            for (unsigned i = 0; i < values.size(); ++i) {
+                sum += values[i];
+            }
+        }
+    }
+    double seconds = Bench::Seconds(start);
+
+    std::remove(kFileName);
+
+    printf("# %.1f MB of training data\n", size / 1e6);
+    printf("%-12s %10s %10s\n", "reader", "seconds", "MB/s");
+    printf("%-12s %10.3f %10.1f\n", "stringstream", legacy_seconds,
+           size / 1e6 / legacy_seconds);
+    printf("%-12s %10.3f %10.1f\n", "buffered", seconds,
+           size / 1e6 / seconds);
+    printf("same values: %s\n", sum == legacy_sum ? "yes" : "NO");
+
+    return sum == legacy_sum ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Post-training int8 quantization.
+ *
+ * Trains a net with one pass over 'training_data.dat', quantizes it
+ * with scales calibrated on its first samples, and compares the
+ * outputs of the quantized model with those of Net::FeedForward over
+ * the whole file.  Does the same with a wide net of Xavier initialized
+ * weights on random inputs, where memory traffic dominates.  Prints,
+ * for the net, the double InferenceModel and the QuantizedModel, the
+ * rows scored per second one at a time, the bytes of weights, the
+ * difference with Net::FeedForward and the RMS error against the
+ * targets, if any, and fails if either the mean or the largest
+ * difference of the int8 model is too large.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <activation.hh>
+#include <data_set.hh>
+#include <inference_model.hh>
+#include <initializer.hh>
+#include <net.hh>
+#include <quantized_model.hh>
+#include <training_data.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const unsigned kCalibrationRows = 500;
+const unsigned kWideTopology[] = {256, 512, 512, 16};
+const unsigned kWideRows = 2048;
+const unsigned kWideSeed = 1;
+const double kMaxMeanDiff = 0.05f;
+const double kMaxDiff = 0.1f;
+
+
+// Differences between two sets of outputs, and RMS error of the second
+struct Accuracy {
+    double mean_diff;
+    double max_diff;
+    double error;
+};
+
+
+Accuracy
+Compare(const std::vector<double>& reference,
+        const std::vector<double>& results, const double* targets,
+        unsigned num_outputs)
+{
+    std::size_t rows = results.size() / num_outputs;
+    Accuracy accuracy = {0.0f, 0.0f, 0.0f};
+
+    for (std::size_t r = 0; r < rows; ++r) {
+        double error = 0.0f;
+
+        for (unsigned n = 0; n < num_outputs; ++n) {
+            std::size_t k = r * num_outputs + n;
+            double diff = fabs(results[k] - reference[k]);
+
+            accuracy.mean_diff += diff;
+            accuracy.max_diff = std::max(accuracy.max_diff, diff);
+            if (targets != 0) {
+                double delta = targets[k] - results[k];
+                error += delta * delta;
+            }
+        }
+        accuracy.error += sqrt(error / num_outputs);
+    }
+    accuracy.mean_diff /= results.size();
+    accuracy.error /= rows;
+
+    return accuracy;
+}
+
+
+void
+Print(const char* data, const char* model, double rows_per_second,
+      std::size_t bytes, const Accuracy& accuracy, bool has_targets)
+{
+    printf("%-6s %-10s %12.0f %10lu %12.6f %12.6f", data, model,
+           rows_per_second, (unsigned long) bytes, accuracy.mean_diff,
+           accuracy.max_diff);
+    if (has_targets) {
+        printf(" %12.6f", accuracy.error);
+    }
+    printf("\n");
+}
+
+
+// Score every row with each model and print how they compare
+bool
+Run(const char* data, MinAnn::Net& net, const std::vector<double>& inputs,
+    const double* targets)
+{
+    unsigned num_inputs = net.Topology().front();
+    unsigned num_outputs = net.Topology().back();
+    std::size_t rows = inputs.size() / num_inputs;
+    std::size_t calibration_rows =
+        std::min<std::size_t>(kCalibrationRows, rows);
+
+    MinAnn::InferenceModel model(net);
+    MinAnn::InferenceModel::Context context(model);
+    MinAnn::QuantizedModel quantized(net, &inputs[0], calibration_rows);
+    MinAnn::QuantizedModel::Context quantized_context(quantized);
+
+    std::vector<double> reference(rows * num_outputs);
+    std::vector<double> results(rows * num_outputs);
+    std::vector<double> input_values, result_values;
+    std::size_t bytes = 0;
+
+    for (unsigned l = 1; l < net.Layers().size(); ++l) {
+        bytes += net.Layers()[l].Size() * net.Layers()[l].NumInputs() *
+                 sizeof(double);
+    }
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < rows; ++r) {
+        input_values.assign(inputs.begin() + r * num_inputs,
+                            inputs.begin() + (r + 1) * num_inputs);
+        net.FeedForward(input_values);
+        net.Results(result_values);
+        std::copy(result_values.begin(), result_values.end(),
+                  reference.begin() + r * num_outputs);
+    }
+    Print(data, "net", rows / Bench::Seconds(start), bytes,
+          Compare(reference, reference, targets, num_outputs),
+          targets != 0);
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < rows; ++r) {
+        model.Predict(&inputs[r * num_inputs], &results[r * num_outputs],
+                      context);
+    }
+    Print(data, "double", rows / Bench::Seconds(start), bytes,
+          Compare(reference, results, targets, num_outputs),
+          targets != 0);
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < rows; ++r) {
+        quantized.Predict(&inputs[r * num_inputs],
+                          &results[r * num_outputs], quantized_context);
+    }
+    double seconds = Bench::Seconds(start);
+    Accuracy accuracy = Compare(reference, results, targets, num_outputs);
+    Print(data, "int8", rows / seconds, quantized.MemorySize(), accuracy,
+          targets != 0);
+
+    return accuracy.mean_diff < kMaxMeanDiff && accuracy.max_diff < kMaxDiff;
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    TrainingData training_data("training_data.dat");
+    MinAnn::DataSet data_set(training_data);
+    unsigned num_inputs = data_set.Topology().front();
+    std::vector<double> inputs(data_set.Inputs(0),
+                               data_set.Inputs(0) +
+                                   data_set.NumSamples() * num_inputs);
+    std::vector<double> input_values, target_values;
+    bool ok = true;
+
+    srand(1);
+    MinAnn::Net net(data_set.Topology());
+    for (std::size_t s = 0; s < data_set.NumSamples(); ++s) {
+        input_values.assign(data_set.Inputs(s),
+                            data_set.Inputs(s) + num_inputs);
+        target_values.assign(data_set.Targets(s),
+                             data_set.Targets(s) +
+                                 data_set.Topology().back());
+        net.FeedForward(input_values);
+        net.BackPropagation(target_values);
+    }
+
+    std::vector<unsigned> wide_topology(
+        kWideTopology,
+        kWideTopology + sizeof(kWideTopology) / sizeof(kWideTopology[0]));
+    /* Zero mean weights scaled by the fan in, as a trained net would
+     * have; all positive ones would saturate every neuron and amplify
+     * the quantization error of the inputs until outputs flip sign */
+    std::vector<MinAnn::Activation> wide_activations(wide_topology.size(),
+                                                     MinAnn::kTanh);
+    MinAnn::Net wide_net(wide_topology, wide_activations,
+                         MinAnn::Initializer(kWideSeed));
+    std::vector<double> wide_inputs(kWideRows * wide_topology.front());
+    for (std::size_t i = 0; i < wide_inputs.size(); ++i) {
+        wide_inputs[i] = 2.0f * rand() / RAND_MAX - 1.0f;
+    }
+
+    printf("%-6s %-10s %12s %10s %12s %12s %12s\n", "data", "model",
+           "rows/s", "bytes", "mean diff", "max diff", "rms error");
+    ok = Run("small", net, inputs, data_set.Targets(0)) && ok;
+    ok = Run("wide", wide_net, wide_inputs, 0) && ok;
+
+    return ok ? 0 : 1;
+}
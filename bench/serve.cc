@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Inference server.
+ *
+ * Saves a net, serves it over a Unix socket and puts the server under
+ * load from several clients at once, first answering every request as
+ * soon as it arrives and then within a latency budget that lets
+ * concurrent requests share a batch.  Prints the requests per second,
+ * the batches formed and the latencies, and checks that every output
+ * matches the model's own, that the server counted every request, and
+ * that a malformed request is refused.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <inference_client.hh>
+#include <inference_model.hh>
+#include <inference_server.hh>
+#include <net.hh>
+#include <serve_protocol.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const unsigned kSeed = 1;
+const unsigned kClients = 8;
+const unsigned long kRequests = 2000;   // Per client
+const double kTolerance = 1e-12;
+const char* kModelFile = "/tmp/minann_bench_serve.model";
+const char* kSocketFile = "/tmp/minann_bench_serve.sock";
+
+
+// Single sample requests, checked against the model itself
+bool
+RunClient(const MinAnn::InferenceModel& model, unsigned client)
+{
+    MinAnn::InferenceClient inference_client(kSocketFile);
+    std::mt19937 rng(client + 1);
+    std::uniform_real_distribution<double> uniform(-1.0f, 1.0f);
+    std::vector<double> input_values(model.NumInputs());
+    std::vector<double> result_values(model.NumOutputs());
+    std::vector<double> expected_values(model.NumOutputs());
+
+    if (!inference_client.IsOpen() ||
+        inference_client.NumInputs() != model.NumInputs() ||
+        inference_client.NumOutputs() != model.NumOutputs()) {
+        return false;
+    }
+
+    for (unsigned long r = 0; r < kRequests; ++r) {
+        for (unsigned i = 0; i < input_values.size(); ++i) {
+            input_values[i] = uniform(rng);
+        }
+        if (!inference_client.Predict(&input_values[0], 1,
+                                      &result_values[0])) {
+            return false;
+        }
+
+        model.Predict(&input_values[0], 1, &expected_values[0]);
+        for (unsigned o = 0; o < result_values.size(); ++o) {
+            if (!(std::fabs(result_values[o] - expected_values[o]) <=
+                  kTolerance)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool
+RunLoad(const MinAnn::InferenceModel& model, const char* label,
+        unsigned budget_us)
+{
+    MinAnn::InferenceServer::Options options;
+    options.budget_us = budget_us;
+
+    MinAnn::InferenceServer server(model, options);
+    if (!server.Start(kSocketFile)) {
+        std::fprintf(stderr, "Could not listen on '%s'\n", kSocketFile);
+        return false;
+    }
+
+    std::vector<char> ok(kClients);
+    std::vector<std::thread> clients;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    for (unsigned c = 0; c < kClients; ++c) {
+        clients.push_back(std::thread([&, c]() {
+            ok[c] = RunClient(model, c);
+        }));
+    }
+    for (unsigned c = 0; c < kClients; ++c) {
+        clients[c].join();
+    }
+    double seconds = Bench::Seconds(start);
+
+    MinAnn::ServeProtocol::ServerStats stats = server.Stats();
+    server.Stop();
+
+    bool all_ok = std::count(ok.begin(), ok.end(), true) == kClients;
+    std::printf("%-16s %9.0f req/s %8lu batches %6.2f rows each   "
+                "p50 %6.0f us   p99 %6.0f us\n",
+                label, kClients * kRequests / seconds,
+                (unsigned long) stats.batches,
+                stats.batches > 0 ? (double) stats.rows / stats.batches
+                                  : 0.0f,
+                stats.p50_us, stats.p99_us);
+
+    if (!all_ok) {
+        std::fprintf(stderr, "FAILED: %s, a prediction was lost or "
+                     "differs from the model's\n", label);
+        return false;
+    }
+    if (stats.requests != kClients * kRequests ||
+        stats.rows != kClients * kRequests) {
+        std::fprintf(stderr, "FAILED: %s, the server counted %lu of "
+                     "%lu requests\n", label,
+                     (unsigned long) stats.requests,
+                     kClients * kRequests);
+        return false;
+    }
+
+    return true;
+}
+
+
+// A request with the wrong magic number gets an error, not outputs
+bool
+RefusesBadRequest(const MinAnn::InferenceModel& model)
+{
+    MinAnn::InferenceServer server(model,
+                                   MinAnn::InferenceServer::Options());
+    if (!server.Start(kSocketFile)) {
+        return false;
+    }
+
+    int fd = MinAnn::ServeProtocol::Connect(kSocketFile);
+    MinAnn::ServeProtocol::RequestHeader header = {
+        ~MinAnn::ServeProtocol::kMagic, MinAnn::ServeProtocol::kPredict,
+        0, 1 };
+    MinAnn::ServeProtocol::ResponseHeader response;
+    bool refused = fd >= 0 &&
+        MinAnn::ServeProtocol::WriteFully(fd, &header, sizeof(header)) &&
+        MinAnn::ServeProtocol::ReadFully(fd, &response, sizeof(response)) &&
+        response.status == MinAnn::ServeProtocol::kBadRequest;
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    server.Stop();
+
+    return refused;
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    std::vector<unsigned> topology;
+    topology.push_back(16);
+    topology.push_back(64);
+    topology.push_back(64);
+    topology.push_back(4);
+
+    srand(kSeed);
+    MinAnn::Net net(topology);
+    if (!net.Save(kModelFile)) {
+        std::fprintf(stderr, "Could not save '%s'\n", kModelFile);
+        return 1;
+    }
+
+    bool ok;
+    {
+        MinAnn::InferenceModel model(kModelFile);
+
+        std::printf("%u clients, %lu single sample requests each, over "
+                    "a Unix socket\n\n", kClients, kRequests);
+        ok = model.IsOpen() &&
+             RunLoad(model, "No wait", 0) &&
+             RunLoad(model, "200 us budget", 200);
+
+        if (ok && !RefusesBadRequest(model)) {
+            std::fprintf(stderr, "FAILED: a malformed request was not "
+                         "refused\n");
+            ok = false;
+        }
+    }
+    std::remove(kModelFile);
+
+    return ok ? 0 : 1;
+}
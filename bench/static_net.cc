@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Fixed-topology nets.
+ *
+ * Trains a Net and a StaticNet<2, 4, 2>, both starting from the same
+ * weights, with one pass over 'training_data.dat', checks that both
+ * give the same outputs over the whole file, then prints nanoseconds
+ * per training step and per inference of each.  Does it all with the
+ * exact tanh, which dominates the cost of such a net, then the fast
+ * one.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <data_set.hh>
+#include <kernels.hh>
+#include <net.hh>
+#include <static_net.hh>
+#include <training_data.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const unsigned kSeed = 1;
+const unsigned kRepeats = 200;
+const double kMaxDiff = 1e-9;
+
+typedef MinAnn::StaticNet<2, 4, 2> TinyNet;
+
+
+// Train and time both nets with one implementation of tanh; returns the
+// largest difference between their outputs
+double
+Run(const MinAnn::DataSet& data_set, MinAnn::Kernels::TanhMode tanh_mode)
+{
+    std::size_t num_samples = data_set.NumSamples();
+    unsigned num_inputs = data_set.Topology().front();
+    unsigned num_outputs = data_set.Topology().back();
+
+    MinAnn::Kernels::SelectTanhMode(tanh_mode);
+
+    // One training pass each, timed
+    srand(kSeed);
+    MinAnn::Net net(data_set.Topology());
+    std::vector<double> input_values, target_values, result_values;
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (std::size_t s = 0; s < num_samples; ++s) {
+        input_values.assign(data_set.Inputs(s),
+                            data_set.Inputs(s) + num_inputs);
+        target_values.assign(data_set.Targets(s),
+                             data_set.Targets(s) + num_outputs);
+        net.FeedForward(input_values);
+        net.BackPropagation(target_values);
+    }
+    double net_train = Bench::Seconds(start);
+
+    srand(kSeed);
+    TinyNet tiny_net;
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t s = 0; s < num_samples; ++s) {
+        tiny_net.FeedForward(data_set.Inputs(s));
+        tiny_net.BackPropagation(data_set.Targets(s));
+    }
+    double tiny_train = Bench::Seconds(start);
+
+    // Same outputs on every sample
+    double max_diff = 0.0f;
+    double tiny_results[TinyNet::kNumOutputs];
+    for (std::size_t s = 0; s < num_samples; ++s) {
+        input_values.assign(data_set.Inputs(s),
+                            data_set.Inputs(s) + num_inputs);
+        net.FeedForward(input_values);
+        net.Results(result_values);
+        tiny_net.FeedForward(data_set.Inputs(s));
+        tiny_net.Results(tiny_results);
+
+        for (unsigned n = 0; n < num_outputs; ++n) {
+            max_diff = std::max(max_diff,
+                                fabs(result_values[n] - tiny_results[n]));
+        }
+    }
+
+    // Inference only, over the whole file a few times
+    double checksum = 0.0f;
+    start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < kRepeats; ++r) {
+        for (std::size_t s = 0; s < num_samples; ++s) {
+            input_values.assign(data_set.Inputs(s),
+                                data_set.Inputs(s) + num_inputs);
+            net.FeedForward(input_values);
+            net.Results(result_values);
+            checksum += result_values[0];
+        }
+    }
+    double net_infer = Bench::Seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < kRepeats; ++r) {
+        for (std::size_t s = 0; s < num_samples; ++s) {
+            tiny_net.FeedForward(data_set.Inputs(s));
+            tiny_net.Results(tiny_results);
+            checksum -= tiny_results[0];
+        }
+    }
+    double tiny_infer = Bench::Seconds(start);
+
+    const char* mode = tanh_mode == MinAnn::Kernels::kFast
+        ? "fast" : "exact";
+    printf("%-10s %6s %14.1f %14.1f\n", "Net", mode,
+           1e9 * net_train / num_samples,
+           1e9 * net_infer / (kRepeats * num_samples));
+    printf("%-10s %6s %14.1f %14.1f\n", "StaticNet", mode,
+           1e9 * tiny_train / num_samples,
+           1e9 * tiny_infer / (kRepeats * num_samples));
+
+    // Keeps the timed loops from being optimized away
+    if (checksum == HUGE_VAL) {
+        printf("%g\n", checksum);
+    }
+
+    return max_diff;
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    TrainingData training_data("training_data.dat");
+    MinAnn::DataSet data_set(training_data);
+
+    if (data_set.Topology() != std::vector<unsigned>({2, 4, 2})) {
+        fprintf(stderr, "'training_data.dat' is not a 2-4-2 net\n");
+        return 1;
+    }
+
+    printf("%-10s %6s %14s %14s\n", "net", "tanh", "ns/train step",
+           "ns/inference");
+    double max_diff = Run(data_set, MinAnn::Kernels::kExact);
+    max_diff = std::max(max_diff, Run(data_set, MinAnn::Kernels::kFast));
+    printf("max output difference: %g\n", max_diff);
+
+    return max_diff <= kMaxDiff ? 0 : 1;
+}
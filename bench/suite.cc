@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Throughput suite, for tracking performance across releases.
+ *
+ * Measures, on topologies from tiny to a few thousand neurons per
+ * layer, the latency of Net::FeedForward(), the samples per second of
+ * online training (FeedForward() then BackPropagation()) and the rows
+ * per second of batched inference through an InferenceModel; then the
+ * MB/s at which text and binary training files are read.  Every figure
+ * is printed as a table and, when a file name is given as first
+ * argument, written to it as JSON, one result per line so that two
+ * runs can be diffed ('make bench-json' does so).
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <binary_training_data.hh>
+#include <inference_model.hh>
+#include <kernels.hh>
+#include <net.hh>
+#include <training_data.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const double kMinSeconds = 0.2;     ///< Per measurement
+const unsigned kBatchRows = 256;
+const unsigned long kParseBytes = 16ul << 20;
+const char* kTextFile = "/tmp/minann_bench_suite.dat";
+const char* kBinaryFile = "/tmp/minann_bench_suite.bin";
+
+const std::vector<std::vector<unsigned> > kTopologies = {
+    {2, 4, 2},
+    {16, 32, 4},
+    {64, 256, 256, 8},
+    {256, 1024, 1024, 16},
+    {1024, 3072, 3072, 16}
+};
+
+
+/* Run @e step over and over for at least kMinSeconds (and at least
+ * once after a first untimed call), and return the seconds per call */
+template <typename Step>
+double
+TimePerCall(Step step)
+{
+    step();
+
+    unsigned long calls = 0;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    double seconds;
+    do {
+        step();
+        ++calls;
+        seconds = Bench::Seconds(start);
+    } while (seconds < kMinSeconds);
+
+    return seconds / calls;
+}
+
+
+std::string
+Name(const std::vector<unsigned>& topology)
+{
+    std::string name;
+
+    for (unsigned l = 0; l < topology.size(); ++l) {
+        name += (l == 0 ? "" : "-") + std::to_string(topology[l]);
+    }
+
+    return name;
+}
+
+
+// Results, printed as they come and kept for the JSON file
+class Report {
+  public:
+    void Add(const std::string& benchmark, const std::string& topology,
+             const std::string& unit, double value)
+    {
+        printf("%-20s %-20s %14.1f %s\n", benchmark.c_str(),
+               topology.c_str(), value, unit.c_str());
+        fflush(stdout);
+
+        char line[256];
+        snprintf(line, sizeof(line),
+                 "{\"benchmark\": \"%s\", \"topology\": \"%s\", "
+                 "\"unit\": \"%s\", \"value\": %.6g}",
+                 benchmark.c_str(), topology.c_str(), unit.c_str(), value);
+        lines_.push_back(line);
+    }
+
+    bool Write(const char* filename) const
+    {
+        std::FILE* file = std::fopen(filename, "w");
+        if (file == 0) {
+            perror(filename);
+            return false;
+        }
+
+        fprintf(file, "{\n  \"isa\": \"%s\",\n  \"results\": [\n",
+                MinAnn::Kernels::Name(MinAnn::Kernels::Selected()));
+        for (unsigned i = 0; i < lines_.size(); ++i) {
+            fprintf(file, "    %s%s\n", lines_[i].c_str(),
+                    i + 1 < lines_.size() ? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+
+        return std::fclose(file) == 0;
+    }
+
+  private:
+    std::vector<std::string> lines_;
+};
+
+
+void
+RandomValues(std::vector<double>& values, std::size_t n)
+{
+    values.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        values[i] = 2.0f * rand() / RAND_MAX - 1.0f;
+    }
+}
+
+
+void
+BenchTopology(const std::vector<unsigned>& topology, Report& report)
+{
+    std::string name = Name(topology);
+    std::vector<double> input_values, target_values, batch, results;
+
+    srand(1);
+    MinAnn::Net net(topology);
+    RandomValues(input_values, topology.front());
+    RandomValues(target_values, topology.back());
+    RandomValues(batch, (std::size_t) kBatchRows * topology.front());
+    results.resize((std::size_t) kBatchRows * topology.back());
+
+    double seconds = TimePerCall([&]() {
+        net.FeedForward(input_values);
+    });
+    report.Add("feed_forward", name, "ns", seconds * 1e9);
+
+    seconds = TimePerCall([&]() {
+        net.FeedForward(input_values);
+        net.BackPropagation(target_values);
+    });
+    report.Add("back_propagation", name, "samples/s", 1.0f / seconds);
+
+    MinAnn::InferenceModel model(net);
+    seconds = TimePerCall([&]() {
+        model.Predict(&batch[0], kBatchRows, &results[0]);
+    });
+    report.Add("batch_inference", name, "rows/s", kBatchRows / seconds);
+}
+
+
+void
+BenchParsing(Report& report)
+{
+    // A file shaped like 'training_data.dat', but wider
+    std::FILE* file = std::fopen(kTextFile, "w");
+    if (file == 0) {
+        perror(kTextFile);
+        return;
+    }
+    unsigned long size = std::fprintf(file, "Topology: 16 32 8\n");
+    srand(1);
+    while (size < kParseBytes) {
+        size += std::fprintf(file, "i:");
+        for (unsigned i = 0; i < 16; ++i) {
+            size += std::fprintf(file, " %.5f", rand() / double(RAND_MAX));
+        }
+        size += std::fprintf(file, "\no:");
+        for (unsigned i = 0; i < 8; ++i) {
+            size += std::fprintf(file, " %.5f", rand() / double(RAND_MAX));
+        }
+        size += std::fprintf(file, "\n");
+    }
+    std::fclose(file);
+
+    std::vector<unsigned> topology;
+    std::vector<double> values;
+    double seconds = TimePerCall([&]() {
+        TrainingData training_data(kTextFile);
+        topology.clear();
+        training_data.Topology(topology);
+        while (training_data.NextInputs(values) > 0) {
+            training_data.TargetOutputs(values);
+        }
+    });
+    report.Add("parse_text", "16-32-8", "MB/s", size / 1e6 / seconds);
+
+    {
+        TrainingData training_data(kTextFile);
+        BinaryTrainingData::Convert(training_data, kBinaryFile,
+                                    sizeof(double), 4096);
+    }
+    seconds = TimePerCall([&]() {
+        BinaryTrainingData training_data(kBinaryFile);
+        topology.clear();
+        training_data.Topology(topology);
+        while (training_data.NextInputs(values) > 0) {
+            training_data.TargetOutputs(values);
+        }
+    });
+    report.Add("parse_binary", "16-32-8", "MB/s", size / 1e6 / seconds);
+
+    std::remove(kTextFile);
+    std::remove(kBinaryFile);
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(int argc, char* argv[])
+{
+    Report report;
+
+    printf("# %s kernels; MB/s of parsing are of the text file\n",
+           MinAnn::Kernels::Name(MinAnn::Kernels::Selected()));
+    for (unsigned t = 0; t < kTopologies.size(); ++t) {
+        BenchTopology(kTopologies[t], report);
+    }
+    BenchParsing(report);
+
+    if (argc > 1 && !report.Write(argv[1])) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Hyperparameter sweep.
+ *
+ * Trains a grid of topologies, learning rates and momentums on
+ * 'training_data.dat', with a fifth of it held out for validation,
+ * once on a single thread and once on several.  Prints the best
+ * configurations and the time taken by each run, and checks that both
+ * runs rank the same configurations with the same errors.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <data_set.hh>
+#include <epoch_trainer.hh>
+#include <sweep.hh>
+#include <training_data.hh>
+
+#include "bench_util.hh"
+
+
+namespace {
+
+const unsigned long kSplitSeed = 1;
+const uint64_t kSeed = 7;
+const unsigned kMaxEpochs = 10;
+const unsigned kShown = 10;
+
+} // ! namespace
+
+
+// Main entry
+int main(void)
+{
+    TrainingData training_data("training_data.dat");
+    MinAnn::DataSet training_set(training_data);
+    MinAnn::DataSet validation_set(training_set.Topology());
+
+    training_set.Split(0.2f, kSplitSeed, validation_set);
+
+    MinAnn::EpochTrainer::Options options;
+    options.max_epochs = kMaxEpochs;
+
+    MinAnn::Sweep sweep(training_set, validation_set, options);
+    sweep.AddGrid({{2}, {4}, {8}, {4, 4}},
+                  {0.05f, 0.15f, 0.5f},
+                  {0.0f, 0.5f, 0.9f});
+
+    // At least a few threads, so that the results are always compared
+    unsigned num_threads = std::max(4u, std::thread::hardware_concurrency());
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    std::vector<MinAnn::Sweep::Result> serial = sweep.Run(1, kSeed);
+    double serial_seconds = Bench::Seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<MinAnn::Sweep::Result> parallel =
+        sweep.Run(num_threads, kSeed);
+    double parallel_seconds = Bench::Seconds(start);
+
+    parallel.resize(std::min<std::size_t>(parallel.size(), kShown));
+    MinAnn::Sweep::Print(parallel, stdout);
+    printf("\n%lu configurations: %.3f s on 1 thread, %.3f s on %u\n",
+           (unsigned long) sweep.Configs().size(), serial_seconds,
+           parallel_seconds, num_threads);
+
+    // Both runs must agree, whatever the timing
+    for (unsigned r = 0; r < parallel.size(); ++r) {
+        if (serial[r].error != parallel[r].error ||
+            serial[r].config.topology != parallel[r].config.topology ||
+            serial[r].config.eta != parallel[r].config.eta ||
+            serial[r].config.alpha != parallel[r].config.alpha) {
+            printf("rank %u differs between runs\n", r + 1);
+            return 1;
+        }
+    }
+
+    return 0;
+}
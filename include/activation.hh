@@ -0,0 +1,144 @@
+/**
+ * @file activation.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#ifndef ACTIVATION_HH
+#define ACTIVATION_HH
+
+
+namespace MinAnn {
+
+/**
+ * @brief Transfer functions a layer may apply to its neurons
+ *
+ * @details The values are those stored in model files, so they must
+ *          never change.
+ */
+enum Activation {
+    kTanh = 0,
+    kSigmoid,
+    kRelu,
+    kLeakyRelu,     ///< Slope of 0.01 below zero
+    kLinear,
+    kSoftmax,       ///< Over the whole layer; meant for outputs
+    kNumActivations
+};
+
+
+/**
+ * @brief Transfer function of a layer, resolved once
+ *
+ * @details Each kind has its own loop over a whole row of neurons,
+ *          picked on construction, so the cost of the dispatch is one
+ *          indirect call per row and every loop can be vectorized.
+ *          Tanh and sigmoid go through Kernels::Tanh(), hence follow
+ *          Kernels::SelectTanhMode().  Values are of type @e T,
+ *          either @c float or @c double.
+ */
+template <typename T>
+class BasicActivationFunction {
+  public:
+    // LIFE CYCLE
+    /**
+     */
+    explicit BasicActivationFunction(Activation kind = kTanh);
+
+
+    // OPERATIONS
+    /**
+     * @brief Outputs of @e n neurons from their weighted sums, in place
+     */
+    void Forward(T* x, unsigned n) const;
+
+    /**
+     * @brief Gradients with respect to the sums of @e n neurons from
+     *        those with respect to their outputs, in place
+     *
+     * @param y Outputs of Forward(), not its inputs
+     */
+    void Backward(const T* y, T* g, unsigned n) const;
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    Activation Kind(void) const;
+
+    /**
+     */
+    static const char* Name(Activation kind);
+
+
+  private:
+    typedef void (*ForwardFn)(T*, unsigned);
+    typedef void (*BackwardFn)(const T*, T*, unsigned);
+
+    Activation kind_;
+    ForwardFn forward_;
+    BackwardFn backward_;
+};
+
+
+// INLINE METHODS
+template <typename T>
+inline void
+BasicActivationFunction<T>::Forward(T* x, unsigned n) const
+{
+    forward_(x, n);
+}
+
+
+template <typename T>
+inline void
+BasicActivationFunction<T>::Backward(const T* y, T* g, unsigned n) const
+{
+    backward_(y, g, n);
+}
+
+
+template <typename T>
+inline Activation
+BasicActivationFunction<T>::Kind(void) const
+{
+    return kind_;
+}
+
+
+/**
+ */
+typedef BasicActivationFunction<double> ActivationFunction;
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! ACTIVATION_HH
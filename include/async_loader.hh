@@ -0,0 +1,154 @@
+/**
+ * @file async_loader.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#ifndef ASYNC_LOADER_HH
+#define ASYNC_LOADER_HH
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+class TrainingData;
+
+
+namespace MinAnn {
+
+/**
+ * @brief Read training data on a background thread, ahead of training
+ *
+ * @details A loader thread parses samples into a bounded ring of
+ *          batches while the caller trains on the previous ones, so
+ *          disk reads and parsing overlap with compute.  With a depth of
+ *          two the ring is a double buffer.
+ *
+ *          Stall counters tell which side waits: producer stalls mean
+ *          training is the bottleneck, consumer stalls mean reading is.
+ */
+class AsyncLoader {
+  public:
+    /**
+     * @brief Samples stored back to back, as taken by Net::TrainBatch()
+     */
+    struct Batch {
+        std::vector<double> inputs;
+        std::vector<double> targets;
+        unsigned size;                ///< Number of samples
+    };
+
+
+    // LIFE CYCLE
+    /**
+     * @brief Read the topology and start loading
+     *
+     * @param depth Number of batches in the ring, at least two
+     */
+    AsyncLoader(TrainingData& training_data, unsigned batch_size,
+                unsigned depth);
+
+    /**
+     * @brief Stop loading, even if the data is not exhausted
+     */
+    ~AsyncLoader(void);
+
+
+    // OPERATIONS
+    /**
+     * @brief Wait for the next batch
+     *
+     * @return Null at the end of the data.  The batch stays valid until
+     *         the next call, only the last one may be short.
+     */
+    const Batch* Next(void);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    const std::vector<unsigned>& Topology(void) const;
+
+    /**
+     * @brief Times the loader found the ring full and had to wait
+     */
+    unsigned long ProducerStalls(void);
+
+    /**
+     * @brief Times Next() found the ring empty and had to wait
+     */
+    unsigned long ConsumerStalls(void);
+
+
+  private:
+    TrainingData& training_data_;
+    std::vector<unsigned> topology_;
+    std::vector<Batch> ring_;
+    std::vector<double> values_;    ///< Used by the loader thread only
+    std::thread loader_;
+    std::mutex mutex_;
+    std::condition_variable filled_;
+    std::condition_variable freed_;
+    unsigned batch_size_;
+    unsigned head_;                 ///< Oldest filled batch
+    unsigned count_;                ///< Filled batches, the held one too
+    unsigned long producer_stalls_;
+    unsigned long consumer_stalls_;
+    bool holding_;                  ///< Caller holds ring_[head_]
+    bool done_;
+    bool stop_;
+
+    AsyncLoader(const AsyncLoader&);
+    AsyncLoader& operator=(const AsyncLoader&);
+
+    /**
+     */
+    void Load(void);
+
+    /**
+     * @brief Parse up to a batch of samples; returns how many
+     */
+    unsigned Fill(Batch& batch);
+};
+
+
+// INLINE METHODS
+inline const std::vector<unsigned>&
+AsyncLoader::Topology(void) const
+{
+    return topology_;
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! ASYNC_LOADER_HH
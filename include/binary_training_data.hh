@@ -0,0 +1,258 @@
+/**
+ * @file binary_training_data.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#ifndef BINARY_TRAINING_DATA_HH
+#define BINARY_TRAINING_DATA_HH
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <training_data.hh>
+
+
+/* Read training data from a binary file, memory mapped
+ *
+ * A binary training file is laid out as follows, every number in the
+ * byte order of the machine that wrote it (checked on load):
+ *   - a 64 byte Header;
+ *   - the topology, one 32 bit unsigned per layer;
+ *   - starting on a 64 byte boundary, the samples in chunks of
+ *     ChunkSize() samples (the last one may be shorter).  A chunk holds
+ *     the inputs of all its samples back to back, then, on the next
+ *     64 byte boundary, their targets.  Every chunk takes the same
+ *     room, so the last one is padded.
+ *
+ * Values are either floats or doubles.  Samples can be read one by one
+ * through the same interface as TrainingData, or used in place through
+ * Inputs() and Targets(), with no copy nor parsing.
+ */
+class BinaryTrainingData
+{
+  public:
+    /**
+     */
+    struct Header {
+        char magic[8];            ///< "MINDATA\0"
+        uint32_t byte_order;      ///< 0x01020304, as written
+        uint32_t version;
+        uint32_t num_layers;
+        uint32_t value_size;      ///< sizeof(float) or sizeof(double)
+        uint64_t num_samples;
+        uint64_t chunk_size;      ///< Samples per chunk
+        uint64_t topology_offset; ///< In bytes
+        uint64_t data_offset;     ///< Of the first chunk, in bytes
+        uint64_t reserved;
+    };
+
+    /**
+     */
+    static const uint32_t kVersion = 1;
+
+
+    // LIFE CYCLE
+    /**
+     * @brief Map a binary training file; check IsOpen() before use
+     */
+    BinaryTrainingData(const std::string filename);
+
+    /**
+     */
+    ~BinaryTrainingData(void);
+
+
+    // OPERATIONS
+    /**
+     * @brief Convert text training data to a binary training file
+     *
+     * @param value_size Either sizeof(float) or sizeof(double)
+     * @param chunk_size Samples per chunk; only one chunk in memory is
+     *                   needed while converting
+     *
+     * @return Number of samples written, zero on failure
+     */
+    static uint64_t Convert(TrainingData& training_data,
+                            const std::string& filename,
+                            unsigned value_size,
+                            uint64_t chunk_size);
+
+    /**
+     */
+    bool IsEof(void);
+
+    /**
+     */
+    void Topology(std::vector<unsigned>& topology);
+
+    /**
+     * @brief Returns the number of input values of the next sample
+     */
+    unsigned NextInputs(std::vector<double>& input_values);
+
+    /**
+     * @brief Returns the number of target values of the sample whose
+     *        inputs were read last, and moves to the next one
+     */
+    unsigned TargetOutputs(std::vector<double>& target_output_values);
+
+    /**
+     * @brief Start reading from the first sample again
+     */
+    void Rewind(void);
+
+    /**
+     * @brief Input values of a sample, used in place
+     *
+     * @return Null if values are not of type @e T.  Samples of the same
+     *         chunk are back to back.
+     */
+    template <typename T>
+    const T* Inputs(uint64_t sample) const;
+
+    /**
+     * @brief Target values of a sample, used in place
+     *
+     * @return Null if values are not of type @e T.  Samples of the same
+     *         chunk are back to back.
+     */
+    template <typename T>
+    const T* Targets(uint64_t sample) const;
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    bool IsOpen(void) const;
+
+    /**
+     */
+    uint64_t NumSamples(void) const;
+
+    /**
+     */
+    uint64_t ChunkSize(void) const;
+
+    /**
+     * @brief sizeof(float) or sizeof(double)
+     */
+    unsigned ValueSize(void) const;
+
+
+  private:
+    std::vector<unsigned> topology_;
+    const char* data_;           ///< First chunk
+    void* mapping_;
+    std::size_t mapping_size_;
+    unsigned value_size_;
+    uint64_t num_samples_;
+    uint64_t chunk_size_;
+    uint64_t chunk_stride_;      ///< In bytes
+    uint64_t targets_offset_;    ///< From the start of a chunk, in bytes
+    uint64_t next_sample_;
+
+    BinaryTrainingData(const BinaryTrainingData&);
+    BinaryTrainingData& operator=(const BinaryTrainingData&);
+
+    /**
+     */
+    const char* Values(uint64_t sample, bool targets) const;
+
+    /**
+     */
+    unsigned Read(uint64_t sample, bool targets,
+                  std::vector<double>& values) const;
+};
+
+
+// INLINE METHODS
+template <typename T>
+inline const T*
+BinaryTrainingData::Inputs(uint64_t sample) const
+{
+    return sizeof(T) == value_size_
+        ? (const T*) Values(sample, false)
+        : 0;
+}
+
+
+template <typename T>
+inline const T*
+BinaryTrainingData::Targets(uint64_t sample) const
+{
+    return sizeof(T) == value_size_
+        ? (const T*) Values(sample, true)
+        : 0;
+}
+
+
+inline bool
+BinaryTrainingData::IsOpen(void) const
+{
+    return data_ != 0;
+}
+
+
+inline uint64_t
+BinaryTrainingData::NumSamples(void) const
+{
+    return num_samples_;
+}
+
+
+inline uint64_t
+BinaryTrainingData::ChunkSize(void) const
+{
+    return chunk_size_;
+}
+
+
+inline unsigned
+BinaryTrainingData::ValueSize(void) const
+{
+    return value_size_;
+}
+
+
+inline const char*
+BinaryTrainingData::Values(uint64_t sample, bool targets) const
+{
+    uint64_t chunk = sample / chunk_size_;
+    uint64_t index = sample % chunk_size_;
+    unsigned count = targets ? topology_.back() : topology_.front();
+
+    return data_ + chunk * chunk_stride_ +
+        (targets ? targets_offset_ : 0) + index * count * value_size_;
+}
+
+
+#endif // ! BINARY_TRAINING_DATA_HH
@@ -0,0 +1,156 @@
+/**
+ * @file data_set.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#ifndef DATA_SET_HH
+#define DATA_SET_HH
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+
+class BinaryTrainingData;
+class TrainingData;
+
+
+namespace MinAnn {
+
+/**
+ * @brief Training samples held in memory
+ *
+ * @details Inputs and targets are stored in two flat buffers, samples
+ *          back to back, so a data set is read once and then used for
+ *          as many epochs as needed.
+ */
+class DataSet {
+  public:
+    // LIFE CYCLE
+    /**
+     * @brief Empty data set for a net of the given topology
+     */
+    explicit DataSet(const std::vector<unsigned>& topology);
+
+    /**
+     * @brief Read every sample left in a training file
+     */
+    explicit DataSet(TrainingData& training_data);
+
+    /**
+     * @brief Read every sample left in a binary training file
+     */
+    explicit DataSet(BinaryTrainingData& training_data);
+
+
+    // OPERATIONS
+    /**
+     */
+    void Add(const double* input_values, const double* target_values);
+
+    /**
+     * @brief Move a random share of the samples to another data set,
+     *        e.g. to hold them out for validation
+     *
+     * @param fraction Share of samples to move, from zero to one
+     * @param held_out Receives the samples; must be empty
+     */
+    void Split(double fraction, unsigned long seed, DataSet& held_out);
+
+    /**
+     * @brief Random permutation of the sample indices in @e order
+     *
+     * @details Fisher-Yates, drawing from @e rng only, so a given seed
+     *          gives the same order on every platform.
+     */
+    static void Shuffle(std::vector<std::size_t>& order, std::mt19937& rng);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    const std::vector<unsigned>& Topology(void) const;
+
+    /**
+     */
+    std::size_t NumSamples(void) const;
+
+    /**
+     * @brief Inputs of a sample; the following samples come after it
+     */
+    const double* Inputs(std::size_t sample) const;
+
+    /**
+     * @brief Targets of a sample; the following samples come after it
+     */
+    const double* Targets(std::size_t sample) const;
+
+
+  private:
+    std::vector<unsigned> topology_;
+    std::vector<double> inputs_;
+    std::vector<double> targets_;
+    std::size_t num_samples_;
+};
+
+
+// INLINE METHODS
+inline const std::vector<unsigned>&
+DataSet::Topology(void) const
+{
+    return topology_;
+}
+
+
+inline std::size_t
+DataSet::NumSamples(void) const
+{
+    return num_samples_;
+}
+
+
+inline const double*
+DataSet::Inputs(std::size_t sample) const
+{
+    return &inputs_[sample * topology_.front()];
+}
+
+
+inline const double*
+DataSet::Targets(std::size_t sample) const
+{
+    return &targets_[sample * topology_.back()];
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! DATA_SET_HH
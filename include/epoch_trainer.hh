@@ -0,0 +1,193 @@
+/**
+ * @file epoch_trainer.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#ifndef EPOCH_TRAINER_HH
+#define EPOCH_TRAINER_HH
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <data_set.hh>
+#include <net.hh>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Train a net over a data set held in memory, epoch after epoch
+ *
+ * @details Every epoch visits all training samples once, in an order
+ *          shuffled by a seeded generator, and trains on them in
+ *          batches with Net::TrainBatch().  After each epoch the error
+ *          of the net is measured: the error of a held-out validation
+ *          set if there is one, Net::RecentAvgError() otherwise.
+ *          Training stops once that error has not improved for a number
+ *          of epochs, and the net is left with the weights of the best
+ *          epoch.  Only the inputs and outputs of the data sets must
+ *          match those of the net; their hidden layers are ignored, so
+ *          nets of any shape can be trained on the same data.
+ */
+class EpochTrainer {
+  public:
+    /**
+     */
+    struct Options {
+        unsigned batch_size;      ///< Samples per weight update
+        unsigned max_epochs;
+        unsigned patience;        ///< Epochs without improvement
+        double min_improvement;   ///< Smaller decreases do not count
+        unsigned long seed;       ///< Of the shuffling
+
+        /**
+         * @brief Online training, up to 100 epochs, patience of 5
+         */
+        Options(void);
+    };
+
+
+    // LIFE CYCLE
+    /**
+     */
+    EpochTrainer(Net& net, const DataSet& training_set,
+                 const Options& options);
+
+    /**
+     */
+    EpochTrainer(Net& net, const DataSet& training_set,
+                 const DataSet& validation_set, const Options& options);
+
+    /**
+     */
+    ~EpochTrainer(void);
+
+
+    // OPERATIONS
+    /**
+     * @brief Train one epoch
+     *
+     * @return False once training should stop; the net then holds the
+     *         weights of the best epoch
+     */
+    bool Epoch(void);
+
+    /**
+     * @brief Train until stopping
+     *
+     * @return Number of epochs run
+     */
+    unsigned Train(void);
+
+    /**
+     * @brief Mean RMS error of the net over a data set
+     */
+    static double Error(const Net& net, const DataSet& data_set);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     * @brief Number of epochs run so far
+     */
+    unsigned Epochs(void) const;
+
+    /**
+     */
+    unsigned BestEpoch(void) const;
+
+    /**
+     */
+    double BestError(void) const;
+
+    /**
+     * @brief Error measured after the last epoch
+     */
+    double LastError(void) const;
+
+
+  private:
+    Net& net_;
+    Net best_net_;
+    const DataSet& training_set_;
+    const DataSet* validation_set_;
+    Options options_;
+    std::mt19937 rng_;
+    std::vector<std::size_t> order_;
+    std::vector<double> input_values_;   ///< Batch, gathered from order_
+    std::vector<double> target_values_;
+    unsigned epochs_;
+    unsigned best_epoch_;
+    double best_error_;
+    double last_error_;
+    bool stopped_;
+
+    EpochTrainer(const EpochTrainer&);
+    EpochTrainer& operator=(const EpochTrainer&);
+
+    /**
+     */
+    void Init(void);
+};
+
+
+// INLINE METHODS
+inline unsigned
+EpochTrainer::Epochs(void) const
+{
+    return epochs_;
+}
+
+
+inline unsigned
+EpochTrainer::BestEpoch(void) const
+{
+    return best_epoch_;
+}
+
+
+inline double
+EpochTrainer::BestError(void) const
+{
+    return best_error_;
+}
+
+
+inline double
+EpochTrainer::LastError(void) const
+{
+    return last_error_;
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! EPOCH_TRAINER_HH
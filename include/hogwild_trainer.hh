@@ -0,0 +1,106 @@
+/**
+ * @file hogwild_trainer.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#ifndef HOGWILD_TRAINER_HH
+#define HOGWILD_TRAINER_HH
+
+#include <vector>
+
+#include <net.hh>
+#include <thread_pool.hh>
+#include <workspace.hh>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Lock-free asynchronous SGD ("Hogwild!")
+ *
+ * @details Threads claim samples from a shared counter and apply
+ *          per-sample updates straight to the shared weights through
+ *          Net::TrainShared(), without any barrier or lock.  Updates
+ *          racing on the same weight may be lost, and the result
+ *          depends on thread timing; in exchange small nets, where a
+ *          synchronous reduction would cost more than the gradients
+ *          themselves, scale with the number of threads.
+ */
+class HogwildTrainer {
+  public:
+    // LIFE CYCLE
+    /**
+     */
+    HogwildTrainer(Net& net, unsigned num_threads);
+
+    /**
+     */
+    ~HogwildTrainer(void);
+
+
+    // OPERATIONS
+    /**
+     * @brief One pass over the samples, stored back to back as in
+     *        Net::TrainBatch()
+     */
+    void Train(const std::vector<double>& input_values,
+               const std::vector<double>& target_values);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    unsigned NumThreads(void) const;
+
+
+  private:
+    /**
+     * @brief Samples claimed at once from the shared counter
+     */
+    static const unsigned kChunkSize = 16;
+
+    Net& net_;
+    ThreadPool pool_;
+    std::vector<Workspace> workspaces_;  ///< One per thread
+};
+
+
+// INLINE METHODS
+inline unsigned
+HogwildTrainer::NumThreads(void) const
+{
+    return pool_.Size();
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! HOGWILD_TRAINER_HH
@@ -0,0 +1,141 @@
+/**
+ * @file inference_client.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+
+#ifndef INFERENCE_CLIENT_HH
+#define INFERENCE_CLIENT_HH
+
+#include <cstddef>
+#include <string>
+
+#include <serve_protocol.hh>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Connection to an @c InferenceServer, one request at a time
+ *
+ * @details The connection is closed on the first failed request, after
+ *          which IsOpen() is false.  A client is not to be shared
+ *          between threads; open one per thread instead.
+ */
+class InferenceClient {
+  public:
+    // LIFE CYCLE
+    /**
+     * @brief Connect, and ask for the shape of the model served.
+     *        Check IsOpen() before use
+     */
+    explicit InferenceClient(const std::string& address);
+
+    /**
+     */
+    ~InferenceClient(void);
+
+
+    // OPERATIONS
+    /**
+     * @brief Outputs of the served model for a batch of samples
+     *
+     * @param input_values  @e rows rows of NumInputs() values
+     * @param result_values Room for @e rows rows of NumOutputs() values
+     */
+    bool Predict(const double* input_values, std::size_t rows,
+                 double* result_values);
+
+    /**
+     */
+    bool Stats(ServeProtocol::ServerStats& stats);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    bool IsOpen(void) const;
+
+    /**
+     */
+    unsigned NumInputs(void) const;
+
+    /**
+     */
+    unsigned NumOutputs(void) const;
+
+
+  private:
+    int fd_;
+    ServeProtocol::ModelInfo info_;
+
+    InferenceClient(const InferenceClient&);
+    InferenceClient& operator=(const InferenceClient&);
+
+    /**
+     * @brief Send a request, and read back a response of exactly
+     *        @e reply_size bytes
+     */
+    bool Call(ServeProtocol::Op op, uint32_t rows, const void* data,
+              std::size_t size, void* reply, std::size_t reply_size);
+
+    /**
+     */
+    void Close(void);
+};
+
+
+// INLINE METHODS
+inline bool
+InferenceClient::IsOpen(void) const
+{
+    return fd_ >= 0;
+}
+
+
+inline unsigned
+InferenceClient::NumInputs(void) const
+{
+    return info_.num_inputs;
+}
+
+
+inline unsigned
+InferenceClient::NumOutputs(void) const
+{
+    return info_.num_outputs;
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! INFERENCE_CLIENT_HH
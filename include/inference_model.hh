@@ -0,0 +1,227 @@
+/**
+ * @file inference_model.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#ifndef INFERENCE_MODEL_HH
+#define INFERENCE_MODEL_HH
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <activation.hh>
+#include <net.hh>
+#include <thread_pool.hh>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Read-only snapshot of a trained net, for inference only
+ *
+ * @details The weights of every layer are packed back to back in a
+ *          single buffer that is never written after construction, so
+ *          any number of threads may run Predict() on the same model at
+ *          once without locking.  Intermediate values live in a
+ *          Context, one per calling thread, so a prediction does not
+ *          allocate memory.
+ */
+class InferenceModel {
+  public:
+    /**
+     * @brief Per-thread scratch space for predictions
+     */
+    class Context {
+      public:
+        /**
+         */
+        explicit Context(const InferenceModel& model);
+
+      private:
+        friend class InferenceModel;
+
+        std::vector<double> scratch_;
+    };
+
+
+    // LIFE CYCLE
+    /**
+     * @brief Snapshot of the current weights of a net
+     */
+    explicit InferenceModel(const Net& net);
+
+    /**
+     * @brief Model saved with Net::Save(), used in place
+     *
+     * @details The file is memory mapped read-only and its weights are
+     *          used where they lie, with no copy nor parsing, so every
+     *          process serving the same file shares a single copy of it
+     *          through the page cache.  Check IsOpen() before use.
+     */
+    explicit InferenceModel(const std::string& filename);
+
+    /**
+     */
+    ~InferenceModel(void);
+
+
+    // OPERATIONS
+    /**
+     * @brief Outputs of the net for one sample
+     *
+     * @param input_values  NumInputs() values
+     * @param result_values Room for NumOutputs() values
+     * @param context       Scratch space owned by the calling thread
+     */
+    void Predict(const double* input_values, double* result_values,
+                 Context& context) const;
+
+    /**
+     * @brief Same as above, with a context private to the calling
+     *        thread that only allocates the first time it is used
+     */
+    void Predict(const double* input_values, double* result_values) const;
+
+    /**
+     * @brief Outputs of the net for a batch of samples
+     *
+     * @details Rows are run through every layer as matrix products, a
+     *          tile of rows at a time, with scratch space private to the
+     *          calling thread.
+     *
+     * @param input_values  @e rows rows of NumInputs() values
+     * @param result_values Room for @e rows rows of NumOutputs() values
+     */
+    void Predict(const double* input_values, std::size_t rows,
+                 double* result_values) const;
+
+    /**
+     * @brief Same as above, with the rows split evenly among the
+     *        threads of a pool
+     */
+    void Predict(const double* input_values, std::size_t rows,
+                 double* result_values, ThreadPool& pool) const;
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     * @brief Whether the model holds a net (it may not if its file
+     *        could not be loaded)
+     */
+    bool IsOpen(void) const;
+
+    /**
+     */
+    const std::vector<unsigned>& Topology(void) const;
+
+    /**
+     */
+    unsigned NumInputs(void) const;
+
+    /**
+     */
+    unsigned NumOutputs(void) const;
+
+
+  private:
+    /**
+     * @brief Rows run through the layers together in batch mode
+     */
+    static const unsigned kTileRows = 64;
+
+    std::vector<unsigned> topology_;
+    std::vector<ActivationFunction> activations_;
+    std::vector<uint64_t> offsets_;  ///< Per layer, into weights_
+    std::vector<double> storage_;    ///< Unless memory mapped
+    const double* weights_;
+    void* mapping_;
+    std::size_t mapping_size_;
+    unsigned max_width_;             ///< Widest layer, bias included
+
+    InferenceModel(const InferenceModel&);
+    InferenceModel& operator=(const InferenceModel&);
+
+    /**
+     */
+    void MeasureWidth(void);
+
+    /**
+     */
+    void Unmap(void);
+
+    /**
+     * @param scratch Room for twice the widest layer
+     */
+    void Forward(const double* input_values, double* result_values,
+                 double* scratch) const;
+
+    /**
+     * @brief Batch prediction on the calling thread
+     */
+    void ForwardBatch(const double* input_values, std::size_t rows,
+                      double* result_values) const;
+};
+
+
+// INLINE METHODS
+inline bool
+InferenceModel::IsOpen(void) const
+{
+    return weights_ != 0;
+}
+
+
+inline const std::vector<unsigned>&
+InferenceModel::Topology(void) const
+{
+    return topology_;
+}
+
+
+inline unsigned
+InferenceModel::NumInputs(void) const
+{
+    return topology_.front();
+}
+
+
+inline unsigned
+InferenceModel::NumOutputs(void) const
+{
+    return topology_.back();
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! INFERENCE_MODEL_HH
@@ -0,0 +1,203 @@
+/**
+ * @file inference_server.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+
+#ifndef INFERENCE_SERVER_HH
+#define INFERENCE_SERVER_HH
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <inference_model.hh>
+#include <serve_protocol.hh>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Prediction requests served over a local socket, coalesced
+ *        into micro-batches
+ *
+ * @details Each connection is read by a thread of its own, which
+ *          queues its requests and waits for their outputs.  A single
+ *          batching thread takes the queued requests together and runs
+ *          them through the model as one batch, so that concurrent
+ *          clients share the matrix products.  A batch is dispatched
+ *          as soon as any of these holds:
+ *
+ *          - it reaches Options::max_batch_rows rows;
+ *          - every open connection has a request queued, so no other
+ *            request can join it;
+ *          - its oldest request has waited Options::budget_us.
+ *
+ *          See @c ServeProtocol for the wire format.
+ */
+class InferenceServer {
+  public:
+    /**
+     */
+    struct Options {
+        std::size_t max_batch_rows;
+        unsigned budget_us;     ///< Longest a request waits for others
+
+        /**
+         * @brief Up to 256 rows, within 200 microseconds
+         */
+        Options(void);
+    };
+
+
+    // LIFE CYCLE
+    /**
+     * @param model Must outlive the server
+     */
+    InferenceServer(const InferenceModel& model, const Options& options);
+
+    /**
+     * @brief Stop serving, if still serving
+     */
+    ~InferenceServer(void);
+
+
+    // OPERATIONS
+    /**
+     * @brief Listen on @e address and serve from background threads
+     *
+     * @return False if the address could not be listened on
+     */
+    bool Start(const std::string& address);
+
+    /**
+     * @brief Close every connection, once its request in flight is
+     *        answered, and stop listening
+     */
+    void Stop(void);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    ServeProtocol::ServerStats Stats(void) const;
+
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @brief Queued by a connection thread, which waits for @e done
+     */
+    struct Request {
+        const double* input_values;
+        double* result_values;
+        std::size_t rows;
+        Clock::time_point arrived;
+        bool done;
+    };
+
+    const InferenceModel& model_;
+    Options options_;
+    std::string address_;
+    int listen_fd_;
+    std::thread accept_thread_;
+    std::thread batch_thread_;
+
+    // Connections, guarded by connections_mutex_
+    std::mutex connections_mutex_;
+    std::condition_variable connections_closed_;
+    std::vector<int> connection_fds_;
+    bool closing_;
+
+    // Queue, guarded by mutex_
+    mutable std::mutex mutex_;
+    std::condition_variable queued_;
+    std::condition_variable answered_;
+    std::deque<Request*> queue_;
+    std::size_t queued_rows_;
+    std::size_t open_connections_;
+    bool stopping_;
+
+    // Statistics, guarded by stats_mutex_
+    mutable std::mutex stats_mutex_;
+    Clock::time_point started_;
+    uint64_t requests_;
+    uint64_t rows_;
+    uint64_t batches_;
+    std::vector<float> latencies_us_;   ///< Ring of kLatencyWindow
+    std::size_t next_latency_;
+
+    InferenceServer(const InferenceServer&);
+    InferenceServer& operator=(const InferenceServer&);
+
+    /**
+     */
+    void AcceptLoop(void);
+
+    /**
+     * @brief Answer the requests of one connection until it closes
+     */
+    void Serve(int fd);
+
+    /**
+     * @brief Queue a request and wait for its outputs
+     */
+    void Submit(Request& request);
+
+    /**
+     */
+    void BatchLoop(void);
+
+    /**
+     * @brief Run a batch through the model, with no lock held
+     */
+    void RunBatch(const std::vector<Request*>& batch, std::size_t rows,
+                  std::vector<double>& input_values,
+                  std::vector<double>& result_values);
+
+    /**
+     */
+    static bool Reply(int fd, ServeProtocol::Status status,
+                      const void* data, std::size_t size);
+};
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! INFERENCE_SERVER_HH
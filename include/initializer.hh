@@ -0,0 +1,130 @@
+/**
+ * @file initializer.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#ifndef INITIALIZER_HH
+#define INITIALIZER_HH
+
+#include <stdint.h>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Reproducible initial weights from a counter-based generator
+ *
+ * @details Every weight is a pure function of the seed, the number of
+ *          its layer and its position in the layer, hashed the way
+ *          SplitMix64 does.  There is no generator state: nets can be
+ *          built from several threads at once, a layer can be filled
+ *          in any order (or in parallel) and the same seed always
+ *          gives the same net.
+ */
+class Initializer {
+  public:
+    /**
+     * @brief Distribution of the weights
+     */
+    enum Scheme {
+        kUniform = 0,   ///< In [0, 1), like the default constructors
+        kXavier,        ///< Glorot uniform, sqrt(6 / (fan in + out))
+        kHe             ///< He uniform, sqrt(6 / fan in); for ReLU
+    };
+
+    static const unsigned long kParallelThreshold = 1ul << 16; /**<
+        Fewest weights of a layer filled by several threads */
+
+
+    // LIFE CYCLE
+    /**
+     * @param num_threads Threads filling each large layer
+     */
+    explicit Initializer(uint64_t seed, Scheme scheme = kXavier,
+                         unsigned num_threads = 1);
+
+
+    // OPERATIONS
+    /**
+     * @brief Fill the weights of layer @e layer_num
+     *
+     * @details @e weights is laid out as in @c Layer, one row of
+     *          @e num_inputs + 1 weights (bias last) per neuron.
+     *          Xavier and He leave bias weights at zero.
+     */
+    template <typename T>
+    void Fill(T* weights, unsigned layer_num, unsigned num_neurons,
+              unsigned num_inputs) const;
+
+    /**
+     * @brief Uniform value in [0, 1) at position @e counter of stream
+     *        @e stream
+     */
+    static double Uniform(uint64_t seed, uint64_t stream,
+                          uint64_t counter);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    uint64_t Seed(void) const;
+
+    /**
+     */
+    Scheme Kind(void) const;
+
+
+  private:
+    uint64_t seed_;
+    Scheme scheme_;
+    unsigned num_threads_;
+};
+
+
+// INLINE METHODS
+inline uint64_t
+Initializer::Seed(void) const
+{
+    return seed_;
+}
+
+
+inline Initializer::Scheme
+Initializer::Kind(void) const
+{
+    return scheme_;
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! INITIALIZER_HH
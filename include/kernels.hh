@@ -0,0 +1,495 @@
+/**
+ * @file kernels.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#ifndef KERNELS_HH
+#define KERNELS_HH
+
+#include <stdint.h>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Dense layer kernels with run-time instruction set dispatch
+ *
+ * @details Weight matrices are row-major, one row per destination
+ *          neuron and one column per input (bias included), as laid
+ *          out by @c Layer.  The best instruction set available on the
+ *          running CPU is picked on start-up; a portable scalar
+ *          version is always available.  Every operation comes in
+ *          double and single precision.
+ */
+class Kernels {
+  public:
+    /**
+     * @brief Instruction sets with a dedicated implementation
+     */
+    enum Isa {
+        kScalar = 0,
+        kSse2,
+        kAvx2,
+        kAvx512
+    };
+
+    /**
+     * @brief Implementations of the transfer function
+     */
+    enum TanhMode {
+        kExact = 0,     ///< @c std::tanh, one value at a time
+        kFast           ///< Vectorized rational approximation
+    };
+
+
+    // OPERATIONS
+    /**
+     * @brief Matrix-vector product
+     *
+     * @note @f$y_j = \sum_{i} w_{ji} x_i@f$, for @e j < @e rows
+     */
+    static void MatVec(const double* w, const double* x, double* y,
+                       unsigned rows, unsigned cols);
+
+    /**
+     */
+    static void MatVec(const float* w, const float* x, float* y,
+                       unsigned rows, unsigned cols);
+
+    /**
+     * @brief Same as above on 8 bit integers, accumulated in 32 bits
+     *
+     * @note Exact as long as every row sums fewer than 2^17 products
+     */
+    static void MatVec(const int8_t* w, const int8_t* x, int32_t* y,
+                       unsigned rows, unsigned cols);
+
+    /**
+     * @brief Transposed matrix-vector product over the first @e n
+     *        columns
+     *
+     * @note @f$y_i = \sum_{j} w_{ji} g_j@f$, for @e i < @e n
+     */
+    static void MatTVec(const double* w, const double* g, double* y,
+                        unsigned rows, unsigned cols, unsigned n);
+
+    /**
+     */
+    static void MatTVec(const float* w, const float* g, float* y,
+                        unsigned rows, unsigned cols, unsigned n);
+
+    /**
+     * @brief Gradient descent with momentum, for a whole matrix
+     *
+     * @note @f$\Delta w_{ji} = \eta x_i g_j + \alpha \Delta w_{ji}@f$,
+     *       then @f$w_{ji} = w_{ji} + \Delta w_{ji}@f$
+     */
+    static void MomentumUpdate(double* w, double* dw,
+                               const double* x, const double* g,
+                               unsigned rows, unsigned cols,
+                               double eta, double alpha);
+
+    /**
+     */
+    static void MomentumUpdate(float* w, float* dw,
+                               const float* x, const float* g,
+                               unsigned rows, unsigned cols,
+                               float eta, float alpha);
+
+    /**
+     * @brief Nesterov accelerated gradient, for a whole matrix
+     *
+     * @note @f$v_{ji} = \alpha v_{ji} + \eta x_i g_j@f$, then
+     *       @f$w_{ji} = w_{ji} + \alpha v_{ji} + \eta x_i g_j@f$
+     */
+    static void NesterovUpdate(double* w, double* v,
+                               const double* x, const double* g,
+                               unsigned rows, unsigned cols,
+                               double eta, double alpha);
+
+    /**
+     */
+    static void NesterovUpdate(float* w, float* v,
+                               const float* x, const float* g,
+                               unsigned rows, unsigned cols,
+                               float eta, float alpha);
+
+    /**
+     * @brief RMSProp, for a whole matrix
+     *
+     * @note With @f$d_{ji} = x_i g_j@f$:
+     *       @f$s_{ji} = \rho s_{ji} + (1 - \rho) d_{ji}^2@f$, then
+     *       @f$w_{ji} = w_{ji} + \eta d_{ji} / (\sqrt{s_{ji}} +
+     *       \epsilon)@f$
+     */
+    static void RmsPropUpdate(double* w, double* s,
+                              const double* x, const double* g,
+                              unsigned rows, unsigned cols,
+                              double eta, double rho, double epsilon);
+
+    /**
+     */
+    static void RmsPropUpdate(float* w, float* s,
+                              const float* x, const float* g,
+                              unsigned rows, unsigned cols,
+                              float eta, float rho, float epsilon);
+
+    /**
+     * @brief Adam, for a whole matrix
+     *
+     * @details Bias correction is left to the caller, folded into
+     *          @e eta and @e epsilon.
+     *
+     * @note With @f$d_{ji} = x_i g_j@f$:
+     *       @f$m_{ji} = \beta_1 m_{ji} + (1 - \beta_1) d_{ji}@f$,
+     *       @f$v_{ji} = \beta_2 v_{ji} + (1 - \beta_2) d_{ji}^2@f$,
+     *       then @f$w_{ji} = w_{ji} + \eta m_{ji} / (\sqrt{v_{ji}} +
+     *       \epsilon)@f$
+     */
+    static void AdamUpdate(double* w, double* m, double* v,
+                           const double* x, const double* g,
+                           unsigned rows, unsigned cols, double eta,
+                           double beta1, double beta2, double epsilon);
+
+    /**
+     */
+    static void AdamUpdate(float* w, float* m, float* v,
+                           const float* x, const float* g,
+                           unsigned rows, unsigned cols, float eta,
+                           float beta1, float beta2, float epsilon);
+
+    /**
+     * @brief Cache-blocked matrix product against a transposed matrix
+     *
+     * @details @e A is @e m x @e k (row stride @e lda), @e B is @e n x
+     *          @e k (row stride @e k) and @e C is @e m x @e n (row
+     *          stride @e ldc)
+     *
+     * @note @f$C = A B^T@f$
+     */
+    static void GemmNT(const double* a, const double* b, double* c,
+                       unsigned m, unsigned n, unsigned k,
+                       unsigned lda, unsigned ldc);
+
+    /**
+     */
+    static void GemmNT(const float* a, const float* b, float* c,
+                       unsigned m, unsigned n, unsigned k,
+                       unsigned lda, unsigned ldc);
+
+    /**
+     * @brief Cache-blocked matrix product
+     *
+     * @details @e A is @e m x @e k (row stride @e lda), @e B is @e k x
+     *          @e n (row stride @e ldb) and @e C is @e m x @e n (row
+     *          stride @e ldc)
+     *
+     * @note @f$C = A B@f$
+     */
+    static void GemmNN(const double* a, const double* b, double* c,
+                       unsigned m, unsigned n, unsigned k,
+                       unsigned lda, unsigned ldb, unsigned ldc);
+
+    /**
+     */
+    static void GemmNN(const float* a, const float* b, float* c,
+                       unsigned m, unsigned n, unsigned k,
+                       unsigned lda, unsigned ldb, unsigned ldc);
+
+    /**
+     * @brief Hyperbolic tangent of @e n values, in place
+     *
+     * @details The fast implementation clamps its input to +/-7.9 and
+     *          evaluates a rational function of degree 13/6.  Its
+     *          absolute error is below 3e-7 in double precision and
+     *          4e-7 in single precision, whatever the instruction set.
+     */
+    static void Tanh(double* x, unsigned n);
+
+    /**
+     */
+    static void Tanh(float* x, unsigned n);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     * @brief Best instruction set supported by the running CPU
+     */
+    static Isa Detect(void);
+
+    /**
+     * @brief Force an instruction set, clamped to what the CPU supports
+     */
+    static void Select(Isa isa);
+
+    /**
+     */
+    static Isa Selected(void);
+
+    /**
+     * @brief Pick the implementation of Tanh(); exact by default
+     */
+    static void SelectTanhMode(TanhMode tanh_mode);
+
+    /**
+     */
+    static TanhMode SelectedTanhMode(void);
+
+    /**
+     */
+    static const char* Name(Isa isa);
+
+
+  private:
+    typedef void (*MatVecFn)(const double*, const double*, double*,
+                             unsigned, unsigned);
+    typedef void (*MatTVecFn)(const double*, const double*, double*,
+                              unsigned, unsigned, unsigned);
+    typedef void (*MomentumUpdateFn)(double*, double*,
+                                     const double*, const double*,
+                                     unsigned, unsigned, double, double);
+    typedef void (*GemmNTFn)(const double*, const double*, double*,
+                             unsigned, unsigned, unsigned,
+                             unsigned, unsigned);
+    typedef void (*MatVecFloatFn)(const float*, const float*, float*,
+                                  unsigned, unsigned);
+    typedef void (*MatTVecFloatFn)(const float*, const float*, float*,
+                                   unsigned, unsigned, unsigned);
+    typedef void (*MomentumUpdateFloatFn)(float*, float*,
+                                          const float*, const float*,
+                                          unsigned, unsigned, float, float);
+    typedef void (*GemmNTFloatFn)(const float*, const float*, float*,
+                                  unsigned, unsigned, unsigned,
+                                  unsigned, unsigned);
+    typedef void (*MatVecInt8Fn)(const int8_t*, const int8_t*, int32_t*,
+                                 unsigned, unsigned);
+    typedef void (*TanhFn)(double*, unsigned);
+    typedef void (*TanhFloatFn)(float*, unsigned);
+    typedef void (*RmsPropUpdateFn)(double*, double*,
+                                    const double*, const double*,
+                                    unsigned, unsigned,
+                                    double, double, double);
+    typedef void (*RmsPropUpdateFloatFn)(float*, float*,
+                                         const float*, const float*,
+                                         unsigned, unsigned,
+                                         float, float, float);
+    typedef void (*AdamUpdateFn)(double*, double*, double*,
+                                 const double*, const double*,
+                                 unsigned, unsigned,
+                                 double, double, double, double);
+    typedef void (*AdamUpdateFloatFn)(float*, float*, float*,
+                                      const float*, const float*,
+                                      unsigned, unsigned,
+                                      float, float, float, float);
+
+    static Isa isa_;
+    static MatVecFn mat_vec_;
+    static MatTVecFn mat_t_vec_;
+    static MomentumUpdateFn momentum_update_;
+    static GemmNTFn gemm_nt_;   ///< On a block that fits in cache
+    static MatVecFloatFn mat_vec_float_;
+    static MatTVecFloatFn mat_t_vec_float_;
+    static MomentumUpdateFloatFn momentum_update_float_;
+    static GemmNTFloatFn gemm_nt_float_;
+    static MatVecInt8Fn mat_vec_int8_;
+    static TanhMode tanh_mode_;
+    static TanhFn tanh_;
+    static TanhFloatFn tanh_float_;
+    static MomentumUpdateFn nesterov_update_;   ///< Same signature
+    static RmsPropUpdateFn rms_prop_update_;
+    static AdamUpdateFn adam_update_;
+    static MomentumUpdateFloatFn nesterov_update_float_;
+    static RmsPropUpdateFloatFn rms_prop_update_float_;
+    static AdamUpdateFloatFn adam_update_float_;
+
+    /**
+     */
+    static void SelectOptimizersScalar(void);
+
+    /**
+     */
+    static void SelectOptimizersAvx2(void);
+};
+
+
+// INLINE METHODS
+inline void
+Kernels::MatVec(const double* w, const double* x, double* y,
+                unsigned rows, unsigned cols)
+{
+    mat_vec_(w, x, y, rows, cols);
+}
+
+
+inline void
+Kernels::MatTVec(const double* w, const double* g, double* y,
+                 unsigned rows, unsigned cols, unsigned n)
+{
+    mat_t_vec_(w, g, y, rows, cols, n);
+}
+
+
+inline void
+Kernels::MomentumUpdate(double* w, double* dw,
+                        const double* x, const double* g,
+                        unsigned rows, unsigned cols,
+                        double eta, double alpha)
+{
+    momentum_update_(w, dw, x, g, rows, cols, eta, alpha);
+}
+
+
+inline void
+Kernels::MatVec(const float* w, const float* x, float* y,
+                unsigned rows, unsigned cols)
+{
+    mat_vec_float_(w, x, y, rows, cols);
+}
+
+
+inline void
+Kernels::MatVec(const int8_t* w, const int8_t* x, int32_t* y,
+                unsigned rows, unsigned cols)
+{
+    mat_vec_int8_(w, x, y, rows, cols);
+}
+
+
+inline void
+Kernels::MatTVec(const float* w, const float* g, float* y,
+                 unsigned rows, unsigned cols, unsigned n)
+{
+    mat_t_vec_float_(w, g, y, rows, cols, n);
+}
+
+
+inline void
+Kernels::MomentumUpdate(float* w, float* dw,
+                        const float* x, const float* g,
+                        unsigned rows, unsigned cols,
+                        float eta, float alpha)
+{
+    momentum_update_float_(w, dw, x, g, rows, cols, eta, alpha);
+}
+
+
+inline void
+Kernels::NesterovUpdate(double* w, double* v,
+                        const double* x, const double* g,
+                        unsigned rows, unsigned cols,
+                        double eta, double alpha)
+{
+    nesterov_update_(w, v, x, g, rows, cols, eta, alpha);
+}
+
+
+inline void
+Kernels::NesterovUpdate(float* w, float* v,
+                        const float* x, const float* g,
+                        unsigned rows, unsigned cols,
+                        float eta, float alpha)
+{
+    nesterov_update_float_(w, v, x, g, rows, cols, eta, alpha);
+}
+
+
+inline void
+Kernels::RmsPropUpdate(double* w, double* s,
+                       const double* x, const double* g,
+                       unsigned rows, unsigned cols,
+                       double eta, double rho, double epsilon)
+{
+    rms_prop_update_(w, s, x, g, rows, cols, eta, rho, epsilon);
+}
+
+
+inline void
+Kernels::RmsPropUpdate(float* w, float* s,
+                       const float* x, const float* g,
+                       unsigned rows, unsigned cols,
+                       float eta, float rho, float epsilon)
+{
+    rms_prop_update_float_(w, s, x, g, rows, cols, eta, rho, epsilon);
+}
+
+
+inline void
+Kernels::AdamUpdate(double* w, double* m, double* v,
+                    const double* x, const double* g,
+                    unsigned rows, unsigned cols, double eta,
+                    double beta1, double beta2, double epsilon)
+{
+    adam_update_(w, m, v, x, g, rows, cols, eta, beta1, beta2, epsilon);
+}
+
+
+inline void
+Kernels::AdamUpdate(float* w, float* m, float* v,
+                    const float* x, const float* g,
+                    unsigned rows, unsigned cols, float eta,
+                    float beta1, float beta2, float epsilon)
+{
+    adam_update_float_(w, m, v, x, g, rows, cols, eta, beta1, beta2,
+                       epsilon);
+}
+
+
+inline Kernels::Isa
+Kernels::Selected(void)
+{
+    return isa_;
+}
+
+
+inline void
+Kernels::Tanh(double* x, unsigned n)
+{
+    tanh_(x, n);
+}
+
+
+inline void
+Kernels::Tanh(float* x, unsigned n)
+{
+    tanh_float_(x, n);
+}
+
+
+inline Kernels::TanhMode
+Kernels::SelectedTanhMode(void)
+{
+    return tanh_mode_;
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! KERNELS_HH
@@ -0,0 +1,383 @@
+/**
+ * @file layer.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#ifndef LAYER_HH
+#define LAYER_HH
+
+#include <vector>
+
+#include <activation.hh>
+#include <initializer.hh>
+#include <optimizer.hh>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Layer of neurons stored as contiguous buffers
+ *
+ * @details Outputs and gradients are kept in flat arrays with one
+ *          extra slot at the end for the bias neuron, whose output is
+ *          always 1.0.  Input weights (and their last deltas) are
+ *          stored row-major: row @e j holds the weights from every
+ *          neuron of the previous layer (bias included) to neuron
+ *          @e j of this layer, so every pass walks memory linearly.
+ *
+ *          Values are of type @e T, either @c float or @c double.
+ */
+template <typename T>
+class BasicLayer {
+  public:
+    // LIFE CYCLE
+    /**
+     * @param num_neurons Number of neurons, not counting the bias
+     * @param num_inputs  Number of neurons in the previous layer, not
+     *                    counting its bias (zero for the input layer)
+     * @param activation  Transfer function of its neurons
+     */
+    BasicLayer(unsigned num_neurons, unsigned num_inputs,
+               Activation activation = kTanh);
+
+    /**
+     * @brief Same as above, with weights drawn by @e initializer
+     *        instead of @c rand()
+     *
+     * @param layer_num Position of the layer in its net
+     */
+    BasicLayer(unsigned num_neurons, unsigned num_inputs,
+               Activation activation, const Initializer& initializer,
+               unsigned layer_num);
+
+    /**
+     * @brief Same as above, with the given weights (NumInputs() per
+     *        neuron, as in a model file), drawing no random number
+     */
+    BasicLayer(unsigned num_neurons, unsigned num_inputs,
+               Activation activation, const double* weights);
+
+    /**
+     */
+    ~BasicLayer(void);
+
+
+    // OPERATIONS
+    /**
+     *
+     * @note output_j = @f$f(\sum_{i=0}^{n} x_i w_{ji})@f$
+     */
+    void FeedForward(const BasicLayer& prev_layer);
+
+    /**
+     */
+    void UpdateInputWeights(const BasicLayer& prev_layer);
+
+    /**
+     */
+    void CalcOutputGradients(const std::vector<T>& target_values);
+
+    /**
+     */
+    void CalcHiddenGradients(const BasicLayer& next_layer);
+
+    /**
+     * @brief Feed a whole batch forward
+     *
+     * @param inputs  Previous layer's outputs, one row of NumInputs()
+     *                values per sample
+     * @param outputs One row of Size() + 1 values per sample; the last
+     *                column is set to the bias output
+     */
+    void FeedForwardBatch(const T* inputs, T* outputs,
+                          unsigned batch_size) const;
+
+    /**
+     * @param outputs   One row of Size() + 1 values per sample
+     * @param targets   One row of Size() values per sample
+     * @param gradients One row of Size() + 1 values per sample
+     */
+    void CalcOutputGradientsBatch(const T* outputs,
+                                  const T* targets,
+                                  T* gradients,
+                                  unsigned batch_size) const;
+
+    /**
+     * @param next_gradients Next layer's gradients, one row of
+     *                       next_layer.Size() + 1 values per sample
+     */
+    void CalcHiddenGradientsBatch(const BasicLayer& next_layer,
+                                  const T* next_gradients,
+                                  const T* outputs,
+                                  T* gradients,
+                                  unsigned batch_size) const;
+
+    /**
+     * @brief Input weight gradients summed over a batch
+     *
+     * @param weight_gradients Size() x NumInputs() values, overwritten
+     * @param scratch          Room for Size() x @e batch_size values
+     */
+    void CalcWeightGradientsBatch(const T* inputs,
+                                  const T* gradients,
+                                  T* weight_gradients,
+                                  T* scratch,
+                                  unsigned batch_size) const;
+
+    /**
+     * @brief One optimizer step along summed weight gradients
+     *
+     * @param scale Factor applied to the gradients (usually one over
+     *              the number of samples they were summed over)
+     */
+    void ApplyWeightGradients(const T* weight_gradients, T scale);
+
+    /**
+     * @brief Same as FeedForwardBatch() for a single sample, reading
+     *        the weights with relaxed atomic loads
+     *
+     * @details The @e Shared operations may run concurrently with each
+     *          other on the same layer (lock-free asynchronous training)
+     *          but not with any other operation that touches weights.
+     */
+    void FeedForwardShared(const T* inputs, T* outputs) const;
+
+    /**
+     * @brief Same as CalcHiddenGradientsBatch() for a single sample,
+     *        reading the weights with relaxed atomic loads
+     */
+    void CalcHiddenGradientsShared(const BasicLayer& next_layer,
+                                   const T* next_gradients,
+                                   const T* outputs,
+                                   T* gradients) const;
+
+    /**
+     * @brief Same as UpdateInputWeights() for a single sample, with
+     *        relaxed atomic loads and stores and no locking
+     *
+     * @note Concurrent updates to the same weight may overwrite each
+     *       other; asynchronous SGD tolerates those lost updates.  The
+     *       layer's optimizer is followed, as in UpdateInputWeights().
+     */
+    void UpdateInputWeightsShared(const T* inputs,
+                                  const T* gradients);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     * @brief Number of neurons, not counting the bias
+     */
+    unsigned Size(void) const;
+
+    /**
+     * @brief Number of input weights per neuron, bias included
+     */
+    unsigned NumInputs(void) const;
+
+    /**
+     * @brief Transfer function of its neurons
+     */
+    Activation TransferKind(void) const;
+
+    /**
+     */
+    void OutputValue(unsigned n, const T value);
+
+    /**
+     */
+    T OutputValue(unsigned n) const;
+
+    /**
+     * @brief Input weights, Size() rows of NumInputs() values
+     */
+    const T* Weights(void) const;
+
+    /**
+     * @brief Replace the input weights, forgetting the last deltas
+     */
+    void Weights(const T* weights);
+
+    /**
+     * @brief Learning rate [0., 1.]
+     *
+     * @details Overall net training rate:
+     *        - @e eta = 0.0, means slow learner;
+     *        - @e eta = 0.2, medium learner;
+     *        - @e eta = 1.0, reckless learner;
+     */
+    double LearningRate(void) const;
+
+    /**
+     */
+    void LearningRate(double eta);
+
+    /**
+     * @brief Momentum [0., n]
+     *
+     * @details Multiplier of last weight change (of last delta weight):
+     *        - @e alpha = 0.0, no momentum;
+     *        - @e alpha = 0.5, moderate momentum;
+     */
+    double Momentum(void) const;
+
+    /**
+     */
+    void Momentum(double alpha);
+
+    /**
+     * @brief Weight update rule; momentum unless set
+     */
+    Optimizer OptimizerKind(void) const;
+
+    /**
+     * @brief Switch the update rule, forgetting its state
+     */
+    void OptimizerKind(Optimizer kind);
+
+
+  private:
+    static double kEta;     ///< Learning rate of new layers
+    static double kAlpha;   ///< Momentum of new layers
+
+    BasicActivationFunction<T> activation_;
+    unsigned num_neurons_;
+    unsigned num_inputs_;
+    std::vector<T> output_values_;  ///< Size + 1 (bias)
+    std::vector<T> gradients_;      ///< Size + 1 (bias)
+    std::vector<T> weights_;        ///< Size x NumInputs
+    BasicOptimizer<T> optimizer_;   ///< State of Size x NumInputs
+};
+
+
+// INLINE METHODS
+template <typename T>
+inline unsigned
+BasicLayer<T>::Size(void) const
+{
+    return num_neurons_;
+}
+
+
+template <typename T>
+inline unsigned
+BasicLayer<T>::NumInputs(void) const
+{
+    return num_inputs_;
+}
+
+
+template <typename T>
+inline Activation
+BasicLayer<T>::TransferKind(void) const
+{
+    return activation_.Kind();
+}
+
+
+template <typename T>
+inline const T*
+BasicLayer<T>::Weights(void) const
+{
+    return weights_.empty() ? 0 : &weights_[0];
+}
+
+
+template <typename T>
+inline void
+BasicLayer<T>::OutputValue(unsigned n, const T value) {
+    output_values_[n] = value;
+}
+
+
+template <typename T>
+inline T
+BasicLayer<T>::OutputValue(unsigned n) const
+{
+    return output_values_[n];
+}
+
+
+template <typename T>
+inline double
+BasicLayer<T>::LearningRate(void) const
+{
+    return optimizer_.LearningRate();
+}
+
+
+template <typename T>
+inline void
+BasicLayer<T>::LearningRate(double eta)
+{
+    optimizer_.LearningRate(eta);
+}
+
+
+template <typename T>
+inline double
+BasicLayer<T>::Momentum(void) const
+{
+    return optimizer_.Momentum();
+}
+
+
+template <typename T>
+inline void
+BasicLayer<T>::Momentum(double alpha)
+{
+    optimizer_.Momentum(alpha);
+}
+
+
+template <typename T>
+inline Optimizer
+BasicLayer<T>::OptimizerKind(void) const
+{
+    return optimizer_.Kind();
+}
+
+
+template <typename T>
+inline void
+BasicLayer<T>::OptimizerKind(Optimizer kind)
+{
+    optimizer_.Kind(kind);
+}
+
+
+/**
+ */
+typedef BasicLayer<double> Layer;
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! LAYER_HH
@@ -0,0 +1,177 @@
+/**
+ * @file live_model.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#ifndef LIVE_MODEL_HH
+#define LIVE_MODEL_HH
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include <inference_model.hh>
+#include <net.hh>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Latest published snapshot of a net that keeps training
+ *
+ * @details RCU style: a single trainer thread publishes immutable
+ *          @c InferenceModel snapshots through an atomic pointer,
+ *          while any number of serving threads, each through its own
+ *          Reader, predict with the latest one.  Readers never lock
+ *          nor retry: pinning a snapshot is a fixed number of atomic
+ *          operations.  A replaced snapshot is freed by the trainer,
+ *          on a later Publish() or Reclaim(), once no reader that
+ *          might have seen it is still inside a read section.
+ *
+ *          Each read section is tagged with the epoch it started in;
+ *          a snapshot retired at epoch @e e is freed once no reader
+ *          is pinned at an epoch before @e e.
+ */
+class LiveModel {
+  public:
+    static const unsigned kMaxReaders = 64;
+
+
+    /**
+     * @brief Read side, owned by a single serving thread
+     */
+    class Reader {
+      public:
+        /**
+         * @brief Take one of the kMaxReaders slots; aborts if there is
+         *        none left
+         */
+        explicit Reader(LiveModel& live_model);
+
+        /**
+         */
+        ~Reader(void);
+
+        /**
+         * @brief Pin the latest snapshot until Release()
+         *
+         * @note Pins do not nest: one snapshot at a time per reader
+         */
+        const InferenceModel& Acquire(void);
+
+        /**
+         */
+        void Release(void);
+
+        /**
+         * @brief Outputs of the latest snapshot for one sample
+         */
+        void Predict(const double* input_values, double* result_values);
+
+        /**
+         * @brief Same as above, for a batch of @e rows samples
+         */
+        void Predict(const double* input_values, std::size_t rows,
+                     double* result_values);
+
+      private:
+        Reader(const Reader&);
+        Reader& operator=(const Reader&);
+
+        LiveModel& live_model_;
+        unsigned slot_;
+    };
+
+
+    // LIFE CYCLE
+    /**
+     * @brief Publish a first snapshot of @e net
+     */
+    explicit LiveModel(const Net& net);
+
+    /**
+     * @note Every Reader must be gone
+     */
+    ~LiveModel(void);
+
+
+    // OPERATIONS
+    /**
+     * @brief Replace the snapshot by one of the current weights of
+     *        @e net, then free what no reader can still use
+     *
+     * @note Only one thread may publish
+     */
+    void Publish(const Net& net);
+
+    /**
+     * @brief Free the replaced snapshots no reader can still use
+     *
+     * @return Number of replaced snapshots still waiting
+     */
+    std::size_t Reclaim(void);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     * @brief Number of snapshots published, the first one included
+     */
+    uint64_t Version(void) const;
+
+
+  private:
+    static const uint64_t kIdle = 0;
+
+    /**
+     * @brief Epoch a reader is pinned at, alone in its cache line
+     */
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch;
+        std::atomic<bool> taken;
+    };
+
+    LiveModel(const LiveModel&);
+    LiveModel& operator=(const LiveModel&);
+
+    std::atomic<const InferenceModel*> current_;
+    std::atomic<uint64_t> epoch_;       ///< Same as Version()
+    Slot slots_[kMaxReaders];
+    std::vector<std::pair<const InferenceModel*, uint64_t> > retired_; /**<
+        With the epoch they were replaced at; trainer only */
+};
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! LIVE_MODEL_HH
@@ -0,0 +1,113 @@
+/**
+ * @file metrics_writer.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#ifndef METRICS_WRITER_HH
+#define METRICS_WRITER_HH
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Training metrics, one record per line, through a large buffer
+ *
+ * @details Records are CSV, after a header line, or JSON objects (JSON
+ *          lines).  Nothing is flushed until the buffer fills up or
+ *          the writer is destroyed, so that writing a loss curve costs
+ *          next to nothing while training.
+ */
+class MetricsWriter {
+  public:
+    /**
+     */
+    enum Format {
+        kCsv = 0,
+        kJsonLines
+    };
+
+    static const std::size_t kBufferSize = 1 << 16;
+
+
+    // LIFE CYCLE
+    /**
+     */
+    MetricsWriter(const std::string& filename, Format format);
+
+    /**
+     * @brief Flush and close the file
+     */
+    ~MetricsWriter(void);
+
+
+    // OPERATIONS
+    /**
+     * @brief Record the errors after @e sample samples, at @e seconds
+     *        since training started
+     */
+    void Write(unsigned long sample, double error,
+               double recent_avg_error, double seconds);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     * @brief Whether the file could be created
+     */
+    bool IsOpen(void) const;
+
+
+  private:
+    MetricsWriter(const MetricsWriter&);
+    MetricsWriter& operator=(const MetricsWriter&);
+
+    std::vector<char> buffer_;  ///< Outlives the file, closed first
+    std::FILE* file_;
+    Format format_;
+};
+
+
+// INLINE METHODS
+inline bool
+MetricsWriter::IsOpen(void) const
+{
+    return file_ != 0;
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! METRICS_WRITER_HH
@@ -0,0 +1,126 @@
+/**
+ * @file model_file.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#ifndef MODEL_FILE_HH
+#define MODEL_FILE_HH
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <activation.hh>
+
+namespace MinAnn {
+
+/**
+ * @brief Binary model format
+ *
+ * @details A model file is laid out as follows, every number in the
+ *          byte order of the machine that wrote it (checked on load):
+ *          - a 64 byte Header;
+ *          - one LayerEntry per layer, the input one first;
+ *          - starting on a 64 byte boundary, the weights of every layer
+ *            but the input one, as doubles, row-major (one row per
+ *            neuron, one column per input, bias last), each layer
+ *            starting on a 64 byte boundary as well (see Layout()).
+ *
+ *          Weights can thus be used straight from a memory mapping of
+ *          the file, with no copy nor parsing.
+ */
+class ModelFile {
+  public:
+    /**
+     */
+    static const uint32_t kVersion = 1;
+
+    /**
+     */
+    struct Header {
+        char magic[8];           ///< "MINANN\0\0"
+        uint32_t byte_order;     ///< 0x01020304, as written
+        uint32_t version;
+        uint32_t num_layers;
+        uint32_t reserved0;
+        uint64_t layers_offset;  ///< Of the first LayerEntry, in bytes
+        uint64_t weights_offset; ///< Of the first weight, in bytes
+        uint64_t num_weights;    ///< Doubles, padding included
+        uint64_t reserved1[2];
+    };
+
+    /**
+     */
+    struct LayerEntry {
+        uint32_t size;           ///< Neurons, not counting the bias
+        uint32_t activation;     ///< One of Activation
+    };
+
+
+    // OPERATIONS
+    /**
+     * @brief Position of every layer's weights in the weight block
+     *
+     * @param offsets Filled with one offset per layer, in doubles
+     *
+     * @return Size of the weight block, in doubles
+     */
+    static uint64_t Layout(const std::vector<unsigned>& topology,
+                           std::vector<uint64_t>& offsets);
+
+    /**
+     * @param weights One pointer per layer (ignored for the input one)
+     *                to its packed weights
+     *
+     * @return Whether the file could be written
+     */
+    static bool Write(const std::string& filename,
+                      const std::vector<unsigned>& topology,
+                      const std::vector<Activation>& activations,
+                      const std::vector<const double*>& weights);
+
+    /**
+     * @brief Check a model file held in memory and locate its parts
+     *
+     * @return Whether @e data holds a valid model; on success
+     *         @e topology, @e activations and @e weights are set
+     */
+    static bool Parse(const char* data, std::size_t size,
+                      std::vector<unsigned>& topology,
+                      std::vector<Activation>& activations,
+                      const double*& weights);
+};
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! MODEL_FILE_HH
@@ -33,70 +33,268 @@
 #ifndef NET_HH
 #define NET_HH
 
+#include <string>
 #include <vector>
 
+#include <activation.hh>
+#include <initializer.hh>
+#include <layer.hh>
+#include <workspace.hh>
 
-namespace MinAnn {
-
-class Neuron;
 
+namespace MinAnn {
 
 /**
+ * @brief Feed-forward net trained by back propagation
+ *
+ * @details Weights and activations are of type @e T, either @c float
+ *          or @c double; errors are always measured in double.  @c Net
+ *          is the double precision net.
  */
-class Net {
+template <typename T>
+class BasicNet {
   public:
     // LIFE CYCLE
     /**
+     * @brief Net whose every layer uses tanh
+     */
+    BasicNet(const std::vector<unsigned>& topology);
+
+    /**
+     * @param activations Transfer function of every layer, the input
+     *                    one first (it is ignored)
+     */
+    BasicNet(const std::vector<unsigned>& topology,
+             const std::vector<Activation>& activations);
+
+    /**
+     * @brief Same as above, with reproducible initial weights
+     *
+     * @details Unlike the other constructors, it does not touch the
+     *          global @c rand() state, so nets can be built from
+     *          several threads at once
      */
-    Net(const std::vector<unsigned>& topology);
+    BasicNet(const std::vector<unsigned>& topology,
+             const std::vector<Activation>& activations,
+             const Initializer& initializer);
 
     /**
      */
-    ~Net(void);
+    ~BasicNet(void);
 
 
     // OPERATIONS
     /**
      */
-    void FeedForward(const std::vector<double>& input_values);
+    void FeedForward(const std::vector<T>& input_values);
 
     /**
      *
      * @note It uses root mean square error (@e rms), where
      *   @f\$rms=\sqrt{\frac{1}{n}\sum_i{\left(target_i-actual_i\right)^2}}@f\$
      */
-    void BackPropagation(const std::vector<double>& target_values);
+    void BackPropagation(const std::vector<T>& target_values);
+
+    /**
+     */
+    void Results(std::vector<T>& result_values) const;
+
+    /**
+     * @brief Mini-batch training
+     *
+     * @details Samples are stored back to back: @e input_values holds
+     *          one row of input values per sample and @e target_values
+     *          one row of target values per sample.  They are trained
+     *          in batches of @e batch_size samples (the last one may be
+     *          shorter), with a single weight update per batch along
+     *          the gradient averaged over its samples.
+     */
+    void TrainBatch(const std::vector<T>& input_values,
+                    const std::vector<T>& target_values,
+                    unsigned batch_size);
 
     /**
+     * @brief Forward and backward pass of a batch, without touching
+     *        the weights
+     *
+     * @details Whatever @e workspace held is replaced by the weight
+     *          gradients summed over the batch and the error of each
+     *          sample.  The net is not modified, so several threads may
+     *          call this at once, each one with its own workspace.
      */
-    void Results(std::vector<double>& result_values) const;
+    void CalcGradients(const T* input_values,
+                       const T* target_values,
+                       unsigned batch_size,
+                       BasicWorkspace<T>& workspace) const;
+
+    /**
+     * @brief Single weight update along the gradients gathered in a
+     *        workspace, averaged over its number of samples
+     */
+    void ApplyGradients(const BasicWorkspace<T>& workspace);
+
+    /**
+     * @brief Online training step that is safe to run from several
+     *        threads at once (asynchronous, lock-free SGD)
+     *
+     * @details Every thread needs its own workspace, with room for at
+     *          least one sample.  Weights are read and updated in place
+     *          with relaxed atomic accesses, so concurrent updates may
+     *          be lost but never torn; so is the state of the selected
+     *          optimizer.  The error of the sample is appended to the
+     *          workspace; use RecordErrors() once the threads are done.
+     *          No other operation may run on the net meanwhile.
+     */
+    void TrainShared(const T* input_values,
+                     const T* target_values,
+                     BasicWorkspace<T>& workspace);
+
+    /**
+     * @brief Fold the errors gathered in a workspace into the recent
+     *        average error, without touching the weights
+     */
+    void RecordErrors(const BasicWorkspace<T>& workspace);
+
+    /**
+     * @brief Write topology and weights to a binary model file
+     *
+     * @return Whether the file could be written
+     *
+     * @see ModelFile
+     */
+    bool Save(const std::string& filename) const;
+
+    /**
+     * @brief Replace topology, transfer functions and weights with
+     *        those of a binary model file; momentum and errors start
+     *        from scratch
+     *
+     * @return Whether the file could be read; if not, the net is left
+     *         untouched
+     */
+    bool Load(const std::string& filename);
 
 
     // ACCESSORS AND MUTATORS
+    /**
+     */
+    const std::vector<unsigned>& Topology(void) const;
+
+    /**
+     * @brief Every layer, the input one first
+     */
+    const std::vector<BasicLayer<T> >& Layers(void) const;
+
+    /**
+     * @brief Transfer function of every layer, the input one first
+     */
+    std::vector<Activation> Activations(void) const;
+
+    /**
+     * @brief Learning rate of every layer; 0.15 unless set
+     */
+    double LearningRate(void) const;
+
+    /**
+     * @brief Set the learning rate of this net only
+     */
+    void LearningRate(double eta);
+
+    /**
+     * @brief Momentum of every layer; 0.5 unless set
+     */
+    double Momentum(void) const;
+
+    /**
+     * @brief Set the momentum of this net only
+     */
+    void Momentum(double alpha);
+
+    /**
+     * @brief Weight update rule of every layer; momentum unless set
+     */
+    Optimizer OptimizerKind(void) const;
+
+    /**
+     * @brief Switch the update rule of every layer, from a blank state
+     */
+    void OptimizerKind(Optimizer kind);
+
+    /**
+     * @brief RMS error of the last sample trained on
+     */
+    double Error(void) const;
+
     /**
      */
     double RecentAvgError(void) const;
 
 
   private:
-    typedef std::vector<Neuron> Layer;
+    /**
+     */
+    void Build(const std::vector<Activation>& activations,
+               const Initializer* initializer = 0);
 
-    std::vector<Layer> layers_; ///< ?
-    double error_;              ///< ?
-    double recent_avg_error_;   ///< ?
+    /**
+     */
+    void LatchInputs(const T* input_values, unsigned batch_size,
+                     BasicWorkspace<T>& workspace) const;
+
+    /**
+     * @brief Append the RMS error of every sample to the workspace
+     */
+    void CalcErrors(const T* target_values, unsigned batch_size,
+                    BasicWorkspace<T>& workspace) const;
+
+    std::vector<unsigned> topology_;
+    std::vector<BasicLayer<T> > layers_;  ///< ?
+    BasicWorkspace<T> workspace_;         ///< Used by TrainBatch()
+    double error_;                        ///< ?
+    double recent_avg_error_;             ///< ?
     static double recent_avg_smoothing_factor_; /**< Number of training
                                                      samples to avg. over */
 };
 
 
 // INLINE METHODS
+template <typename T>
+inline const std::vector<unsigned>&
+BasicNet<T>::Topology(void) const
+{
+    return topology_;
+}
+
+
+template <typename T>
 inline double
-Net::RecentAvgError(void) const
+BasicNet<T>::Error(void) const
+{
+    return error_;
+}
+
+
+template <typename T>
+inline double
+BasicNet<T>::RecentAvgError(void) const
 {
     return recent_avg_error_;
 }
 
 
+template <typename T>
+inline const std::vector<BasicLayer<T> >&
+BasicNet<T>::Layers(void) const
+{
+    return layers_;
+}
+
+
+/**
+ */
+typedef BasicNet<double> Net;
+
+
 } // ! namespace MinAnn
 
 
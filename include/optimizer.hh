@@ -0,0 +1,212 @@
+/**
+ * @file optimizer.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#ifndef OPTIMIZER_HH
+#define OPTIMIZER_HH
+
+#include <cstddef>
+#include <vector>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Weight update rules a layer may follow
+ */
+enum Optimizer {
+    kMomentum = 0,  ///< Gradient descent with momentum, the default
+    kNesterov,      ///< Nesterov accelerated gradient
+    kRmsProp,
+    kAdam,
+    kNumOptimizers
+};
+
+
+/**
+ * @brief Update rule of a layer, with its per-weight state
+ *
+ * @details The state lives in buffers laid out as the weights, one or
+ *          two values per weight, and every update is a single fused
+ *          pass over weights and state by one of the @c Kernels.  The
+ *          learning rate and the momentum are set per optimizer; the
+ *          momentum is @f$\alpha@f$ of momentum and Nesterov and is
+ *          ignored by RMSProp and Adam, which decay their averages by
+ *          the usual constants below.  Adaptive rules want a much
+ *          smaller learning rate, around 0.001 to 0.01.
+ *
+ *          Values are of type @e T, either @c float or @c double.
+ */
+template <typename T>
+class BasicOptimizer {
+  public:
+    static const double kRho;       ///< RMSProp decay
+    static const double kBeta1;     ///< Adam decay of the mean
+    static const double kBeta2;     ///< Adam decay of the square
+    static const double kEpsilon;   ///< Keeps divisions finite
+
+
+    // LIFE CYCLE
+    /**
+     */
+    BasicOptimizer(Optimizer kind, std::size_t num_weights, double eta,
+                   double alpha);
+
+
+    // OPERATIONS
+    /**
+     * @brief Move @e rows x @e cols weights along @f$x_i g_j@f$
+     *
+     * @details As Kernels::MomentumUpdate(); @e w must be the weights
+     *          this optimizer was built for, or a prefix of them.
+     */
+    void Update(T* w, const T* x, const T* g, unsigned rows,
+                unsigned cols);
+
+    /**
+     * @brief Same as Update(), safe to run from several threads at
+     *        once (asynchronous, lock-free SGD)
+     *
+     * @details Weights and state are read and written a row at a time
+     *          with relaxed atomic accesses, and the row is moved by the
+     *          same kernel as Update() in between, so concurrent updates
+     *          may be lost but never torn.  Adam's step count is shared
+     *          by the threads.
+     */
+    void UpdateShared(T* w, const T* x, const T* g, unsigned rows,
+                      unsigned cols);
+
+    /**
+     * @brief Forget the state, e.g. when the weights are replaced
+     */
+    void Reset(void);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    Optimizer Kind(void) const;
+
+    /**
+     * @brief Switch to another rule, starting from a blank state
+     */
+    void Kind(Optimizer kind);
+
+    /**
+     */
+    double LearningRate(void) const;
+
+    /**
+     */
+    void LearningRate(double eta);
+
+    /**
+     */
+    double Momentum(void) const;
+
+    /**
+     */
+    void Momentum(double alpha);
+
+    /**
+     */
+    static const char* Name(Optimizer kind);
+
+
+  private:
+    Optimizer kind_;
+    double eta_;
+    double alpha_;
+    std::size_t num_weights_;
+    unsigned long steps_;       ///< For Adam's bias correction
+    std::vector<T> first_;      ///< Deltas or means, as the weights
+    std::vector<T> second_;     ///< Mean squares, as the weights
+
+    /**
+     * @brief Allocate the state buffers the rule uses, and no other
+     */
+    void Allocate(void);
+
+    /**
+     * @brief Move the weights by the kernel of the rule, at Adam's
+     *        step @e step
+     */
+    void Step(T* w, T* first, T* second, const T* x, const T* g,
+              unsigned rows, unsigned cols, unsigned long step) const;
+};
+
+
+// INLINE METHODS
+template <typename T>
+inline Optimizer
+BasicOptimizer<T>::Kind(void) const
+{
+    return kind_;
+}
+
+
+template <typename T>
+inline double
+BasicOptimizer<T>::LearningRate(void) const
+{
+    return eta_;
+}
+
+
+template <typename T>
+inline void
+BasicOptimizer<T>::LearningRate(double eta)
+{
+    eta_ = eta;
+}
+
+
+template <typename T>
+inline double
+BasicOptimizer<T>::Momentum(void) const
+{
+    return alpha_;
+}
+
+
+template <typename T>
+inline void
+BasicOptimizer<T>::Momentum(double alpha)
+{
+    alpha_ = alpha;
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! OPTIMIZER_HH
@@ -1,5 +1,5 @@
 /**
- * @file connection.hh
+ * @file parallel_trainer.hh
  */
 /*
  * Copyright (c) 2019, J. A. Corbal
@@ -30,82 +30,70 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */ 
 
-#ifndef CONNECTION_HH
-#define CONNECTION_HH
+#ifndef PARALLEL_TRAINER_HH
+#define PARALLEL_TRAINER_HH
 
-#include <cstdlib> // Randomizing related functions
+#include <vector>
+
+#include <net.hh>
+#include <thread_pool.hh>
+#include <workspace.hh>
 
 
 namespace MinAnn {
 
 /**
+ * @brief Data-parallel mini-batch training of a net
+ *
+ * @details Every batch is split in contiguous shards, one per thread.
+ *          Each thread runs its shard forward and backward on a private
+ *          workspace, then the gradients are summed in thread order and
+ *          applied as a single update.  With a given number of threads,
+ *          training is fully reproducible.
  */
-class Connection {
+class ParallelTrainer {
   public:
     // LIFE CYCLE
     /**
-     *
-     * @note In this particular case, due the simplicity of this
-     *       constructor, itgoes inline
      */
-    Connection(void) {
-        weight_ = rand() / double(RAND_MAX);
-    }
-
+    ParallelTrainer(Net& net, unsigned num_threads);
 
-    // ACCESSORS AND MUTATORS
     /**
      */
-    void Weight(const double weight);
+    ~ParallelTrainer(void);
 
-    /**
-     */
-    double Weight(void) const;
 
+    // OPERATIONS
     /**
+     * @brief Same as Net::TrainBatch(), spread over the threads
      */
-    void DeltaWeight(const double delta_weight);
+    void Train(const std::vector<double>& input_values,
+               const std::vector<double>& target_values,
+               unsigned batch_size);
+
 
+    // ACCESSORS AND MUTATORS
     /**
      */
-    double DeltaWeight(void) const;
+    unsigned NumThreads(void) const;
 
 
   private:
-    double weight_;
-    double delta_weight_;
+    Net& net_;
+    ThreadPool pool_;
+    std::vector<Workspace> workspaces_;  ///< One per thread
 };
 
 
 // INLINE METHODS
-inline void
-Connection::Weight(const double weight) {
-    weight_ = weight;
-}
-
-
-inline double
-Connection::Weight(void) const
+inline unsigned
+ParallelTrainer::NumThreads(void) const
 {
-    return weight_;
-}
-
-
-inline void
-Connection::DeltaWeight(const double delta_weight) {
-    delta_weight_ = delta_weight;
-}
-
-
-inline double
-Connection::DeltaWeight(void) const
-{
-    return delta_weight_;
+    return pool_.Size();
 }
 
 
 } // ! namespace MinAnn
 
 
-#endif // ! CONNECTION_HH
-
+#endif // ! PARALLEL_TRAINER_HH
@@ -0,0 +1,162 @@
+/**
+ * @file profiler.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#ifndef PROFILER_HH
+#define PROFILER_HH
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Hot-path counters and per-layer timers
+ *
+ * @details Instrumentation is compiled in with @c MINANN_PROFILE only
+ *          (`make PROFILE=1`); otherwise every @c MINANN_PROFILE_*
+ *          macro expands to nothing and the hot paths are untouched.
+ *          Each thread records into its own log, so timers never
+ *          contend; the logs are merged when a report is written,
+ *          which must happen once the training threads are idle.
+ *          Besides the totals, the first @c kMaxEvents timed sections
+ *          of every thread are kept for the trace.
+ */
+class Profiler {
+  public:
+    /**
+     * @brief Timed sections
+     */
+    enum Section {
+        kForward = 0,   ///< Feed forward of one layer
+        kBackward,      ///< Gradients of one layer
+        kUpdate,        ///< Weight update of one layer
+        kParse,         ///< One line of training data
+        kNumSections
+    };
+
+    /**
+     * @brief Event counters
+     */
+    enum Counter {
+        kSamples = 0,   ///< Samples trained on
+        kBytesParsed,   ///< Bytes of training data consumed
+        kAllocations,   ///< Calls to the global operator new
+        kNumCounters
+    };
+
+    static const unsigned kMaxLayers = 64;          ///< Deeper are merged
+    static const unsigned kMaxEvents = 1u << 18;    ///< Per thread
+
+    /**
+     * @brief Times its own lifetime as a section of a layer
+     */
+    class Scope {
+      public:
+        /**
+         */
+        Scope(Section section, unsigned layer);
+
+        /**
+         */
+        ~Scope(void);
+
+      private:
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+
+        Section section_;
+        unsigned layer_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+
+    // OPERATIONS
+    /**
+     * @brief Add @e n to a counter
+     */
+    static void Count(Counter counter, unsigned long n);
+
+    /**
+     * @brief Forget everything recorded so far and restart the clock
+     */
+    static void Reset(void);
+
+    /**
+     * @brief Print per-layer times and rates as a table
+     */
+    static void PrintSummary(std::FILE* file);
+
+    /**
+     * @brief Write the recorded sections as Chrome trace events
+     *
+     * @details The file loads in @c chrome://tracing or Perfetto.
+     *
+     * @return @c false if the file could not be written
+     */
+    static bool WriteTrace(const std::string& filename);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     * @brief Whether the library was built with @c MINANN_PROFILE
+     */
+    static bool Enabled(void);
+
+    /**
+     */
+    static unsigned long Total(Counter counter);
+
+    /**
+     */
+    static const char* Name(Section section);
+};
+
+
+} // ! namespace MinAnn
+
+
+#ifdef MINANN_PROFILE
+#  define MINANN_PROFILE_SCOPE(section, layer) \
+    ::MinAnn::Profiler::Scope minann_profile_scope_( \
+            ::MinAnn::Profiler::section, layer)
+#  define MINANN_PROFILE_COUNT(counter, n) \
+    ::MinAnn::Profiler::Count(::MinAnn::Profiler::counter, n)
+#else
+#  define MINANN_PROFILE_SCOPE(section, layer) ((void) 0)
+#  define MINANN_PROFILE_COUNT(counter, n) ((void) 0)
+#endif
+
+
+#endif // ! PROFILER_HH
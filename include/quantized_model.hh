@@ -0,0 +1,195 @@
+/**
+ * @file quantized_model.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#ifndef QUANTIZED_MODEL_HH
+#define QUANTIZED_MODEL_HH
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+#include <activation.hh>
+#include <net.hh>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Trained net quantized to 8 bit integers, for inference only
+ *
+ * @details Post-training quantization: the weights of every layer are
+ *          stored as int8 with a single scale per layer, and the inputs
+ *          of every layer are quantized with a scale calibrated on a
+ *          sample of inputs run through the original net.  Products
+ *          are accumulated in 32 bits; biases are kept as int32 in the
+ *          scale of those sums, then each neuron is scaled back and
+ *          goes through the transfer function of its layer as usual.
+ *
+ *          Like InferenceModel, the model is never written after
+ *          construction, so any number of threads may share it.
+ */
+class QuantizedModel {
+  public:
+    /**
+     * @brief Per-thread scratch space for predictions
+     */
+    class Context {
+      public:
+        /**
+         */
+        explicit Context(const QuantizedModel& model);
+
+      private:
+        friend class QuantizedModel;
+
+        std::vector<int8_t> values_;
+        std::vector<int32_t> sums_;
+        std::vector<double> outputs_;
+    };
+
+
+    // LIFE CYCLE
+    /**
+     * @brief Quantize the current weights of a net
+     *
+     * @param input_values Calibration samples, @e rows rows of
+     *                     NumInputs() values, usually a share of the
+     *                     training inputs
+     */
+    QuantizedModel(const Net& net, const double* input_values,
+                   std::size_t rows);
+
+    /**
+     */
+    ~QuantizedModel(void);
+
+
+    // OPERATIONS
+    /**
+     * @brief Outputs of the net for one sample
+     *
+     * @param input_values  NumInputs() values
+     * @param result_values Room for NumOutputs() values
+     * @param context       Scratch space owned by the calling thread
+     */
+    void Predict(const double* input_values, double* result_values,
+                 Context& context) const;
+
+    /**
+     * @brief Same as above, with a context private to the calling
+     *        thread that only allocates the first time it is used
+     */
+    void Predict(const double* input_values, double* result_values) const;
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    const std::vector<unsigned>& Topology(void) const;
+
+    /**
+     */
+    unsigned NumInputs(void) const;
+
+    /**
+     */
+    unsigned NumOutputs(void) const;
+
+    /**
+     * @brief Bytes taken by weights, biases and scales
+     */
+    std::size_t MemorySize(void) const;
+
+
+  private:
+    std::vector<unsigned> topology_;
+    std::vector<ActivationFunction> activations_;
+    std::vector<std::size_t> offsets_;  ///< Per layer, into weights_
+    std::vector<int8_t> weights_;       ///< Without the bias column
+    std::vector<std::size_t> bias_offsets_;  ///< Per layer, into biases_
+    std::vector<int32_t> biases_;       ///< In the scale of the sums
+    std::vector<double> input_scales_;  ///< Per layer, of its inputs
+    std::vector<double> sum_scales_;    ///< Per layer, of its sums
+    unsigned max_width_;                ///< Widest layer
+
+    QuantizedModel(const QuantizedModel&);
+    QuantizedModel& operator=(const QuantizedModel&);
+
+    /**
+     * @brief Largest magnitude reached by the inputs of every layer
+     *        over the calibration samples
+     */
+    static void Calibrate(const Net& net, const double* input_values,
+                          std::size_t rows, std::vector<double>& ranges);
+
+    /**
+     * @brief Round to the nearest integer in [-127, 127]
+     */
+    static int8_t Quantize(double x, double scale);
+
+    /**
+     * @param values  Room for the widest layer
+     * @param sums    Room for the widest layer
+     * @param outputs Room for the widest layer
+     */
+    void Forward(const double* input_values, double* result_values,
+                 int8_t* values, int32_t* sums, double* outputs) const;
+};
+
+
+// INLINE METHODS
+inline const std::vector<unsigned>&
+QuantizedModel::Topology(void) const
+{
+    return topology_;
+}
+
+
+inline unsigned
+QuantizedModel::NumInputs(void) const
+{
+    return topology_.front();
+}
+
+
+inline unsigned
+QuantizedModel::NumOutputs(void) const
+{
+    return topology_.back();
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! QUANTIZED_MODEL_HH
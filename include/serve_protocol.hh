@@ -0,0 +1,168 @@
+/**
+ * @file serve_protocol.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+
+#ifndef SERVE_PROTOCOL_HH
+#define SERVE_PROTOCOL_HH
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Wire format of the inference server, and the local sockets
+ *        it is spoken over
+ *
+ * @details Every request is a RequestHeader, followed for kPredict by
+ *          @e rows rows of NumInputs() doubles.  Every response is a
+ *          ResponseHeader followed by @e size bytes: @e rows rows of
+ *          NumOutputs() doubles, a ModelInfo or a ServerStats.  Both
+ *          ends share the host, so values travel in its byte order.
+ *
+ *          An address is either the path of a Unix domain socket, or
+ *          "host:port" for TCP, where host is 127.0.0.1 or localhost:
+ *          the server is never reachable from another machine.
+ */
+class ServeProtocol {
+  public:
+    /**
+     */
+    enum Op {
+        kPredict = 1,
+        kInfo,
+        kStats
+    };
+
+    /**
+     * @brief A connection is closed after any status but kOk
+     */
+    enum Status {
+        kOk = 0,
+        kBadRequest
+    };
+
+    static const uint32_t kMagic = 0x314e4e4d;   ///< "MNN1"
+    static const uint32_t kMaxRows = 1 << 16;    ///< Per request
+
+    /**
+     */
+    struct RequestHeader {
+        uint32_t magic;
+        uint16_t op;
+        uint16_t reserved;
+        uint32_t rows;          ///< Of inputs following, for kPredict
+    };
+
+    /**
+     */
+    struct ResponseHeader {
+        uint32_t magic;
+        uint16_t status;
+        uint16_t reserved;
+        uint32_t size;          ///< Bytes following
+    };
+
+    /**
+     */
+    struct ModelInfo {
+        uint32_t num_inputs;
+        uint32_t num_outputs;
+    };
+
+    /**
+     * @brief Counters since the server started, and latencies of the
+     *        last kLatencyWindow requests, from the time a request is
+     *        read to the time its outputs are ready
+     */
+    struct ServerStats {
+        uint64_t requests;
+        uint64_t rows;
+        uint64_t batches;
+        uint64_t connections;   ///< Open right now
+        double seconds;         ///< Since the server started
+        double qps;             ///< Requests per second, overall
+        double p50_us;
+        double p99_us;
+    };
+
+    static const unsigned kLatencyWindow = 1 << 14;
+
+
+    // OPERATIONS
+    /**
+     * @brief Listening socket bound to @e address, or -1
+     *
+     * @details A stale Unix socket file left by an earlier server is
+     *          removed first.
+     */
+    static int Listen(const std::string& address);
+
+    /**
+     * @brief Next connection on a listening socket, or -1 once the
+     *        socket is shut down
+     */
+    static int Accept(int listen_fd);
+
+    /**
+     * @brief Socket connected to @e address, or -1
+     */
+    static int Connect(const std::string& address);
+
+    /**
+     * @brief Read exactly @e size bytes, false on error or end of file
+     */
+    static bool ReadFully(int fd, void* data, std::size_t size);
+
+    /**
+     * @brief Write exactly @e size bytes, false on error
+     */
+    static bool WriteFully(int fd, const void* data, std::size_t size);
+
+    /**
+     * @brief Whether @e address names a Unix domain socket
+     */
+    static bool IsUnixAddress(const std::string& address);
+
+
+  private:
+    ServeProtocol(void);
+};
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! SERVE_PROTOCOL_HH
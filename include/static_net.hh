@@ -0,0 +1,418 @@
+/**
+ * @file static_net.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#ifndef STATIC_NET_HH
+#define STATIC_NET_HH
+
+#include <array>
+#include <cmath>
+#include <cstdlib> // Randomizing related functions
+#include <type_traits>
+
+#include <kernels.hh>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Sizes and buffer offsets of a topology known at compile time
+ */
+template <unsigned... Sizes>
+struct StaticTopology {
+    /**
+     */
+    static constexpr unsigned NumLayers(void)
+    {
+        return sizeof...(Sizes);
+    }
+
+    /**
+     * @brief Neurons of layer @e l, not counting the bias
+     */
+    static constexpr unsigned Size(unsigned l)
+    {
+        return Get(l, Sizes...);
+    }
+
+    /**
+     * @brief Input weights of layer @e l, bias included
+     */
+    static constexpr unsigned NumWeights(unsigned l)
+    {
+        return l == 0 ? 0 : Size(l) * (Size(l - 1) + 1);
+    }
+
+    /**
+     * @brief Start of the weights of layer @e l, one block per layer
+     */
+    static constexpr unsigned WeightOffset(unsigned l)
+    {
+        return l <= 1 ? 0 : WeightOffset(l - 1) + NumWeights(l - 1);
+    }
+
+    /**
+     * @brief Start of the outputs of layer @e l, bias included
+     */
+    static constexpr unsigned OutputOffset(unsigned l)
+    {
+        return l == 0 ? 0 : OutputOffset(l - 1) + Size(l - 1) + 1;
+    }
+
+  private:
+    static constexpr unsigned Get(unsigned)
+    {
+        return 0;
+    }
+
+    template <typename... Rest>
+    static constexpr unsigned Get(unsigned l, unsigned first, Rest... rest)
+    {
+        return l == 0 ? first : Get(l - 1, rest...);
+    }
+};
+
+
+/**
+ * @brief Feed-forward net whose topology is fixed at compile time
+ *
+ * @details Meant for tiny nets, where the indirections of @c Net cost
+ *          more than the arithmetic.  Every weight, output and gradient
+ *          lives in a @c std::array inside the object, so neither
+ *          training nor inference allocates memory, and every loop has
+ *          a constant trip count the compiler can unroll.  Layers are
+ *          walked by template recursion.
+ *
+ *          It computes exactly what a @c Net of the same topology does
+ *          (tanh in every layer, same learning rate and momentum, same
+ *          random initial weights), so both give the same outputs up to
+ *          the rounding of the SIMD kernels.  Values are of type @e T,
+ *          either @c float or @c double; @c StaticNet is the double
+ *          precision net.
+ */
+template <typename T, unsigned... Sizes>
+class BasicStaticNet {
+    typedef StaticTopology<Sizes...> Topology;
+
+    static_assert(Topology::NumLayers() >= 2,
+                  "A net needs at least an input and an output layer");
+
+  public:
+    static const unsigned kNumLayers = Topology::NumLayers();
+    static const unsigned kNumInputs = Topology::Size(0);
+    static const unsigned kNumOutputs = Topology::Size(kNumLayers - 1);
+
+
+    // LIFE CYCLE
+    /**
+     */
+    BasicStaticNet(void);
+
+
+    // OPERATIONS
+    /**
+     * @param input_values kNumInputs values
+     */
+    void FeedForward(const T* input_values);
+
+    /**
+     * @param target_values kNumOutputs values
+     *
+     * @note It uses root mean square error, as Net::BackPropagation()
+     */
+    void BackPropagation(const T* target_values);
+
+    /**
+     * @param result_values Room for kNumOutputs values
+     */
+    void Results(T* result_values) const;
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    double RecentAvgError(void) const;
+
+
+  private:
+    typedef std::integral_constant<unsigned, 0> First;
+    typedef std::integral_constant<unsigned, kNumLayers> End;
+
+    static constexpr double kEta = 0.15f;   ///< As Layer
+    static constexpr double kAlpha = 0.5f;  ///< As Layer
+    static constexpr double kSmoothingFactor = 100.0f;  ///< As Net
+
+    std::array<T, Topology::WeightOffset(kNumLayers)> weights_;
+    std::array<T, Topology::WeightOffset(kNumLayers)> delta_weights_;
+    std::array<T, Topology::OutputOffset(kNumLayers)> outputs_;
+    std::array<T, Topology::OutputOffset(kNumLayers)> gradients_;
+    double error_;
+    double recent_avg_error_;
+
+    /**
+     * @brief Random weights of every layer from @e L on
+     */
+    template <unsigned L>
+    void Randomize(std::integral_constant<unsigned, L>);
+    void Randomize(End) {}
+
+    /**
+     * @brief Feed every layer from @e L on
+     */
+    template <unsigned L>
+    void FeedForward(std::integral_constant<unsigned, L>);
+    void FeedForward(End) {}
+
+    /**
+     * @brief Hidden gradients of every layer from @e L down to the
+     *        first hidden one
+     */
+    template <unsigned L>
+    void CalcHiddenGradients(std::integral_constant<unsigned, L>);
+    void CalcHiddenGradients(First) {}
+
+    /**
+     * @brief Update the input weights of every layer from @e L on
+     */
+    template <unsigned L>
+    void UpdateInputWeights(std::integral_constant<unsigned, L>);
+    void UpdateInputWeights(End) {}
+
+    /**
+     */
+    static void Tanh(T* x, unsigned n);
+};
+
+
+// INLINE METHODS
+template <typename T, unsigned... Sizes>
+BasicStaticNet<T, Sizes...>::BasicStaticNet(void)
+    : error_(0.0f),
+      recent_avg_error_(0.0f)
+{
+    delta_weights_.fill(0.0f);
+    outputs_.fill(0.0f);
+    gradients_.fill(0.0f);
+
+    // Every layer's bias neuron outputs 1.0
+    for (unsigned l = 0; l < kNumLayers; ++l) {
+        outputs_[Topology::OutputOffset(l) + Topology::Size(l)] = 1.0f;
+    }
+
+    Randomize(std::integral_constant<unsigned, 1>());
+}
+
+
+template <typename T, unsigned... Sizes>
+inline void
+BasicStaticNet<T, Sizes...>::FeedForward(const T* input_values)
+{
+    for (unsigned i = 0; i < kNumInputs; ++i) {
+        outputs_[i] = input_values[i];
+    }
+
+    FeedForward(std::integral_constant<unsigned, 1>());
+}
+
+
+template <typename T, unsigned... Sizes>
+inline void
+BasicStaticNet<T, Sizes...>::BackPropagation(const T* target_values)
+{
+    const unsigned last = kNumLayers - 1;
+    T* outputs = &outputs_[Topology::OutputOffset(last)];
+    T* gradients = &gradients_[Topology::OutputOffset(last)];
+
+    error_ = 0.0f;
+    for (unsigned n = 0; n < kNumOutputs; ++n) {
+        double delta = target_values[n] - outputs[n];
+        error_ += delta * delta;
+    }
+    error_ = sqrt(error_ / kNumOutputs);
+    recent_avg_error_ =
+        (recent_avg_error_ * kSmoothingFactor + error_) /
+            (kSmoothingFactor + 1.0f);
+
+    for (unsigned n = 0; n < kNumOutputs; ++n) {
+        gradients[n] = target_values[n] - outputs[n];
+        gradients[n] *= 1.0f - outputs[n] * outputs[n];
+    }
+
+    CalcHiddenGradients(std::integral_constant<unsigned, last - 1>());
+    UpdateInputWeights(std::integral_constant<unsigned, 1>());
+}
+
+
+template <typename T, unsigned... Sizes>
+inline void
+BasicStaticNet<T, Sizes...>::Results(T* result_values) const
+{
+    const T* outputs = &outputs_[Topology::OutputOffset(kNumLayers - 1)];
+
+    for (unsigned n = 0; n < kNumOutputs; ++n) {
+        result_values[n] = outputs[n];
+    }
+}
+
+
+template <typename T, unsigned... Sizes>
+inline double
+BasicStaticNet<T, Sizes...>::RecentAvgError(void) const
+{
+    return recent_avg_error_;
+}
+
+
+template <typename T, unsigned... Sizes>
+template <unsigned L>
+void
+BasicStaticNet<T, Sizes...>::Randomize(std::integral_constant<unsigned, L>)
+{
+    const unsigned num_neurons = Topology::Size(L);
+    const unsigned num_inputs = Topology::Size(L - 1) + 1;
+    T* weights = &weights_[Topology::WeightOffset(L)];
+
+    // Input-major, in the same random sequence as Layer
+    for (unsigned i = 0; i < num_inputs; ++i) {
+        for (unsigned j = 0; j < num_neurons; ++j) {
+            weights[j * num_inputs + i] = rand() / double(RAND_MAX);
+        }
+    }
+
+    Randomize(std::integral_constant<unsigned, L + 1>());
+}
+
+
+template <typename T, unsigned... Sizes>
+template <unsigned L>
+inline void
+BasicStaticNet<T, Sizes...>::FeedForward(std::integral_constant<unsigned, L>)
+{
+    const unsigned num_neurons = Topology::Size(L);
+    const unsigned num_inputs = Topology::Size(L - 1) + 1;
+    const T* weights = &weights_[Topology::WeightOffset(L)];
+    const T* inputs = &outputs_[Topology::OutputOffset(L - 1)];
+    T* outputs = &outputs_[Topology::OutputOffset(L)];
+
+    for (unsigned j = 0; j < num_neurons; ++j) {
+        T sum = 0.0f;
+
+        for (unsigned i = 0; i < num_inputs; ++i) {
+            sum += inputs[i] * weights[j * num_inputs + i];
+        }
+        outputs[j] = sum;
+    }
+    Tanh(outputs, num_neurons);
+
+    FeedForward(std::integral_constant<unsigned, L + 1>());
+}
+
+
+template <typename T, unsigned... Sizes>
+template <unsigned L>
+inline void
+BasicStaticNet<T, Sizes...>::CalcHiddenGradients(
+        std::integral_constant<unsigned, L>)
+{
+    const unsigned num_neurons = Topology::Size(L);
+    const unsigned num_next = Topology::Size(L + 1);
+    const T* next_weights = &weights_[Topology::WeightOffset(L + 1)];
+    const T* next_gradients = &gradients_[Topology::OutputOffset(L + 1)];
+    const T* outputs = &outputs_[Topology::OutputOffset(L)];
+    T* gradients = &gradients_[Topology::OutputOffset(L)];
+
+    for (unsigned n = 0; n < num_neurons; ++n) {
+        gradients[n] = 0.0f;
+    }
+    for (unsigned j = 0; j < num_next; ++j) {
+        for (unsigned n = 0; n < num_neurons; ++n) {
+            gradients[n] += next_weights[j * (num_neurons + 1) + n] *
+                            next_gradients[j];
+        }
+    }
+    for (unsigned n = 0; n < num_neurons; ++n) {
+        gradients[n] *= 1.0f - outputs[n] * outputs[n];
+    }
+    gradients[num_neurons] = 0.0f;
+
+    CalcHiddenGradients(std::integral_constant<unsigned, L - 1>());
+}
+
+
+template <typename T, unsigned... Sizes>
+template <unsigned L>
+inline void
+BasicStaticNet<T, Sizes...>::UpdateInputWeights(
+        std::integral_constant<unsigned, L>)
+{
+    const unsigned num_neurons = Topology::Size(L);
+    const unsigned num_inputs = Topology::Size(L - 1) + 1;
+    const T* inputs = &outputs_[Topology::OutputOffset(L - 1)];
+    const T* gradients = &gradients_[Topology::OutputOffset(L)];
+    T* weights = &weights_[Topology::WeightOffset(L)];
+    T* delta_weights = &delta_weights_[Topology::WeightOffset(L)];
+
+    for (unsigned j = 0; j < num_neurons; ++j) {
+        T eta_gradient = (T) kEta * gradients[j];
+
+        for (unsigned i = 0; i < num_inputs; ++i) {
+            unsigned k = j * num_inputs + i;
+
+            delta_weights[k] = eta_gradient * inputs[i] +
+                               (T) kAlpha * delta_weights[k];
+            weights[k] += delta_weights[k];
+        }
+    }
+
+    UpdateInputWeights(std::integral_constant<unsigned, L + 1>());
+}
+
+
+template <typename T, unsigned... Sizes>
+inline void
+BasicStaticNet<T, Sizes...>::Tanh(T* x, unsigned n)
+{
+    // Same implementation as the layers of Net, exact or fast
+    Kernels::Tanh(x, n);
+}
+
+
+/**
+ */
+template <unsigned... Sizes>
+using StaticNet = BasicStaticNet<double, Sizes...>;
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! STATIC_NET_HH
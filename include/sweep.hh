@@ -0,0 +1,150 @@
+/**
+ * @file sweep.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#ifndef SWEEP_HH
+#define SWEEP_HH
+
+#include <cstdio>
+#include <stdint.h>
+#include <vector>
+
+#include <data_set.hh>
+#include <epoch_trainer.hh>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Train many nets at once, to compare hyperparameters
+ *
+ * @details Every configuration (hidden layers, learning rate and
+ *          momentum) is trained by its own @c EpochTrainer, on a
+ *          thread of a pool, all of them reading the same data sets.
+ *          Weights are drawn by an @c Initializer from a single seed,
+ *          so a sweep gives the same results whatever the number of
+ *          threads.  Results are ranked by error, then by time.
+ */
+class Sweep {
+  public:
+    /**
+     */
+    struct Config {
+        std::vector<unsigned> topology;     ///< Inputs and outputs included
+        double eta;
+        double alpha;
+    };
+
+    /**
+     */
+    struct Result {
+        Config config;
+        double error;       ///< Best validation error, or training error
+        unsigned epochs;
+        double seconds;     ///< Spent training, on its own thread
+    };
+
+
+    // LIFE CYCLE
+    /**
+     * @details Nets are ranked by their mean RMS error over the
+     *          training set once trained
+     */
+    Sweep(const DataSet& training_set,
+          const EpochTrainer::Options& options);
+
+    /**
+     * @details Nets are ranked by their best error over the validation
+     *          set
+     */
+    Sweep(const DataSet& training_set, const DataSet& validation_set,
+          const EpochTrainer::Options& options);
+
+
+    // OPERATIONS
+    /**
+     * @param hidden Sizes of the hidden layers; inputs and outputs are
+     *               those of the data set
+     */
+    void Add(const std::vector<unsigned>& hidden, double eta,
+             double alpha);
+
+    /**
+     * @brief Add every combination of hidden layers, learning rate and
+     *        momentum
+     */
+    void AddGrid(const std::vector<std::vector<unsigned> >& hidden,
+                 const std::vector<double>& etas,
+                 const std::vector<double>& alphas);
+
+    /**
+     * @brief Train every configuration, the best one first
+     */
+    std::vector<Result> Run(unsigned num_threads, uint64_t seed) const;
+
+    /**
+     * @brief Print results as a table, in their order
+     */
+    static void Print(const std::vector<Result>& results,
+                      std::FILE* file);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    const std::vector<Config>& Configs(void) const;
+
+
+  private:
+    const DataSet& training_set_;
+    const DataSet* validation_set_;
+    EpochTrainer::Options options_;
+    std::vector<Config> configs_;
+
+    /**
+     */
+    Result Train(const Config& config, uint64_t seed) const;
+};
+
+
+// INLINE METHODS
+inline const std::vector<Sweep::Config>&
+Sweep::Configs(void) const
+{
+    return configs_;
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! SWEEP_HH
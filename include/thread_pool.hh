@@ -0,0 +1,112 @@
+/**
+ * @file thread_pool.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#ifndef THREAD_POOL_HH
+#define THREAD_POOL_HH
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace MinAnn {
+
+/**
+ * @brief Fixed set of threads running the same task in lockstep
+ *
+ * @details Run() hands the task to every thread, each one receiving
+ *          its own index, and returns once all of them are done.  The
+ *          calling thread works as thread zero, so a pool of one thread
+ *          spawns nothing.
+ */
+class ThreadPool {
+  public:
+    typedef std::function<void(unsigned)> Task;
+
+
+    // LIFE CYCLE
+    /**
+     */
+    explicit ThreadPool(unsigned num_threads);
+
+    /**
+     */
+    ~ThreadPool(void);
+
+
+    // OPERATIONS
+    /**
+     * @brief Run @c task(i) on every thread @e i and wait for all
+     */
+    void Run(const Task& task);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     * @brief Number of threads, the calling one included
+     */
+    unsigned Size(void) const;
+
+
+  private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const Task* task_;
+    unsigned long generation_;
+    unsigned pending_;
+    bool stop_;
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    /**
+     */
+    void Work(unsigned index);
+};
+
+
+// INLINE METHODS
+inline unsigned
+ThreadPool::Size(void) const
+{
+    return workers_.size() + 1;
+}
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! THREAD_POOL_HH
@@ -30,9 +30,10 @@
 #ifndef TRAINING_DATA_HH
 #define TRAINING_DATA_HH
 
+#include <cstddef>
+#include <cstdio>
+#include <string>
 #include <vector>
-#include <fstream>
-#include <sstream>
 
 
 /* Read training data from a file
@@ -42,89 +43,86 @@ class TrainingData
   public:
     /**
      */
-    TrainingData(const std::string filename)
-    {
-        training_data_file_.open(filename.c_str());
-    }
+    TrainingData(const std::string filename);
 
     /**
      */
-    bool IsEof(void)
-    {
-        return training_data_file_.eof();
-    }
+    ~TrainingData(void);
 
     /**
+     * @brief Whether the file could be opened
      */
-    void Topology(std::vector<unsigned>& topology)
-    {
-        std::string line;
-        std::string label;
-
-        getline(training_data_file_, line);
-        std::stringstream ss(line);
-        ss >> label;
-        if (this->IsEof() || label.compare("Topology:") != 0 ) {
-            abort();
-        }
-
-        while (!ss.eof()) {
-            unsigned n;
-            ss >> n;
-            topology.push_back(n);
-        }
-    }
+    bool IsOpen(void) const;
 
     /**
-     * @brief Returns the number of input values read from a a file
      */
-    unsigned NextInputs(std::vector<double>& input_values)
-    {
-        input_values.clear();
-
-        std::string line;
-        getline(training_data_file_, line);
-        std::stringstream ss(line);
-
-        std::string label;
-        ss >> label;
-        if (label.compare("i:") == 0) {
-            double value;
-            while (ss >> value) {
-                input_values.push_back(value);
-            }
-        }
-
-        return input_values.size();
-    }
+    bool IsEof(void);
 
     /**
      */
-    unsigned TargetOutputs(std::vector<double>& target_output_values)
-    {
-        target_output_values.clear();
+    void Topology(std::vector<unsigned>& topology);
 
-        std::string line;
-        getline(training_data_file_, line);
-        std::stringstream ss(line);
+    /**
+     * @brief Returns the number of input values read from a a file
+     */
+    unsigned NextInputs(std::vector<double>& input_values);
 
-        std::string label;
-        ss >> label;
-        if (label.compare("o:") == 0) {
-            double value;
-            while (ss >> value) {
-                target_output_values.push_back(value);
-            }
-        }
+    /**
+     */
+    unsigned TargetOutputs(std::vector<double>& target_output_values);
 
-        return target_output_values.size();
-    }
+    /**
+     * @brief Bytes consumed from the file so far
+     */
+    unsigned long BytesRead(void) const;
 
 
   private:
-    std::ifstream training_data_file_;
+    /**
+     * @brief Size of the read buffer; lines are parsed in place
+     */
+    static const std::size_t kBufferSize = 1 << 20;
+
+    std::FILE* training_data_file_;
+    std::vector<char> buffer_;
+    std::size_t begin_;             ///< First unparsed byte in buffer_
+    std::size_t end_;               ///< One past the last valid byte
+    bool file_eof_;
+    unsigned long bytes_read_;
+
+    TrainingData(const TrainingData&);
+    TrainingData& operator=(const TrainingData&);
+
+    /**
+     * @brief Next line, without its end of line, valid until the next
+     *        call; returns false at end of file
+     */
+    bool NextLine(const char*& line, const char*& line_end);
+
+    /**
+     * @brief Read the values of the next line if its label matches
+     */
+    unsigned NextValues(const char* label, std::vector<double>& values);
+
+    /**
+     */
+    void Fill(void);
 };
 
 
-#endif // ! TRAINING_DATA_HH
+// INLINE METHODS
+inline bool
+TrainingData::IsOpen(void) const
+{
+    return training_data_file_ != 0;
+}
 
+
+inline unsigned long
+TrainingData::BytesRead(void) const
+{
+    return bytes_read_;
+}
+
+
+#endif // ! TRAINING_DATA_HH
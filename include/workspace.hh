@@ -0,0 +1,145 @@
+/**
+ * @file workspace.hh
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#ifndef WORKSPACE_HH
+#define WORKSPACE_HH
+
+#include <vector>
+
+
+namespace MinAnn {
+
+template <typename T> class BasicNet;
+
+
+/**
+ * @brief Scratch buffers for training a net on a batch of samples
+ *
+ * @details Holds, for every layer, the outputs and gradients of all
+ *          the samples of a batch (one row per sample, bias column
+ *          included) and the weight gradients summed over the batch.
+ *          A workspace is only written by the thread that owns it, so
+ *          several of them can compute gradients for the same net at
+ *          once.
+ */
+template <typename T>
+class BasicWorkspace {
+  public:
+    // LIFE CYCLE
+    /**
+     * @param topology Neurons per layer, as given to the net
+     * @param capacity Maximum number of samples per batch
+     */
+    BasicWorkspace(const std::vector<unsigned>& topology,
+                   unsigned capacity);
+
+    /**
+     */
+    ~BasicWorkspace(void);
+
+
+    // OPERATIONS
+    /**
+     * @brief Forget the gradients and errors of previous batches
+     */
+    void Clear(void);
+
+    /**
+     * @brief Add the weight gradients and errors of another workspace
+     *        built for the same topology
+     */
+    void Accumulate(const BasicWorkspace& other);
+
+
+    // ACCESSORS AND MUTATORS
+    /**
+     */
+    unsigned Capacity(void) const;
+
+    /**
+     * @brief Number of samples whose gradients have been summed
+     */
+    unsigned NumSamples(void) const;
+
+    /**
+     * @brief RMS error of every sample, in order
+     */
+    const std::vector<double>& Errors(void) const;
+
+
+  private:
+    friend class BasicNet<T>;
+
+    unsigned capacity_;
+    unsigned num_samples_;
+    std::vector<std::vector<T> > outputs_;          ///< Per layer
+    std::vector<std::vector<T> > gradients_;        ///< Per layer
+    std::vector<std::vector<T> > weight_gradients_; ///< Per layer
+    std::vector<T> scratch_;
+    std::vector<double> errors_;
+};
+
+
+// INLINE METHODS
+template <typename T>
+inline unsigned
+BasicWorkspace<T>::Capacity(void) const
+{
+    return capacity_;
+}
+
+
+template <typename T>
+inline unsigned
+BasicWorkspace<T>::NumSamples(void) const
+{
+    return num_samples_;
+}
+
+
+template <typename T>
+inline const std::vector<double>&
+BasicWorkspace<T>::Errors(void) const
+{
+    return errors_;
+}
+
+
+/**
+ */
+typedef BasicWorkspace<double> Workspace;
+
+
+} // ! namespace MinAnn
+
+
+#endif // ! WORKSPACE_HH
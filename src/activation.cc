@@ -0,0 +1,253 @@
+/**
+ * @file activation.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#include <algorithm>
+#include <cmath>
+
+#include <activation.hh>
+#include <kernels.hh>
+
+
+namespace MinAnn {
+
+namespace {
+
+const double kLeakySlope = 0.01f;
+
+
+// FORWARD ------------------------------------------------------------
+template <typename T>
+void
+TanhForward(T* x, unsigned n)
+{
+    Kernels::Tanh(x, n);
+}
+
+
+// σ(x) = (1 + exp(-x))^(-1) = (1 + tanh(x / 2)) / 2
+template <typename T>
+void
+SigmoidForward(T* x, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        x[i] *= 0.5f;
+    }
+    Kernels::Tanh(x, n);
+    for (unsigned i = 0; i < n; ++i) {
+        x[i] = 0.5f * x[i] + 0.5f;
+    }
+}
+
+
+template <typename T>
+void
+ReluForward(T* x, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        x[i] = x[i] > 0 ? x[i] : 0;
+    }
+}
+
+
+template <typename T>
+void
+LeakyReluForward(T* x, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        x[i] = x[i] > 0 ? x[i] : (T) kLeakySlope * x[i];
+    }
+}
+
+
+template <typename T>
+void
+LinearForward(T*, unsigned)
+{
+}
+
+
+template <typename T>
+void
+SoftmaxForward(T* x, unsigned n)
+{
+    if (n == 0) {
+        return;
+    }
+
+    // Shifted by the largest sum, so that no exp() overflows
+    T largest = *std::max_element(x, x + n);
+    T sum = 0.0f;
+
+    for (unsigned i = 0; i < n; ++i) {
+        x[i] = std::exp(x[i] - largest);
+        sum += x[i];
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        x[i] /= sum;
+    }
+}
+
+
+// BACKWARD -----------------------------------------------------------
+// d/dx(tanh(x)) = 1 - tanh(x)^2
+template <typename T>
+void
+TanhBackward(const T* y, T* g, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        g[i] *= 1.0f - y[i] * y[i];
+    }
+}
+
+
+// d/dx(σ(x)) = σ(x) (1 - σ(x))
+template <typename T>
+void
+SigmoidBackward(const T* y, T* g, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        g[i] *= y[i] * (1.0f - y[i]);
+    }
+}
+
+
+template <typename T>
+void
+ReluBackward(const T* y, T* g, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        g[i] = y[i] > 0 ? g[i] : 0;
+    }
+}
+
+
+template <typename T>
+void
+LeakyReluBackward(const T* y, T* g, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        g[i] = y[i] > 0 ? g[i] : (T) kLeakySlope * g[i];
+    }
+}
+
+
+template <typename T>
+void
+LinearBackward(const T*, T*, unsigned)
+{
+}
+
+
+// Product with the Jacobian: g_i = y_i (g_i - sum_k g_k y_k)
+template <typename T>
+void
+SoftmaxBackward(const T* y, T* g, unsigned n)
+{
+    T dot = 0.0f;
+
+    for (unsigned i = 0; i < n; ++i) {
+        dot += g[i] * y[i];
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        g[i] = y[i] * (g[i] - dot);
+    }
+}
+
+} // ! namespace
+
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+template <typename T>
+BasicActivationFunction<T>::BasicActivationFunction(Activation kind)
+    : kind_(kind)
+{
+    switch (kind) {
+      case kSigmoid:
+        forward_ = SigmoidForward<T>;
+        backward_ = SigmoidBackward<T>;
+        break;
+      case kRelu:
+        forward_ = ReluForward<T>;
+        backward_ = ReluBackward<T>;
+        break;
+      case kLeakyRelu:
+        forward_ = LeakyReluForward<T>;
+        backward_ = LeakyReluBackward<T>;
+        break;
+      case kLinear:
+        forward_ = LinearForward<T>;
+        backward_ = LinearBackward<T>;
+        break;
+      case kSoftmax:
+        forward_ = SoftmaxForward<T>;
+        backward_ = SoftmaxBackward<T>;
+        break;
+      default:
+        kind_ = kTanh;
+        forward_ = TanhForward<T>;
+        backward_ = TanhBackward<T>;
+        break;
+    }
+}
+
+
+// ACCESSORS AND MUTATORS ---------------------------------------------
+template <typename T>
+const char*
+BasicActivationFunction<T>::Name(Activation kind)
+{
+    switch (kind) {
+      case kSigmoid:
+        return "sigmoid";
+      case kRelu:
+        return "relu";
+      case kLeakyRelu:
+        return "leaky-relu";
+      case kLinear:
+        return "linear";
+      case kSoftmax:
+        return "softmax";
+      default:
+        return "tanh";
+    }
+}
+
+
+// Single and double precision activation functions
+template class BasicActivationFunction<float>;
+template class BasicActivationFunction<double>;
+
+
+} // ! namespace MinAnn
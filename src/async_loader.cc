@@ -0,0 +1,195 @@
+/**
+ * @file async_loader.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <cassert>
+#include <vector>
+
+#include <async_loader.hh>
+#include <training_data.hh>
+
+
+namespace MinAnn {
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+AsyncLoader::AsyncLoader(TrainingData& training_data, unsigned batch_size,
+                         unsigned depth)
+    : training_data_(training_data),
+      ring_(depth < 2 ? 2 : depth),
+      batch_size_(batch_size),
+      head_(0),
+      count_(0),
+      producer_stalls_(0),
+      consumer_stalls_(0),
+      holding_(false),
+      done_(false),
+      stop_(false)
+{
+    assert(batch_size > 0);
+
+    training_data_.Topology(topology_);
+    for (unsigned b = 0; b < ring_.size(); ++b) {
+        ring_[b].inputs.reserve(batch_size * topology_.front());
+        ring_[b].targets.reserve(batch_size * topology_.back());
+        ring_[b].size = 0;
+    }
+
+    loader_ = std::thread(&AsyncLoader::Load, this);
+}
+
+
+AsyncLoader::~AsyncLoader(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    freed_.notify_one();
+
+    loader_.join();
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+const AsyncLoader::Batch*
+AsyncLoader::Next(void)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (holding_) {
+        holding_ = false;
+        head_ = (head_ + 1) % ring_.size();
+        --count_;
+        freed_.notify_one();
+    }
+
+    if (count_ == 0 && !done_) {
+        ++consumer_stalls_;
+        while (count_ == 0 && !done_) {
+            filled_.wait(lock);
+        }
+    }
+    if (count_ == 0) {
+        return 0;
+    }
+
+    holding_ = true;
+    return &ring_[head_];
+}
+
+
+// ACCESSORS AND MUTATORS ---------------------------------------------
+unsigned long
+AsyncLoader::ProducerStalls(void)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return producer_stalls_;
+}
+
+
+unsigned long
+AsyncLoader::ConsumerStalls(void)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return consumer_stalls_;
+}
+
+
+// PRIVATE ============================================================
+
+// OPERATIONS ---------------------------------------------------------
+void
+AsyncLoader::Load(void)
+{
+    for (;;) {
+        Batch* batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!stop_ && count_ == ring_.size()) {
+                ++producer_stalls_;
+                while (!stop_ && count_ == ring_.size()) {
+                    freed_.wait(lock);
+                }
+            }
+            if (stop_) {
+                return;
+            }
+            batch = &ring_[(head_ + count_) % ring_.size()];
+        }
+
+        // The slot belongs to this thread until it is counted as filled
+        unsigned size = Fill(*batch);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (size > 0) {
+            ++count_;
+        }
+        if (size < batch_size_) {
+            done_ = true;
+        }
+        filled_.notify_one();
+        if (done_) {
+            return;
+        }
+    }
+}
+
+
+unsigned
+AsyncLoader::Fill(Batch& batch)
+{
+    batch.inputs.clear();
+    batch.targets.clear();
+    batch.size = 0;
+
+    while (batch.size < batch_size_ && !training_data_.IsEof()) {
+        if (training_data_.NextInputs(values_) != topology_.front()) {
+            break;
+        }
+        batch.inputs.insert(batch.inputs.end(), values_.begin(),
+                            values_.end());
+
+        if (training_data_.TargetOutputs(values_) != topology_.back()) {
+            batch.inputs.resize(batch.size * topology_.front());
+            break;
+        }
+        batch.targets.insert(batch.targets.end(), values_.begin(),
+                             values_.end());
+        ++batch.size;
+    }
+
+    return batch.size;
+}
+
+
+} // ! namespace MinAnn
@@ -0,0 +1,358 @@
+/**
+ * @file binary_training_data.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <binary_training_data.hh>
+#include <training_data.hh>
+
+
+namespace {
+
+const char kMagic[8] = {'M', 'I', 'N', 'D', 'A', 'T', 'A', '\0'};
+const uint32_t kByteOrder = 0x01020304;
+const uint64_t kAlignment = 64;
+const uint64_t kMaxBytes = (uint64_t) 1 << 62;  ///< Sums of two never wrap
+
+static_assert(sizeof(BinaryTrainingData::Header) == 64,
+              "Header must be 64 bytes");
+
+
+uint64_t
+AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+
+// Store values as floats or doubles, appending them to a byte block
+void
+Append(const std::vector<double>& values, unsigned value_size,
+       std::vector<char>& block)
+{
+    std::size_t size = block.size();
+
+    block.resize(size + values.size() * value_size);
+    for (unsigned i = 0; i < values.size(); ++i) {
+        if (value_size == sizeof(float)) {
+            float value = values[i];
+            memcpy(&block[size + i * sizeof(value)], &value, sizeof(value));
+        } else {
+            memcpy(&block[size + i * sizeof(double)], &values[i],
+                   sizeof(double));
+        }
+    }
+}
+
+
+// Write a chunk: its inputs, then its targets, padded to the same room
+// every other chunk takes
+void
+WriteChunk(std::ofstream& file, std::vector<char>& inputs,
+           std::vector<char>& targets, uint64_t targets_offset,
+           uint64_t chunk_stride)
+{
+    inputs.resize(targets_offset, 0);
+    targets.resize(chunk_stride - targets_offset, 0);
+    file.write(&inputs[0], inputs.size());
+    file.write(&targets[0], targets.size());
+    inputs.clear();
+    targets.clear();
+}
+
+} // ! namespace
+
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+BinaryTrainingData::BinaryTrainingData(const std::string filename)
+    : data_(0),
+      mapping_(0),
+      mapping_size_(0),
+      value_size_(0),
+      num_samples_(0),
+      chunk_size_(1),
+      chunk_stride_(0),
+      targets_offset_(0),
+      next_sample_(0)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+        void* mapping = mmap(0, status.st_size, PROT_READ, MAP_SHARED,
+                             fd, 0);
+        if (mapping != MAP_FAILED) {
+            mapping_ = mapping;
+            mapping_size_ = status.st_size;
+        }
+    }
+    close(fd);
+
+    const char* data = (const char*) mapping_;
+    Header header;
+
+    if (mapping_ == 0 || mapping_size_ < sizeof(header)) {
+        return;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    /* Offsets and counts come from the file: every bound is checked by
+     * subtraction from the size, or by division before a product, so
+     * that no sum or product can wrap around */
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.byte_order != kByteOrder ||
+        header.version != kVersion ||
+        header.num_layers < 2 ||
+        (header.value_size != sizeof(float) &&
+         header.value_size != sizeof(double)) ||
+        header.chunk_size == 0 ||
+        header.chunk_size > kMaxBytes ||
+        header.num_samples > kMaxBytes ||
+        header.topology_offset < sizeof(Header) ||
+        header.topology_offset > mapping_size_ ||
+        header.num_layers > (mapping_size_ - header.topology_offset) /
+                            sizeof(uint32_t) ||
+        header.data_offset > mapping_size_ ||
+        header.data_offset % kAlignment != 0) {
+        return;
+    }
+
+    std::vector<unsigned> topology(header.num_layers);
+    for (unsigned l = 0; l < header.num_layers; ++l) {
+        uint32_t size;
+
+        memcpy(&size, data + header.topology_offset + l * sizeof(size),
+               sizeof(size));
+        if (size == 0) {
+            return;
+        }
+        topology[l] = size;
+    }
+
+    // A chunk of inputs or of targets must be smaller than kMaxBytes
+    uint64_t input_size = (uint64_t) topology.front() * header.value_size;
+    uint64_t target_size = (uint64_t) topology.back() * header.value_size;
+    if (header.chunk_size > kMaxBytes / input_size ||
+        header.chunk_size > kMaxBytes / target_size) {
+        return;
+    }
+
+    uint64_t targets_offset =
+        AlignUp(header.chunk_size * input_size, kAlignment);
+    uint64_t chunk_stride = targets_offset +
+        AlignUp(header.chunk_size * target_size, kAlignment);
+    uint64_t num_chunks = header.num_samples / header.chunk_size +
+        (header.num_samples % header.chunk_size != 0);
+
+    if (num_chunks > (mapping_size_ - header.data_offset) / chunk_stride) {
+        return;
+    }
+
+    topology_.swap(topology);
+    data_ = data + header.data_offset;
+    value_size_ = header.value_size;
+    num_samples_ = header.num_samples;
+    chunk_size_ = header.chunk_size;
+    chunk_stride_ = chunk_stride;
+    targets_offset_ = targets_offset;
+}
+
+
+BinaryTrainingData::~BinaryTrainingData(void)
+{
+    if (mapping_ != 0) {
+        munmap(mapping_, mapping_size_);
+    }
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+uint64_t
+BinaryTrainingData::Convert(TrainingData& training_data,
+                            const std::string& filename,
+                            unsigned value_size,
+                            uint64_t chunk_size)
+{
+    if ((value_size != sizeof(float) && value_size != sizeof(double)) ||
+        chunk_size == 0) {
+        return 0;
+    }
+
+    std::vector<unsigned> topology;
+    training_data.Topology(topology);
+    if (topology.size() < 2) {
+        return 0;
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.byte_order = kByteOrder;
+    header.version = kVersion;
+    header.num_layers = topology.size();
+    header.value_size = value_size;
+    header.chunk_size = chunk_size;
+    header.topology_offset = sizeof(Header);
+    header.data_offset = AlignUp(sizeof(Header) +
+                                 topology.size() * sizeof(uint32_t),
+                                 kAlignment);
+
+    std::vector<uint32_t> sizes(topology.begin(), topology.end());
+    std::vector<char> padding(header.data_offset - header.topology_offset -
+                              sizes.size() * sizeof(uint32_t), 0);
+    uint64_t targets_offset =
+        AlignUp(chunk_size * topology.front() * value_size, kAlignment);
+    uint64_t chunk_stride = targets_offset +
+        AlignUp(chunk_size * topology.back() * value_size, kAlignment);
+
+    std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+
+    // The header is written again once the number of samples is known
+    file.write((const char*) &header, sizeof(header));
+    file.write((const char*) &sizes[0], sizes.size() * sizeof(uint32_t));
+    file.write(padding.empty() ? "" : &padding[0], padding.size());
+
+    std::vector<double> input_values, target_values;
+    std::vector<char> inputs, targets;
+
+    while (!training_data.IsEof()) {
+        if (training_data.NextInputs(input_values) != topology.front()) {
+            break;
+        }
+        if (training_data.TargetOutputs(target_values) != topology.back()) {
+            break;
+        }
+
+        Append(input_values, value_size, inputs);
+        Append(target_values, value_size, targets);
+        if (++header.num_samples % chunk_size == 0) {
+            WriteChunk(file, inputs, targets, targets_offset, chunk_stride);
+        }
+    }
+    if (header.num_samples % chunk_size != 0) {
+        WriteChunk(file, inputs, targets, targets_offset, chunk_stride);
+    }
+
+    file.seekp(0);
+    file.write((const char*) &header, sizeof(header));
+    file.close();
+
+    return file.fail() ? 0 : header.num_samples;
+}
+
+
+bool
+BinaryTrainingData::IsEof(void)
+{
+    return next_sample_ >= num_samples_;
+}
+
+
+void
+BinaryTrainingData::Topology(std::vector<unsigned>& topology)
+{
+    if (!IsOpen()) {
+        abort();
+    }
+
+    topology.insert(topology.end(), topology_.begin(), topology_.end());
+}
+
+
+unsigned
+BinaryTrainingData::NextInputs(std::vector<double>& input_values)
+{
+    if (IsEof()) {
+        input_values.clear();
+        return 0;
+    }
+
+    return Read(next_sample_, false, input_values);
+}
+
+
+unsigned
+BinaryTrainingData::TargetOutputs(std::vector<double>& target_output_values)
+{
+    if (IsEof()) {
+        target_output_values.clear();
+        return 0;
+    }
+
+    return Read(next_sample_++, true, target_output_values);
+}
+
+
+void
+BinaryTrainingData::Rewind(void)
+{
+    next_sample_ = 0;
+}
+
+
+// PRIVATE ============================================================
+
+// OPERATIONS ---------------------------------------------------------
+unsigned
+BinaryTrainingData::Read(uint64_t sample, bool targets,
+                         std::vector<double>& values) const
+{
+    unsigned count = targets ? topology_.back() : topology_.front();
+    const char* data = Values(sample, targets);
+
+    values.resize(count);
+    if (value_size_ == sizeof(float)) {
+        const float* from = (const float*) data;
+        for (unsigned i = 0; i < count; ++i) {
+            values[i] = from[i];
+        }
+    } else {
+        memcpy(&values[0], data, count * sizeof(double));
+    }
+
+    return count;
+}
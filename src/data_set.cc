@@ -0,0 +1,144 @@
+/**
+ * @file data_set.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <binary_training_data.hh>
+#include <data_set.hh>
+#include <training_data.hh>
+
+
+namespace MinAnn {
+
+namespace {
+
+// Read samples until the end of a TrainingData-like source
+template <class Source>
+void
+ReadAll(Source& source, DataSet& data_set)
+{
+    const std::vector<unsigned>& topology = data_set.Topology();
+    std::vector<double> input_values, target_values;
+
+    while (!source.IsEof()) {
+        if (source.NextInputs(input_values) != topology.front() ||
+            source.TargetOutputs(target_values) != topology.back()) {
+            break;
+        }
+        data_set.Add(&input_values[0], &target_values[0]);
+    }
+}
+
+} // ! namespace
+
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+DataSet::DataSet(const std::vector<unsigned>& topology)
+    : topology_(topology),
+      num_samples_(0)
+{
+}
+
+
+DataSet::DataSet(TrainingData& training_data)
+    : num_samples_(0)
+{
+    training_data.Topology(topology_);
+    ReadAll(training_data, *this);
+}
+
+
+DataSet::DataSet(BinaryTrainingData& training_data)
+    : num_samples_(0)
+{
+    training_data.Topology(topology_);
+    inputs_.reserve(training_data.NumSamples() * topology_.front());
+    targets_.reserve(training_data.NumSamples() * topology_.back());
+    ReadAll(training_data, *this);
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+void
+DataSet::Add(const double* input_values, const double* target_values)
+{
+    inputs_.insert(inputs_.end(), input_values,
+                   input_values + topology_.front());
+    targets_.insert(targets_.end(), target_values,
+                    target_values + topology_.back());
+    ++num_samples_;
+}
+
+
+void
+DataSet::Split(double fraction, unsigned long seed, DataSet& held_out)
+{
+    assert(held_out.NumSamples() == 0 && held_out.topology_ == topology_);
+
+    std::vector<std::size_t> order(num_samples_);
+    for (std::size_t s = 0; s < num_samples_; ++s) {
+        order[s] = s;
+    }
+    std::mt19937 rng(seed);
+    Shuffle(order, rng);
+
+    std::size_t num_held_out = fraction * num_samples_ + 0.5f;
+    DataSet kept(topology_);
+
+    for (std::size_t s = 0; s < num_samples_; ++s) {
+        DataSet& to = s < num_held_out ? held_out : kept;
+        to.Add(Inputs(order[s]), Targets(order[s]));
+    }
+
+    inputs_.swap(kept.inputs_);
+    targets_.swap(kept.targets_);
+    num_samples_ = kept.num_samples_;
+}
+
+
+void
+DataSet::Shuffle(std::vector<std::size_t>& order, std::mt19937& rng)
+{
+    for (std::size_t i = order.size(); i > 1; --i) {
+        std::size_t j = rng() % i;
+        std::swap(order[i - 1], order[j]);
+    }
+}
+
+
+} // ! namespace MinAnn
@@ -0,0 +1,213 @@
+/**
+ * @file epoch_trainer.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <data_set.hh>
+#include <epoch_trainer.hh>
+#include <inference_model.hh>
+#include <net.hh>
+
+
+namespace MinAnn {
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+EpochTrainer::Options::Options(void)
+    : batch_size(1),
+      max_epochs(100),
+      patience(5),
+      min_improvement(0.0f),
+      seed(1)
+{
+}
+
+
+EpochTrainer::EpochTrainer(Net& net, const DataSet& training_set,
+                           const Options& options)
+    : net_(net),
+      best_net_(net),
+      training_set_(training_set),
+      validation_set_(0),
+      options_(options)
+{
+    Init();
+}
+
+
+EpochTrainer::EpochTrainer(Net& net, const DataSet& training_set,
+                           const DataSet& validation_set,
+                           const Options& options)
+    : net_(net),
+      best_net_(net),
+      training_set_(training_set),
+      validation_set_(&validation_set),
+      options_(options)
+{
+    Init();
+}
+
+
+EpochTrainer::~EpochTrainer(void)
+{
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+bool
+EpochTrainer::Epoch(void)
+{
+    if (stopped_) {
+        return false;
+    }
+
+    const std::vector<unsigned>& topology = training_set_.Topology();
+    unsigned num_inputs = topology.front();
+    unsigned num_outputs = topology.back();
+
+    DataSet::Shuffle(order_, rng_);
+    for (std::size_t s = 0; s < order_.size(); s += options_.batch_size) {
+        unsigned batch_size = std::min<std::size_t>(options_.batch_size,
+                                                    order_.size() - s);
+
+        input_values_.resize(batch_size * num_inputs);
+        target_values_.resize(batch_size * num_outputs);
+        for (unsigned b = 0; b < batch_size; ++b) {
+            std::copy(training_set_.Inputs(order_[s + b]),
+                      training_set_.Inputs(order_[s + b]) + num_inputs,
+                      input_values_.begin() + b * num_inputs);
+            std::copy(training_set_.Targets(order_[s + b]),
+                      training_set_.Targets(order_[s + b]) + num_outputs,
+                      target_values_.begin() + b * num_outputs);
+        }
+        net_.TrainBatch(input_values_, target_values_, batch_size);
+    }
+    ++epochs_;
+
+    last_error_ = validation_set_ != 0
+        ? Error(net_, *validation_set_)
+        : net_.RecentAvgError();
+
+    if (last_error_ < best_error_ - options_.min_improvement) {
+        best_error_ = last_error_;
+        best_epoch_ = epochs_;
+        best_net_ = net_;
+    }
+
+    if (epochs_ - best_epoch_ >= options_.patience ||
+        epochs_ >= options_.max_epochs) {
+        stopped_ = true;
+        if (best_epoch_ != epochs_) {
+            net_ = best_net_;
+        }
+    }
+
+    return !stopped_;
+}
+
+
+unsigned
+EpochTrainer::Train(void)
+{
+    while (Epoch()) {
+    }
+
+    return epochs_;
+}
+
+
+double
+EpochTrainer::Error(const Net& net, const DataSet& data_set)
+{
+    if (data_set.NumSamples() == 0) {
+        return 0.0f;
+    }
+
+    InferenceModel model(net);
+    unsigned num_outputs = data_set.Topology().back();
+    std::vector<double> result_values(data_set.NumSamples() * num_outputs);
+
+    model.Predict(data_set.Inputs(0), data_set.NumSamples(),
+                  &result_values[0]);
+
+    const double* target_values = data_set.Targets(0);
+    double sum = 0.0f;
+
+    for (std::size_t s = 0; s < data_set.NumSamples(); ++s) {
+        double error = 0.0f;
+
+        for (unsigned n = 0; n < num_outputs; ++n) {
+            double delta = target_values[s * num_outputs + n] -
+                result_values[s * num_outputs + n];
+            error += delta * delta;
+        }
+        sum += sqrt(error / num_outputs);
+    }
+
+    return sum / data_set.NumSamples();
+}
+
+
+// PRIVATE ============================================================
+
+// OPERATIONS ---------------------------------------------------------
+void
+EpochTrainer::Init(void)
+{
+    assert(options_.batch_size > 0);
+    assert(training_set_.Topology().front() == net_.Topology().front());
+    assert(training_set_.Topology().back() == net_.Topology().back());
+    assert(validation_set_ == 0 ||
+           (validation_set_->Topology().front() == net_.Topology().front() &&
+            validation_set_->Topology().back() == net_.Topology().back()));
+
+    rng_.seed(options_.seed);
+    order_.resize(training_set_.NumSamples());
+    for (std::size_t s = 0; s < order_.size(); ++s) {
+        order_[s] = s;
+    }
+
+    epochs_ = 0;
+    best_epoch_ = 0;
+    best_error_ = std::numeric_limits<double>::max();
+    last_error_ = 0.0f;
+    stopped_ = training_set_.NumSamples() == 0 || options_.max_epochs == 0;
+}
+
+
+} // ! namespace MinAnn
@@ -0,0 +1,100 @@
+/**
+ * @file hogwild_trainer.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <vector>
+
+#include <hogwild_trainer.hh>
+
+
+namespace MinAnn {
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+HogwildTrainer::HogwildTrainer(Net& net, unsigned num_threads)
+    : net_(net),
+      pool_(std::max(1u, num_threads)),
+      workspaces_(pool_.Size(), Workspace(net.Topology(), 1))
+{
+}
+
+
+HogwildTrainer::~HogwildTrainer(void)
+{
+    workspaces_.clear();
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+void
+HogwildTrainer::Train(const std::vector<double>& input_values,
+                      const std::vector<double>& target_values)
+{
+    const std::vector<unsigned>& topology = net_.Topology();
+    unsigned num_inputs = topology.front();
+    unsigned num_outputs = topology.back();
+    unsigned num_samples = input_values.size() / num_inputs;
+    std::atomic<unsigned> next(0);
+
+    assert(input_values.size() == num_samples * num_inputs);
+    assert(target_values.size() == num_samples * num_outputs);
+
+    pool_.Run([&](unsigned t) {
+        Workspace& workspace = workspaces_[t];
+
+        for (;;) {
+            unsigned first = next.fetch_add(kChunkSize,
+                                            std::memory_order_relaxed);
+            if (first >= num_samples) {
+                break;
+            }
+
+            unsigned last = std::min(first + kChunkSize, num_samples);
+            for (unsigned s = first; s < last; ++s) {
+                net_.TrainShared(&input_values[s * num_inputs],
+                                 &target_values[s * num_outputs],
+                                 workspace);
+            }
+        }
+    });
+
+    for (unsigned t = 0; t < workspaces_.size(); ++t) {
+        net_.RecordErrors(workspaces_[t]);
+        workspaces_[t].Clear();
+    }
+}
+
+
+} // ! namespace MinAnn
@@ -0,0 +1,131 @@
+/**
+ * @file inference_client.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+
+#include <cstddef>
+#include <string>
+#include <unistd.h>
+
+#include <inference_client.hh>
+#include <serve_protocol.hh>
+
+
+namespace MinAnn {
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+InferenceClient::InferenceClient(const std::string& address)
+    : fd_(ServeProtocol::Connect(address))
+{
+    info_.num_inputs = 0;
+    info_.num_outputs = 0;
+
+    if (fd_ >= 0 &&
+        !Call(ServeProtocol::kInfo, 0, 0, 0, &info_, sizeof(info_))) {
+        info_.num_inputs = 0;
+        info_.num_outputs = 0;
+    }
+}
+
+
+InferenceClient::~InferenceClient(void)
+{
+    Close();
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+bool
+InferenceClient::Predict(const double* input_values, std::size_t rows,
+                         double* result_values)
+{
+    if (rows == 0 || rows > ServeProtocol::kMaxRows) {
+        return false;
+    }
+
+    return Call(ServeProtocol::kPredict, rows, input_values,
+                rows * info_.num_inputs * sizeof(double),
+                result_values, rows * info_.num_outputs * sizeof(double));
+}
+
+
+bool
+InferenceClient::Stats(ServeProtocol::ServerStats& stats)
+{
+    return Call(ServeProtocol::kStats, 0, 0, 0, &stats, sizeof(stats));
+}
+
+
+// PRIVATE ============================================================
+
+// OPERATIONS ---------------------------------------------------------
+bool
+InferenceClient::Call(ServeProtocol::Op op, uint32_t rows,
+                      const void* data, std::size_t size,
+                      void* reply, std::size_t reply_size)
+{
+    ServeProtocol::RequestHeader header = { ServeProtocol::kMagic,
+                                            (uint16_t) op, 0, rows };
+    ServeProtocol::ResponseHeader response;
+
+    if (fd_ < 0) {
+        return false;
+    }
+
+    if (!ServeProtocol::WriteFully(fd_, &header, sizeof(header)) ||
+        (size > 0 && !ServeProtocol::WriteFully(fd_, data, size)) ||
+        !ServeProtocol::ReadFully(fd_, &response, sizeof(response)) ||
+        response.magic != ServeProtocol::kMagic ||
+        response.status != ServeProtocol::kOk ||
+        response.size != reply_size ||
+        !ServeProtocol::ReadFully(fd_, reply, reply_size)) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+
+void
+InferenceClient::Close(void)
+{
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+
+} // ! namespace MinAnn
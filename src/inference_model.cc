@@ -0,0 +1,296 @@
+/**
+ * @file inference_model.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <inference_model.hh>
+#include <kernels.hh>
+#include <layer.hh>
+#include <model_file.hh>
+
+
+namespace MinAnn {
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+InferenceModel::Context::Context(const InferenceModel& model)
+    : scratch_(2 * model.max_width_, 0.0f)
+{
+}
+
+
+InferenceModel::InferenceModel(const Net& net)
+    : topology_(net.Topology()),
+      weights_(0),
+      mapping_(0),
+      mapping_size_(0),
+      max_width_(0)
+{
+    const std::vector<Layer>& layers = net.Layers();
+
+    for (unsigned l = 0; l < layers.size(); ++l) {
+        activations_.push_back(ActivationFunction(layers[l].TransferKind()));
+    }
+
+    storage_.assign(ModelFile::Layout(topology_, offsets_), 0.0f);
+    for (unsigned l = 1; l < layers.size(); ++l) {
+        std::copy(layers[l].Weights(),
+                  layers[l].Weights() +
+                      layers[l].Size() * layers[l].NumInputs(),
+                  storage_.begin() + offsets_[l]);
+    }
+    weights_ = storage_.empty() ? 0 : &storage_[0];
+
+    MeasureWidth();
+}
+
+
+InferenceModel::InferenceModel(const std::string& filename)
+    : weights_(0),
+      mapping_(0),
+      mapping_size_(0),
+      max_width_(0)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+        void* mapping = mmap(0, status.st_size, PROT_READ, MAP_SHARED,
+                             fd, 0);
+        if (mapping != MAP_FAILED) {
+            mapping_ = mapping;
+            mapping_size_ = status.st_size;
+        }
+    }
+    close(fd);
+
+    std::vector<Activation> kinds;
+    if (mapping_ == 0 ||
+        !ModelFile::Parse((const char*) mapping_, mapping_size_,
+                          topology_, kinds, weights_)) {
+        Unmap();
+        return;
+    }
+
+    for (unsigned l = 0; l < kinds.size(); ++l) {
+        activations_.push_back(ActivationFunction(kinds[l]));
+    }
+
+    ModelFile::Layout(topology_, offsets_);
+    MeasureWidth();
+}
+
+
+InferenceModel::~InferenceModel(void)
+{
+    Unmap();
+    storage_.clear();
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+void
+InferenceModel::Predict(const double* input_values, double* result_values,
+                        Context& context) const
+{
+    assert(context.scratch_.size() >= 2 * max_width_);
+
+    Forward(input_values, result_values, &context.scratch_[0]);
+}
+
+
+void
+InferenceModel::Predict(const double* input_values,
+                        double* result_values) const
+{
+    static thread_local std::vector<double> scratch;
+
+    if (scratch.size() < 2 * max_width_) {
+        scratch.resize(2 * max_width_);
+    }
+    Forward(input_values, result_values, &scratch[0]);
+}
+
+
+void
+InferenceModel::Predict(const double* input_values, std::size_t rows,
+                        double* result_values) const
+{
+    ForwardBatch(input_values, rows, result_values);
+}
+
+
+void
+InferenceModel::Predict(const double* input_values, std::size_t rows,
+                        double* result_values, ThreadPool& pool) const
+{
+    std::size_t num_threads = pool.Size();
+
+    pool.Run([&](unsigned t) {
+        std::size_t first = rows * t / num_threads;
+        std::size_t last = rows * (t + 1) / num_threads;
+
+        ForwardBatch(input_values + first * NumInputs(), last - first,
+                     result_values + first * NumOutputs());
+    });
+}
+
+
+// PRIVATE ============================================================
+
+// OPERATIONS ---------------------------------------------------------
+void
+InferenceModel::MeasureWidth(void)
+{
+    max_width_ = 0;
+    for (unsigned l = 0; l < topology_.size(); ++l) {
+        max_width_ = std::max(max_width_, topology_[l] + 1);
+    }
+}
+
+
+void
+InferenceModel::Unmap(void)
+{
+    if (mapping_ != 0) {
+        munmap(mapping_, mapping_size_);
+    }
+    mapping_ = 0;
+    mapping_size_ = 0;
+    weights_ = storage_.empty() ? 0 : &storage_[0];
+    if (weights_ == 0) {
+        topology_.clear();
+        activations_.clear();
+    }
+}
+
+
+void
+InferenceModel::Forward(const double* input_values, double* result_values,
+                        double* scratch) const
+{
+    unsigned num_layers = topology_.size();
+    double* inputs = scratch;
+    double* outputs = scratch + max_width_;
+
+    std::copy(input_values, input_values + topology_[0], inputs);
+    inputs[topology_[0]] = 1.0f;
+
+    for (unsigned l = 1; l < num_layers; ++l) {
+        unsigned num_neurons = topology_[l];
+        bool last = l == num_layers - 1;
+
+        // The last layer writes straight into the caller's buffer
+        if (last) {
+            outputs = result_values;
+        }
+
+        Kernels::MatVec(weights_ + offsets_[l], inputs, outputs,
+                        num_neurons, topology_[l - 1] + 1);
+        activations_[l].Forward(outputs, num_neurons);
+
+        if (!last) {
+            outputs[num_neurons] = 1.0f;
+            std::swap(inputs, outputs);
+        }
+    }
+}
+
+
+void
+InferenceModel::ForwardBatch(const double* input_values, std::size_t rows,
+                             double* result_values) const
+{
+    static thread_local std::vector<double> scratch;
+    unsigned num_layers = topology_.size();
+    unsigned num_inputs = NumInputs();
+    unsigned num_outputs = NumOutputs();
+
+    if (scratch.size() < 2 * kTileRows * max_width_) {
+        scratch.resize(2 * kTileRows * max_width_);
+    }
+
+    for (std::size_t first = 0; first < rows; first += kTileRows) {
+        unsigned count = std::min<std::size_t>(kTileRows, rows - first);
+        double* inputs = &scratch[0];
+        double* outputs = inputs + kTileRows * max_width_;
+
+        // Latch the tile, one row per sample plus the bias column
+        for (unsigned r = 0; r < count; ++r) {
+            const double* row = input_values + (first + r) * num_inputs;
+
+            std::copy(row, row + num_inputs, inputs + r * (num_inputs + 1));
+            inputs[r * (num_inputs + 1) + num_inputs] = 1.0f;
+        }
+
+        for (unsigned l = 1; l < num_layers; ++l) {
+            unsigned num_neurons = topology_[l];
+            unsigned width = num_neurons + 1;
+            bool last = l == num_layers - 1;
+
+            // The last layer writes straight into the caller's buffer
+            if (last) {
+                outputs = result_values + first * num_outputs;
+                width = num_outputs;
+            }
+
+            Kernels::GemmNT(inputs, weights_ + offsets_[l], outputs, count,
+                            num_neurons, topology_[l - 1] + 1,
+                            topology_[l - 1] + 1, width);
+
+            for (unsigned r = 0; r < count; ++r) {
+                double* row = outputs + r * width;
+
+                activations_[l].Forward(row, num_neurons);
+                if (!last) {
+                    row[num_neurons] = 1.0f;
+                }
+            }
+
+            std::swap(inputs, outputs);
+        }
+    }
+}
+
+
+} // ! namespace MinAnn
@@ -0,0 +1,422 @@
+/**
+ * @file inference_server.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <inference_model.hh>
+#include <inference_server.hh>
+#include <serve_protocol.hh>
+
+
+namespace MinAnn {
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+InferenceServer::Options::Options(void)
+    : max_batch_rows(256),
+      budget_us(200)
+{
+}
+
+
+InferenceServer::InferenceServer(const InferenceModel& model,
+                                 const Options& options)
+    : model_(model),
+      options_(options),
+      listen_fd_(-1),
+      closing_(false),
+      queued_rows_(0),
+      open_connections_(0),
+      stopping_(false),
+      started_(Clock::now()),
+      requests_(0),
+      rows_(0),
+      batches_(0),
+      latencies_us_(ServeProtocol::kLatencyWindow, 0.0f),
+      next_latency_(0)
+{
+    if (options_.max_batch_rows == 0) {
+        options_.max_batch_rows = 1;
+    }
+}
+
+
+InferenceServer::~InferenceServer(void)
+{
+    Stop();
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+bool
+InferenceServer::Start(const std::string& address)
+{
+    if (listen_fd_ >= 0) {
+        return false;
+    }
+
+    listen_fd_ = ServeProtocol::Listen(address);
+    if (listen_fd_ < 0) {
+        return false;
+    }
+    address_ = address;
+    closing_ = false;
+    stopping_ = false;
+    started_ = Clock::now();
+
+    batch_thread_ = std::thread(&InferenceServer::BatchLoop, this);
+    accept_thread_ = std::thread(&InferenceServer::AcceptLoop, this);
+
+    return true;
+}
+
+
+void
+InferenceServer::Stop(void)
+{
+    if (listen_fd_ < 0) {
+        return;
+    }
+
+    // No more connections; accept() fails once the socket is shut down
+    shutdown(listen_fd_, SHUT_RDWR);
+    accept_thread_.join();
+    close(listen_fd_);
+    listen_fd_ = -1;
+    if (ServeProtocol::IsUnixAddress(address_)) {
+        unlink(address_.c_str());
+    }
+
+    /* Wake every connection thread blocked reading; one waiting for
+     * its outputs still gets them, as the batching thread runs on */
+    {
+        std::unique_lock<std::mutex> lock(connections_mutex_);
+
+        closing_ = true;
+        for (std::size_t c = 0; c < connection_fds_.size(); ++c) {
+            shutdown(connection_fds_[c], SHUT_RDWR);
+        }
+        while (!connection_fds_.empty()) {
+            connections_closed_.wait(lock);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    queued_.notify_one();
+    batch_thread_.join();
+}
+
+
+// ACCESSORS AND MUTATORS ---------------------------------------------
+ServeProtocol::ServerStats
+InferenceServer::Stats(void) const
+{
+    ServeProtocol::ServerStats stats;
+    std::vector<float> latencies_us;
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+
+        stats.requests = requests_;
+        stats.rows = rows_;
+        stats.batches = batches_;
+        stats.seconds = std::chrono::duration<double>(
+            Clock::now() - started_).count();
+        latencies_us.assign(latencies_us_.begin(),
+                            latencies_us_.begin() +
+                            std::min<uint64_t>(requests_,
+                                               latencies_us_.size()));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.connections = open_connections_;
+    }
+
+    stats.qps = stats.seconds > 0.0f ? stats.requests / stats.seconds
+                                     : 0.0f;
+    stats.p50_us = 0.0f;
+    stats.p99_us = 0.0f;
+    if (!latencies_us.empty()) {
+        std::size_t p50 = latencies_us.size() / 2;
+        std::size_t p99 = latencies_us.size() * 99 / 100;
+
+        std::nth_element(latencies_us.begin(), latencies_us.begin() + p50,
+                         latencies_us.end());
+        stats.p50_us = latencies_us[p50];
+        std::nth_element(latencies_us.begin(), latencies_us.begin() + p99,
+                         latencies_us.end());
+        stats.p99_us = latencies_us[p99];
+    }
+
+    return stats;
+}
+
+
+// PRIVATE ============================================================
+
+// OPERATIONS ---------------------------------------------------------
+void
+InferenceServer::AcceptLoop(void)
+{
+    int fd;
+
+    while ((fd = ServeProtocol::Accept(listen_fd_)) >= 0) {
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+
+            if (closing_) {
+                close(fd);
+                break;
+            }
+            connection_fds_.push_back(fd);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++open_connections_;
+        }
+
+        // Stop() waits for the thread through connection_fds_
+        std::thread(&InferenceServer::Serve, this, fd).detach();
+    }
+}
+
+
+void
+InferenceServer::Serve(int fd)
+{
+    ServeProtocol::RequestHeader header;
+    ServeProtocol::ModelInfo info = { model_.NumInputs(),
+                                      model_.NumOutputs() };
+    std::vector<double> input_values;
+    std::vector<double> result_values;
+
+    while (ServeProtocol::ReadFully(fd, &header, sizeof(header))) {
+        if (header.magic != ServeProtocol::kMagic) {
+            Reply(fd, ServeProtocol::kBadRequest, 0, 0);
+            break;
+        }
+
+        if (header.op == ServeProtocol::kPredict) {
+            if (header.rows == 0 || header.rows > ServeProtocol::kMaxRows) {
+                Reply(fd, ServeProtocol::kBadRequest, 0, 0);
+                break;
+            }
+
+            input_values.resize((std::size_t) header.rows * info.num_inputs);
+            result_values.resize((std::size_t) header.rows *
+                                 info.num_outputs);
+            if (!ServeProtocol::ReadFully(fd, &input_values[0],
+                                          input_values.size() *
+                                          sizeof(double))) {
+                break;
+            }
+
+            Request request = { &input_values[0], &result_values[0],
+                                header.rows, Clock::now(), false };
+            Submit(request);
+
+            if (!Reply(fd, ServeProtocol::kOk, &result_values[0],
+                       result_values.size() * sizeof(double))) {
+                break;
+            }
+        } else if (header.op == ServeProtocol::kInfo) {
+            if (!Reply(fd, ServeProtocol::kOk, &info, sizeof(info))) {
+                break;
+            }
+        } else if (header.op == ServeProtocol::kStats) {
+            ServeProtocol::ServerStats stats = Stats();
+
+            if (!Reply(fd, ServeProtocol::kOk, &stats, sizeof(stats))) {
+                break;
+            }
+        } else {
+            Reply(fd, ServeProtocol::kBadRequest, 0, 0);
+            break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --open_connections_;
+    }
+    // The batching thread may have been waiting for this connection
+    queued_.notify_one();
+
+    close(fd);
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    connection_fds_.erase(std::find(connection_fds_.begin(),
+                                    connection_fds_.end(), fd));
+    connections_closed_.notify_all();
+}
+
+
+void
+InferenceServer::Submit(Request& request)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    queue_.push_back(&request);
+    queued_rows_ += request.rows;
+    queued_.notify_one();
+
+    while (!request.done) {
+        answered_.wait(lock);
+    }
+}
+
+
+void
+InferenceServer::BatchLoop(void)
+{
+    std::vector<Request*> batch;
+    std::vector<double> input_values;
+    std::vector<double> result_values;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (;;) {
+        while (queue_.empty() && !stopping_) {
+            queued_.wait(lock);
+        }
+        if (queue_.empty()) {
+            break;
+        }
+
+        // Give other connections until the budget runs out to join in
+        Clock::time_point deadline = queue_.front()->arrived +
+            std::chrono::microseconds(options_.budget_us);
+        while (queued_rows_ < options_.max_batch_rows &&
+               queue_.size() < open_connections_ &&
+               Clock::now() < deadline) {
+            queued_.wait_until(lock, deadline);
+        }
+
+        // Whole requests, at least one, up to the batch size
+        std::size_t rows = 0;
+        batch.clear();
+        while (!queue_.empty() &&
+               (batch.empty() ||
+                rows + queue_.front()->rows <= options_.max_batch_rows)) {
+            batch.push_back(queue_.front());
+            rows += queue_.front()->rows;
+            queue_.pop_front();
+        }
+        queued_rows_ -= rows;
+
+        lock.unlock();
+        RunBatch(batch, rows, input_values, result_values);
+        lock.lock();
+
+        for (std::size_t r = 0; r < batch.size(); ++r) {
+            batch[r]->done = true;
+        }
+        answered_.notify_all();
+    }
+}
+
+
+void
+InferenceServer::RunBatch(const std::vector<Request*>& batch,
+                          std::size_t rows,
+                          std::vector<double>& input_values,
+                          std::vector<double>& result_values)
+{
+    std::size_t num_inputs = model_.NumInputs();
+    std::size_t num_outputs = model_.NumOutputs();
+
+    if (batch.size() == 1) {
+        model_.Predict(batch[0]->input_values, rows,
+                       batch[0]->result_values);
+    } else {
+        // Gather the rows of every request, and scatter their outputs
+        input_values.resize(rows * num_inputs);
+        result_values.resize(rows * num_outputs);
+
+        double* p = &input_values[0];
+        for (std::size_t r = 0; r < batch.size(); ++r) {
+            memcpy(p, batch[r]->input_values,
+                   batch[r]->rows * num_inputs * sizeof(double));
+            p += batch[r]->rows * num_inputs;
+        }
+
+        model_.Predict(&input_values[0], rows, &result_values[0]);
+
+        const double* q = &result_values[0];
+        for (std::size_t r = 0; r < batch.size(); ++r) {
+            memcpy(batch[r]->result_values, q,
+                   batch[r]->rows * num_outputs * sizeof(double));
+            q += batch[r]->rows * num_outputs;
+        }
+    }
+
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+
+    for (std::size_t r = 0; r < batch.size(); ++r) {
+        latencies_us_[next_latency_] = std::chrono::duration<float,
+            std::micro>(now - batch[r]->arrived).count();
+        next_latency_ = (next_latency_ + 1) % latencies_us_.size();
+    }
+    requests_ += batch.size();
+    rows_ += rows;
+    ++batches_;
+}
+
+
+bool
+InferenceServer::Reply(int fd, ServeProtocol::Status status,
+                       const void* data, std::size_t size)
+{
+    ServeProtocol::ResponseHeader header = { ServeProtocol::kMagic,
+                                             (uint16_t) status, 0,
+                                             (uint32_t) size };
+
+    return ServeProtocol::WriteFully(fd, &header, sizeof(header)) &&
+           (size == 0 || ServeProtocol::WriteFully(fd, data, size));
+}
+
+
+} // ! namespace MinAnn
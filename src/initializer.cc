@@ -0,0 +1,157 @@
+/**
+ * @file initializer.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+
+#include <initializer.hh>
+#include <thread_pool.hh>
+
+
+namespace MinAnn {
+
+namespace {
+
+const uint64_t kGoldenGamma = 0x9e3779b97f4a7c15ull;
+
+
+// SplitMix64 finalizer, a bijection with good avalanche
+inline uint64_t
+Mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+
+// Rows [first, last) of a layer
+template <typename T>
+void
+FillRows(T* weights, uint64_t seed, unsigned layer_num,
+         Initializer::Scheme scheme, unsigned num_inputs,
+         double limit, unsigned first, unsigned last)
+{
+    unsigned stride = num_inputs + 1;
+
+    for (unsigned j = first; j < last; ++j) {
+        for (unsigned i = 0; i < stride; ++i) {
+            uint64_t counter = (uint64_t) j * stride + i;
+            double u = Initializer::Uniform(seed, layer_num, counter);
+
+            if (scheme == Initializer::kUniform) {
+                weights[counter] = u;
+            } else {
+                weights[counter] = i == num_inputs
+                    ? 0.0f
+                    : (2.0f * u - 1.0f) * limit;
+            }
+        }
+    }
+}
+
+} // ! namespace
+
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+Initializer::Initializer(uint64_t seed, Scheme scheme,
+                         unsigned num_threads)
+    : seed_(seed),
+      scheme_(scheme),
+      num_threads_(num_threads == 0 ? 1 : num_threads)
+{
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+template <typename T>
+void
+Initializer::Fill(T* weights, unsigned layer_num, unsigned num_neurons,
+                  unsigned num_inputs) const
+{
+    double limit = 1.0f;
+
+    // The input layer has no weights at all
+    if (num_inputs == 0) {
+        return;
+    }
+
+    if (scheme_ == kXavier) {
+        limit = std::sqrt(6.0f / (num_inputs + num_neurons));
+    } else if (scheme_ == kHe) {
+        limit = std::sqrt(6.0f / num_inputs);
+    }
+
+    unsigned long size = (unsigned long) num_neurons * (num_inputs + 1);
+    if (num_threads_ == 1 || size < kParallelThreshold) {
+        FillRows(weights, seed_, layer_num, scheme_, num_inputs, limit,
+                 0, num_neurons);
+        return;
+    }
+
+    // Every thread takes a run of whole rows
+    ThreadPool pool(std::min(num_threads_, num_neurons));
+    unsigned num_threads = pool.Size();
+    Scheme scheme = scheme_;
+    uint64_t seed = seed_;
+
+    pool.Run([=](unsigned t) {
+        FillRows(weights, seed, layer_num, scheme, num_inputs, limit,
+                 (unsigned long) num_neurons * t / num_threads,
+                 (unsigned long) num_neurons * (t + 1) / num_threads);
+    });
+}
+
+
+double
+Initializer::Uniform(uint64_t seed, uint64_t stream, uint64_t counter)
+{
+    uint64_t key = Mix(seed + Mix(stream + kGoldenGamma));
+    uint64_t bits = Mix(key + (counter + 1) * kGoldenGamma);
+
+    // Top 53 bits, exactly representable
+    return (bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+// Single and double precision weights
+template void Initializer::Fill(float*, unsigned, unsigned,
+                                unsigned) const;
+template void Initializer::Fill(double*, unsigned, unsigned,
+                                unsigned) const;
+
+
+} // ! namespace MinAnn
@@ -0,0 +1,2037 @@
+/**
+ * @file kernels.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <kernels.hh>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define MINANN_X86 1
+#  include <immintrin.h>
+#endif
+
+
+namespace MinAnn {
+
+namespace {
+
+// SCALAR -------------------------------------------------------------
+template <typename T>
+void
+MatVecScalar(const T* w, const T* x, T* y, unsigned rows, unsigned cols)
+{
+    for (unsigned j = 0; j < rows; ++j) {
+        const T* row = w + (unsigned long) j * cols;
+        T sum = 0.0f;
+
+        for (unsigned i = 0; i < cols; ++i) {
+            sum += x[i] * row[i];
+        }
+        y[j] = sum;
+    }
+}
+
+
+void
+MatVecScalar(const int8_t* w, const int8_t* x, int32_t* y,
+             unsigned rows, unsigned cols)
+{
+    for (unsigned j = 0; j < rows; ++j) {
+        const int8_t* row = w + (unsigned long) j * cols;
+        int32_t sum = 0;
+
+        for (unsigned i = 0; i < cols; ++i) {
+            sum += (int32_t) x[i] * row[i];
+        }
+        y[j] = sum;
+    }
+}
+
+
+template <typename T>
+void
+MatTVecScalar(const T* w, const T* g, T* y,
+              unsigned rows, unsigned cols, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        y[i] = 0.0f;
+    }
+
+    for (unsigned j = 0; j < rows; ++j) {
+        const T* row = w + (unsigned long) j * cols;
+
+        for (unsigned i = 0; i < n; ++i) {
+            y[i] += row[i] * g[j];
+        }
+    }
+}
+
+
+template <typename T>
+void
+MomentumUpdateScalar(T* w, T* dw, const T* x, const T* g,
+                     unsigned rows, unsigned cols, T eta, T alpha)
+{
+    for (unsigned j = 0; j < rows; ++j) {
+        T* row = w + (unsigned long) j * cols;
+        T* delta_row = dw + (unsigned long) j * cols;
+        T eta_gradient = eta * g[j];
+
+        for (unsigned i = 0; i < cols; ++i) {
+            delta_row[i] = eta_gradient * x[i] + alpha * delta_row[i];
+            row[i] += delta_row[i];
+        }
+    }
+}
+
+
+/* Single weight updates, shared by the scalar kernels and the tails of
+ * the vectorized ones; @e step is the learning rate times the gradient
+ * of the weight, @e d its gradient alone */
+template <typename T>
+inline void
+NesterovStep(T& w, T& v, T step, T alpha)
+{
+    v = alpha * v + step;
+    w += alpha * v + step;
+}
+
+
+template <typename T>
+inline void
+RmsPropStep(T& w, T& s, T d, T eta, T rho, T epsilon)
+{
+    s = rho * s + (1.0f - rho) * d * d;
+    w += eta * d / (std::sqrt(s) + epsilon);
+}
+
+
+template <typename T>
+inline void
+AdamStep(T& w, T& m, T& v, T d, T eta, T beta1, T beta2, T epsilon)
+{
+    m = beta1 * m + (1.0f - beta1) * d;
+    v = beta2 * v + (1.0f - beta2) * d * d;
+    w += eta * m / (std::sqrt(v) + epsilon);
+}
+
+
+template <typename T>
+void
+NesterovUpdateScalar(T* w, T* dw, const T* x, const T* g,
+                     unsigned rows, unsigned cols, T eta, T alpha)
+{
+    for (unsigned j = 0; j < rows; ++j) {
+        T* row = w + (unsigned long) j * cols;
+        T* delta_row = dw + (unsigned long) j * cols;
+        T eta_gradient = eta * g[j];
+
+        for (unsigned i = 0; i < cols; ++i) {
+            NesterovStep(row[i], delta_row[i], eta_gradient * x[i], alpha);
+        }
+    }
+}
+
+
+template <typename T>
+void
+RmsPropUpdateScalar(T* w, T* s, const T* x, const T* g,
+                    unsigned rows, unsigned cols,
+                    T eta, T rho, T epsilon)
+{
+    for (unsigned j = 0; j < rows; ++j) {
+        T* row = w + (unsigned long) j * cols;
+        T* square_row = s + (unsigned long) j * cols;
+
+        for (unsigned i = 0; i < cols; ++i) {
+            RmsPropStep(row[i], square_row[i], g[j] * x[i],
+                        eta, rho, epsilon);
+        }
+    }
+}
+
+
+template <typename T>
+void
+AdamUpdateScalar(T* w, T* m, T* v, const T* x, const T* g,
+                 unsigned rows, unsigned cols,
+                 T eta, T beta1, T beta2, T epsilon)
+{
+    for (unsigned j = 0; j < rows; ++j) {
+        unsigned long first = (unsigned long) j * cols;
+
+        for (unsigned i = 0; i < cols; ++i) {
+            AdamStep(w[first + i], m[first + i], v[first + i],
+                     g[j] * x[i], eta, beta1, beta2, epsilon);
+        }
+    }
+}
+
+
+template <typename T>
+void
+GemmNTScalar(const T* a, const T* b, T* c,
+             unsigned m, unsigned n, unsigned k,
+             unsigned lda, unsigned ldc)
+{
+    for (unsigned r = 0; r < m; ++r) {
+        MatVecScalar(b, a + (unsigned long) r * lda,
+                     c + (unsigned long) r * ldc, n, k);
+    }
+}
+
+
+/* Rational approximation of tanh, an odd polynomial of degree 13 over
+ * an even one of degree 6, on inputs clamped to where tanh rounds to
+ * one in single precision */
+const double kTanhClamp = 7.90531110763549805;
+const double kTanhP[] = {
+    -2.76076847742355e-16, 2.00018790482477e-13, -8.60467152213735e-11,
+    5.12229709037114e-08, 1.48572235717979e-05, 6.37261928875436e-04,
+    4.89352455891786e-03
+};
+const double kTanhQ[] = {
+    1.19825839466702e-06, 1.18534705686654e-04, 2.26843463243900e-03,
+    4.89352518554385e-03
+};
+
+
+template <typename T>
+void
+TanhScalar(T* x, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        x[i] = std::tanh(x[i]);
+    }
+}
+
+
+template <typename T>
+void
+FastTanhScalar(T* x, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        T v = std::min(std::max(x[i], (T) -kTanhClamp), (T) kTanhClamp);
+        T v2 = v * v;
+        T p = kTanhP[0];
+        T q = kTanhQ[0];
+
+        for (unsigned c = 1; c < 7; ++c) {
+            p = p * v2 + (T) kTanhP[c];
+        }
+        for (unsigned c = 1; c < 4; ++c) {
+            q = q * v2 + (T) kTanhQ[c];
+        }
+        x[i] = v * p / q;
+    }
+}
+
+
+#ifdef MINANN_X86
+
+// SSE2 ---------------------------------------------------------------
+__attribute__((target("sse2")))
+void
+MatVecSse2(const double* w, const double* x, double* y,
+           unsigned rows, unsigned cols)
+{
+    for (unsigned j = 0; j < rows; ++j) {
+        const double* row = w + (unsigned long) j * cols;
+        __m128d acc0 = _mm_setzero_pd();
+        __m128d acc1 = _mm_setzero_pd();
+        unsigned i = 0;
+
+        for (; i + 4 <= cols; i += 4) {
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(row + i),
+                                               _mm_loadu_pd(x + i)));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(row + i + 2),
+                                               _mm_loadu_pd(x + i + 2)));
+        }
+        acc0 = _mm_add_pd(acc0, acc1);
+
+        double lanes[2];
+        _mm_storeu_pd(lanes, acc0);
+        double sum = lanes[0] + lanes[1];
+        for (; i < cols; ++i) {
+            sum += x[i] * row[i];
+        }
+        y[j] = sum;
+    }
+}
+
+
+__attribute__((target("sse2")))
+void
+MatTVecSse2(const double* w, const double* g, double* y,
+            unsigned rows, unsigned cols, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        y[i] = 0.0f;
+    }
+
+    for (unsigned j = 0; j < rows; ++j) {
+        const double* row = w + (unsigned long) j * cols;
+        __m128d gradient = _mm_set1_pd(g[j]);
+        unsigned i = 0;
+
+        for (; i + 2 <= n; i += 2) {
+            __m128d acc = _mm_loadu_pd(y + i);
+            acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(row + i),
+                                             gradient));
+            _mm_storeu_pd(y + i, acc);
+        }
+        for (; i < n; ++i) {
+            y[i] += row[i] * g[j];
+        }
+    }
+}
+
+
+__attribute__((target("sse2")))
+void
+MomentumUpdateSse2(double* w, double* dw,
+                   const double* x, const double* g,
+                   unsigned rows, unsigned cols,
+                   double eta, double alpha)
+{
+    __m128d alpha_v = _mm_set1_pd(alpha);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        double* row = w + (unsigned long) j * cols;
+        double* delta_row = dw + (unsigned long) j * cols;
+        double eta_gradient = eta * g[j];
+        __m128d eta_gradient_v = _mm_set1_pd(eta_gradient);
+        unsigned i = 0;
+
+        for (; i + 2 <= cols; i += 2) {
+            __m128d delta = _mm_add_pd(
+                    _mm_mul_pd(eta_gradient_v, _mm_loadu_pd(x + i)),
+                    _mm_mul_pd(alpha_v, _mm_loadu_pd(delta_row + i)));
+            _mm_storeu_pd(delta_row + i, delta);
+            _mm_storeu_pd(row + i, _mm_add_pd(_mm_loadu_pd(row + i), delta));
+        }
+        for (; i < cols; ++i) {
+            delta_row[i] = eta_gradient * x[i] + alpha * delta_row[i];
+            row[i] += delta_row[i];
+        }
+    }
+}
+
+
+__attribute__((target("sse2")))
+void
+GemmNTSse2(const double* a, const double* b, double* c,
+           unsigned m, unsigned n, unsigned k,
+           unsigned lda, unsigned ldc)
+{
+    for (unsigned r = 0; r < m; ++r) {
+        MatVecSse2(b, a + (unsigned long) r * lda,
+                   c + (unsigned long) r * ldc, n, k);
+    }
+}
+
+
+__attribute__((target("sse2")))
+void
+MatVecSse2(const float* w, const float* x, float* y,
+           unsigned rows, unsigned cols)
+{
+    for (unsigned j = 0; j < rows; ++j) {
+        const float* row = w + (unsigned long) j * cols;
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        unsigned i = 0;
+
+        for (; i + 8 <= cols; i += 8) {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(row + i),
+                                               _mm_loadu_ps(x + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(row + i + 4),
+                                               _mm_loadu_ps(x + i + 4)));
+        }
+        acc0 = _mm_add_ps(acc0, acc1);
+
+        float lanes[4];
+        _mm_storeu_ps(lanes, acc0);
+        float sum = (lanes[0] + lanes[2]) + (lanes[1] + lanes[3]);
+        for (; i < cols; ++i) {
+            sum += x[i] * row[i];
+        }
+        y[j] = sum;
+    }
+}
+
+
+__attribute__((target("sse2")))
+void
+MatTVecSse2(const float* w, const float* g, float* y,
+            unsigned rows, unsigned cols, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        y[i] = 0.0f;
+    }
+
+    for (unsigned j = 0; j < rows; ++j) {
+        const float* row = w + (unsigned long) j * cols;
+        __m128 gradient = _mm_set1_ps(g[j]);
+        unsigned i = 0;
+
+        for (; i + 4 <= n; i += 4) {
+            __m128 acc = _mm_loadu_ps(y + i);
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(row + i),
+                                             gradient));
+            _mm_storeu_ps(y + i, acc);
+        }
+        for (; i < n; ++i) {
+            y[i] += row[i] * g[j];
+        }
+    }
+}
+
+
+__attribute__((target("sse2")))
+void
+MomentumUpdateSse2(float* w, float* dw,
+                   const float* x, const float* g,
+                   unsigned rows, unsigned cols,
+                   float eta, float alpha)
+{
+    __m128 alpha_v = _mm_set1_ps(alpha);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        float* row = w + (unsigned long) j * cols;
+        float* delta_row = dw + (unsigned long) j * cols;
+        float eta_gradient = eta * g[j];
+        __m128 eta_gradient_v = _mm_set1_ps(eta_gradient);
+        unsigned i = 0;
+
+        for (; i + 4 <= cols; i += 4) {
+            __m128 delta = _mm_add_ps(
+                    _mm_mul_ps(eta_gradient_v, _mm_loadu_ps(x + i)),
+                    _mm_mul_ps(alpha_v, _mm_loadu_ps(delta_row + i)));
+            _mm_storeu_ps(delta_row + i, delta);
+            _mm_storeu_ps(row + i, _mm_add_ps(_mm_loadu_ps(row + i), delta));
+        }
+        for (; i < cols; ++i) {
+            delta_row[i] = eta_gradient * x[i] + alpha * delta_row[i];
+            row[i] += delta_row[i];
+        }
+    }
+}
+
+
+__attribute__((target("sse2")))
+void
+GemmNTSse2(const float* a, const float* b, float* c,
+           unsigned m, unsigned n, unsigned k,
+           unsigned lda, unsigned ldc)
+{
+    for (unsigned r = 0; r < m; ++r) {
+        MatVecSse2(b, a + (unsigned long) r * lda,
+                   c + (unsigned long) r * ldc, n, k);
+    }
+}
+
+
+// Sign-extends the low eight bytes of a vector to 16 bits
+__attribute__((target("sse2")))
+inline __m128i
+WidenSse2(__m128i v)
+{
+    return _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+}
+
+
+__attribute__((target("sse2")))
+void
+MatVecSse2(const int8_t* w, const int8_t* x, int32_t* y,
+           unsigned rows, unsigned cols)
+{
+    for (unsigned j = 0; j < rows; ++j) {
+        const int8_t* row = w + (unsigned long) j * cols;
+        __m128i acc = _mm_setzero_si128();
+        unsigned i = 0;
+
+        for (; i + 8 <= cols; i += 8) {
+            __m128i wi =
+                WidenSse2(_mm_loadl_epi64((const __m128i*) (row + i)));
+            __m128i xi =
+                WidenSse2(_mm_loadl_epi64((const __m128i*) (x + i)));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(wi, xi));
+        }
+
+        int32_t lanes[4];
+        _mm_storeu_si128((__m128i*) lanes, acc);
+        int32_t sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        for (; i < cols; ++i) {
+            sum += (int32_t) x[i] * row[i];
+        }
+        y[j] = sum;
+    }
+}
+
+
+__attribute__((target("sse2")))
+void
+FastTanhSse2(double* x, unsigned n)
+{
+    __m128d clamp = _mm_set1_pd(kTanhClamp);
+    unsigned i = 0;
+
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_min_pd(_mm_max_pd(_mm_loadu_pd(x + i),
+                                          _mm_sub_pd(_mm_setzero_pd(),
+                                                     clamp)),
+                               clamp);
+        __m128d v2 = _mm_mul_pd(v, v);
+        __m128d p = _mm_set1_pd(kTanhP[0]);
+        __m128d q = _mm_set1_pd(kTanhQ[0]);
+
+        for (unsigned c = 1; c < 7; ++c) {
+            p = _mm_add_pd(_mm_mul_pd(p, v2), _mm_set1_pd(kTanhP[c]));
+        }
+        for (unsigned c = 1; c < 4; ++c) {
+            q = _mm_add_pd(_mm_mul_pd(q, v2), _mm_set1_pd(kTanhQ[c]));
+        }
+        _mm_storeu_pd(x + i, _mm_div_pd(_mm_mul_pd(v, p), q));
+    }
+    FastTanhScalar(x + i, n - i);
+}
+
+
+__attribute__((target("sse2")))
+void
+FastTanhSse2(float* x, unsigned n)
+{
+    __m128 clamp = _mm_set1_ps((float) kTanhClamp);
+    unsigned i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(x + i),
+                                         _mm_sub_ps(_mm_setzero_ps(),
+                                                    clamp)),
+                              clamp);
+        __m128 v2 = _mm_mul_ps(v, v);
+        __m128 p = _mm_set1_ps((float) kTanhP[0]);
+        __m128 q = _mm_set1_ps((float) kTanhQ[0]);
+
+        for (unsigned c = 1; c < 7; ++c) {
+            p = _mm_add_ps(_mm_mul_ps(p, v2), _mm_set1_ps((float) kTanhP[c]));
+        }
+        for (unsigned c = 1; c < 4; ++c) {
+            q = _mm_add_ps(_mm_mul_ps(q, v2), _mm_set1_ps((float) kTanhQ[c]));
+        }
+        _mm_storeu_ps(x + i, _mm_div_ps(_mm_mul_ps(v, p), q));
+    }
+    FastTanhScalar(x + i, n - i);
+}
+
+
+// AVX2 ---------------------------------------------------------------
+__attribute__((target("avx2,fma")))
+inline double
+DotAvx2(const double* a, const double* b, unsigned k)
+{
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    unsigned i = 0;
+
+    for (; i + 8 <= k; i += 8) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i),
+                               _mm256_loadu_pd(b + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4),
+                               _mm256_loadu_pd(b + i + 4), acc1);
+    }
+    for (; i + 4 <= k; i += 4) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i),
+                               _mm256_loadu_pd(b + i), acc0);
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0),
+                              _mm256_extractf128_pd(acc0, 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(half,
+                                          _mm_unpackhi_pd(half, half)));
+    for (; i < k; ++i) {
+        sum += a[i] * b[i];
+    }
+
+    return sum;
+}
+
+
+// Horizontal sums of four vectors, as the four lanes of a vector
+__attribute__((target("avx2,fma")))
+inline __m256d
+Sum4Avx2(__m256d s0, __m256d s1, __m256d s2, __m256d s3)
+{
+    __m256d t0 = _mm256_hadd_pd(s0, s1);
+    __m256d t1 = _mm256_hadd_pd(s2, s3);
+
+    return _mm256_add_pd(_mm256_permute2f128_pd(t0, t1, 0x20),
+                         _mm256_permute2f128_pd(t0, t1, 0x31));
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+MatVecAvx2(const double* w, const double* x, double* y,
+           unsigned rows, unsigned cols)
+{
+    unsigned j = 0;
+
+    // Four rows at a time, sharing every load of x
+    for (; j + 4 <= rows; j += 4) {
+        const double* w0 = w + (unsigned long) j * cols;
+        const double* w1 = w0 + cols;
+        const double* w2 = w1 + cols;
+        const double* w3 = w2 + cols;
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        __m256d acc2 = _mm256_setzero_pd();
+        __m256d acc3 = _mm256_setzero_pd();
+        unsigned i = 0;
+
+        for (; i + 4 <= cols; i += 4) {
+            __m256d xi = _mm256_loadu_pd(x + i);
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(w0 + i), xi, acc0);
+            acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(w1 + i), xi, acc1);
+            acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(w2 + i), xi, acc2);
+            acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(w3 + i), xi, acc3);
+        }
+
+        double tail[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (; i < cols; ++i) {
+            tail[0] += x[i] * w0[i];
+            tail[1] += x[i] * w1[i];
+            tail[2] += x[i] * w2[i];
+            tail[3] += x[i] * w3[i];
+        }
+        _mm256_storeu_pd(y + j,
+                         _mm256_add_pd(Sum4Avx2(acc0, acc1, acc2, acc3),
+                                       _mm256_loadu_pd(tail)));
+    }
+
+    for (; j < rows; ++j) {
+        y[j] = DotAvx2(w + (unsigned long) j * cols, x, cols);
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+GemmNTAvx2(const double* a, const double* b, double* c,
+           unsigned m, unsigned n, unsigned k,
+           unsigned lda, unsigned ldc)
+{
+    unsigned r = 0;
+
+    /* Two rows of A against four rows of B at a time: every load is
+     * used by two or four multiply-adds */
+    for (; r + 2 <= m; r += 2) {
+        const double* a0 = a + (unsigned long) r * lda;
+        const double* a1 = a0 + lda;
+        double* c0 = c + (unsigned long) r * ldc;
+        double* c1 = c0 + ldc;
+        unsigned j = 0;
+
+        for (; j + 4 <= n; j += 4) {
+            const double* b0 = b + (unsigned long) j * k;
+            const double* b1 = b0 + k;
+            const double* b2 = b1 + k;
+            const double* b3 = b2 + k;
+            __m256d acc00 = _mm256_setzero_pd();
+            __m256d acc01 = _mm256_setzero_pd();
+            __m256d acc02 = _mm256_setzero_pd();
+            __m256d acc03 = _mm256_setzero_pd();
+            __m256d acc10 = _mm256_setzero_pd();
+            __m256d acc11 = _mm256_setzero_pd();
+            __m256d acc12 = _mm256_setzero_pd();
+            __m256d acc13 = _mm256_setzero_pd();
+            unsigned i = 0;
+
+            for (; i + 4 <= k; i += 4) {
+                __m256d x0 = _mm256_loadu_pd(a0 + i);
+                __m256d x1 = _mm256_loadu_pd(a1 + i);
+                __m256d wi;
+
+                wi = _mm256_loadu_pd(b0 + i);
+                acc00 = _mm256_fmadd_pd(x0, wi, acc00);
+                acc10 = _mm256_fmadd_pd(x1, wi, acc10);
+                wi = _mm256_loadu_pd(b1 + i);
+                acc01 = _mm256_fmadd_pd(x0, wi, acc01);
+                acc11 = _mm256_fmadd_pd(x1, wi, acc11);
+                wi = _mm256_loadu_pd(b2 + i);
+                acc02 = _mm256_fmadd_pd(x0, wi, acc02);
+                acc12 = _mm256_fmadd_pd(x1, wi, acc12);
+                wi = _mm256_loadu_pd(b3 + i);
+                acc03 = _mm256_fmadd_pd(x0, wi, acc03);
+                acc13 = _mm256_fmadd_pd(x1, wi, acc13);
+            }
+
+            double tail0[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            double tail1[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (; i < k; ++i) {
+                tail0[0] += a0[i] * b0[i];
+                tail0[1] += a0[i] * b1[i];
+                tail0[2] += a0[i] * b2[i];
+                tail0[3] += a0[i] * b3[i];
+                tail1[0] += a1[i] * b0[i];
+                tail1[1] += a1[i] * b1[i];
+                tail1[2] += a1[i] * b2[i];
+                tail1[3] += a1[i] * b3[i];
+            }
+            _mm256_storeu_pd(c0 + j,
+                    _mm256_add_pd(Sum4Avx2(acc00, acc01, acc02, acc03),
+                                  _mm256_loadu_pd(tail0)));
+            _mm256_storeu_pd(c1 + j,
+                    _mm256_add_pd(Sum4Avx2(acc10, acc11, acc12, acc13),
+                                  _mm256_loadu_pd(tail1)));
+        }
+
+        for (; j < n; ++j) {
+            c0[j] = DotAvx2(a0, b + (unsigned long) j * k, k);
+            c1[j] = DotAvx2(a1, b + (unsigned long) j * k, k);
+        }
+    }
+
+    for (; r < m; ++r) {
+        MatVecAvx2(b, a + (unsigned long) r * lda,
+                   c + (unsigned long) r * ldc, n, k);
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+MatTVecAvx2(const double* w, const double* g, double* y,
+            unsigned rows, unsigned cols, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        y[i] = 0.0f;
+    }
+
+    for (unsigned j = 0; j < rows; ++j) {
+        const double* row = w + (unsigned long) j * cols;
+        __m256d gradient = _mm256_set1_pd(g[j]);
+        unsigned i = 0;
+
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(y + i,
+                             _mm256_fmadd_pd(_mm256_loadu_pd(row + i),
+                                             gradient,
+                                             _mm256_loadu_pd(y + i)));
+        }
+        for (; i < n; ++i) {
+            y[i] += row[i] * g[j];
+        }
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+MomentumUpdateAvx2(double* w, double* dw,
+                   const double* x, const double* g,
+                   unsigned rows, unsigned cols,
+                   double eta, double alpha)
+{
+    __m256d alpha_v = _mm256_set1_pd(alpha);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        double* row = w + (unsigned long) j * cols;
+        double* delta_row = dw + (unsigned long) j * cols;
+        double eta_gradient = eta * g[j];
+        __m256d eta_gradient_v = _mm256_set1_pd(eta_gradient);
+        unsigned i = 0;
+
+        for (; i + 4 <= cols; i += 4) {
+            __m256d delta = _mm256_fmadd_pd(
+                    eta_gradient_v, _mm256_loadu_pd(x + i),
+                    _mm256_mul_pd(alpha_v, _mm256_loadu_pd(delta_row + i)));
+            _mm256_storeu_pd(delta_row + i, delta);
+            _mm256_storeu_pd(row + i,
+                             _mm256_add_pd(_mm256_loadu_pd(row + i), delta));
+        }
+        for (; i < cols; ++i) {
+            delta_row[i] = eta_gradient * x[i] + alpha * delta_row[i];
+            row[i] += delta_row[i];
+        }
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+inline float
+SumAvx2(__m256 v)
+{
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(v),
+                             _mm256_extractf128_ps(v, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    return _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+}
+
+
+__attribute__((target("avx2,fma")))
+inline float
+DotAvx2(const float* a, const float* b, unsigned k)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    unsigned i = 0;
+
+    for (; i + 16 <= k; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+                               _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8),
+                               _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= k; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+                               _mm256_loadu_ps(b + i), acc0);
+    }
+
+    float sum = SumAvx2(_mm256_add_ps(acc0, acc1));
+    for (; i < k; ++i) {
+        sum += a[i] * b[i];
+    }
+
+    return sum;
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+MatVecAvx2(const float* w, const float* x, float* y,
+           unsigned rows, unsigned cols)
+{
+    unsigned j = 0;
+
+    // Four rows at a time, sharing every load of x
+    for (; j + 4 <= rows; j += 4) {
+        const float* w0 = w + (unsigned long) j * cols;
+        const float* w1 = w0 + cols;
+        const float* w2 = w1 + cols;
+        const float* w3 = w2 + cols;
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps();
+        __m256 acc3 = _mm256_setzero_ps();
+        unsigned i = 0;
+
+        for (; i + 8 <= cols; i += 8) {
+            __m256 xi = _mm256_loadu_ps(x + i);
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(w0 + i), xi, acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(w1 + i), xi, acc1);
+            acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(w2 + i), xi, acc2);
+            acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(w3 + i), xi, acc3);
+        }
+
+        float tail[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (; i < cols; ++i) {
+            tail[0] += x[i] * w0[i];
+            tail[1] += x[i] * w1[i];
+            tail[2] += x[i] * w2[i];
+            tail[3] += x[i] * w3[i];
+        }
+        y[j] = SumAvx2(acc0) + tail[0];
+        y[j + 1] = SumAvx2(acc1) + tail[1];
+        y[j + 2] = SumAvx2(acc2) + tail[2];
+        y[j + 3] = SumAvx2(acc3) + tail[3];
+    }
+
+    for (; j < rows; ++j) {
+        y[j] = DotAvx2(w + (unsigned long) j * cols, x, cols);
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+GemmNTAvx2(const float* a, const float* b, float* c,
+           unsigned m, unsigned n, unsigned k,
+           unsigned lda, unsigned ldc)
+{
+    for (unsigned r = 0; r < m; ++r) {
+        MatVecAvx2(b, a + (unsigned long) r * lda,
+                   c + (unsigned long) r * ldc, n, k);
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+MatTVecAvx2(const float* w, const float* g, float* y,
+            unsigned rows, unsigned cols, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        y[i] = 0.0f;
+    }
+
+    for (unsigned j = 0; j < rows; ++j) {
+        const float* row = w + (unsigned long) j * cols;
+        __m256 gradient = _mm256_set1_ps(g[j]);
+        unsigned i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(y + i,
+                             _mm256_fmadd_ps(_mm256_loadu_ps(row + i),
+                                             gradient,
+                                             _mm256_loadu_ps(y + i)));
+        }
+        for (; i < n; ++i) {
+            y[i] += row[i] * g[j];
+        }
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+MomentumUpdateAvx2(float* w, float* dw,
+                   const float* x, const float* g,
+                   unsigned rows, unsigned cols,
+                   float eta, float alpha)
+{
+    __m256 alpha_v = _mm256_set1_ps(alpha);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        float* row = w + (unsigned long) j * cols;
+        float* delta_row = dw + (unsigned long) j * cols;
+        float eta_gradient = eta * g[j];
+        __m256 eta_gradient_v = _mm256_set1_ps(eta_gradient);
+        unsigned i = 0;
+
+        for (; i + 8 <= cols; i += 8) {
+            __m256 delta = _mm256_fmadd_ps(
+                    eta_gradient_v, _mm256_loadu_ps(x + i),
+                    _mm256_mul_ps(alpha_v, _mm256_loadu_ps(delta_row + i)));
+            _mm256_storeu_ps(delta_row + i, delta);
+            _mm256_storeu_ps(row + i,
+                             _mm256_add_ps(_mm256_loadu_ps(row + i), delta));
+        }
+        for (; i < cols; ++i) {
+            delta_row[i] = eta_gradient * x[i] + alpha * delta_row[i];
+            row[i] += delta_row[i];
+        }
+    }
+}
+
+
+
+__attribute__((target("avx2,fma")))
+void
+NesterovUpdateAvx2(double* w, double* dw,
+                   const double* x, const double* g,
+                   unsigned rows, unsigned cols,
+                   double eta, double alpha)
+{
+    __m256d alpha_v = _mm256_set1_pd(alpha);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        double* row = w + (unsigned long) j * cols;
+        double* delta_row = dw + (unsigned long) j * cols;
+        double eta_gradient = eta * g[j];
+        __m256d eta_gradient_v = _mm256_set1_pd(eta_gradient);
+        unsigned i = 0;
+
+        for (; i + 4 <= cols; i += 4) {
+            __m256d step = _mm256_mul_pd(eta_gradient_v,
+                                         _mm256_loadu_pd(x + i));
+            __m256d delta = _mm256_fmadd_pd(
+                    alpha_v, _mm256_loadu_pd(delta_row + i), step);
+            _mm256_storeu_pd(delta_row + i, delta);
+            _mm256_storeu_pd(row + i,
+                             _mm256_add_pd(_mm256_loadu_pd(row + i),
+                                           _mm256_fmadd_pd(alpha_v, delta,
+                                                           step)));
+        }
+        for (; i < cols; ++i) {
+            NesterovStep(row[i], delta_row[i], eta_gradient * x[i], alpha);
+        }
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+NesterovUpdateAvx2(float* w, float* dw,
+                   const float* x, const float* g,
+                   unsigned rows, unsigned cols,
+                   float eta, float alpha)
+{
+    __m256 alpha_v = _mm256_set1_ps(alpha);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        float* row = w + (unsigned long) j * cols;
+        float* delta_row = dw + (unsigned long) j * cols;
+        float eta_gradient = eta * g[j];
+        __m256 eta_gradient_v = _mm256_set1_ps(eta_gradient);
+        unsigned i = 0;
+
+        for (; i + 8 <= cols; i += 8) {
+            __m256 step = _mm256_mul_ps(eta_gradient_v,
+                                        _mm256_loadu_ps(x + i));
+            __m256 delta = _mm256_fmadd_ps(
+                    alpha_v, _mm256_loadu_ps(delta_row + i), step);
+            _mm256_storeu_ps(delta_row + i, delta);
+            _mm256_storeu_ps(row + i,
+                             _mm256_add_ps(_mm256_loadu_ps(row + i),
+                                           _mm256_fmadd_ps(alpha_v, delta,
+                                                           step)));
+        }
+        for (; i < cols; ++i) {
+            NesterovStep(row[i], delta_row[i], eta_gradient * x[i], alpha);
+        }
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+RmsPropUpdateAvx2(double* w, double* s, const double* x, const double* g,
+                  unsigned rows, unsigned cols,
+                  double eta, double rho, double epsilon)
+{
+    __m256d eta_v = _mm256_set1_pd(eta);
+    __m256d rho_v = _mm256_set1_pd(rho);
+    __m256d one_minus_rho_v = _mm256_set1_pd(1.0f - rho);
+    __m256d epsilon_v = _mm256_set1_pd(epsilon);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        double* row = w + (unsigned long) j * cols;
+        double* square_row = s + (unsigned long) j * cols;
+        __m256d g_v = _mm256_set1_pd(g[j]);
+        unsigned i = 0;
+
+        for (; i + 4 <= cols; i += 4) {
+            __m256d d = _mm256_mul_pd(g_v, _mm256_loadu_pd(x + i));
+            __m256d square = _mm256_fmadd_pd(
+                    one_minus_rho_v, _mm256_mul_pd(d, d),
+                    _mm256_mul_pd(rho_v, _mm256_loadu_pd(square_row + i)));
+            __m256d scale = _mm256_div_pd(
+                    eta_v, _mm256_add_pd(_mm256_sqrt_pd(square), epsilon_v));
+            _mm256_storeu_pd(square_row + i, square);
+            _mm256_storeu_pd(row + i,
+                             _mm256_fmadd_pd(scale, d,
+                                             _mm256_loadu_pd(row + i)));
+        }
+        for (; i < cols; ++i) {
+            RmsPropStep(row[i], square_row[i], g[j] * x[i],
+                        eta, rho, epsilon);
+        }
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+RmsPropUpdateAvx2(float* w, float* s, const float* x, const float* g,
+                  unsigned rows, unsigned cols,
+                  float eta, float rho, float epsilon)
+{
+    __m256 eta_v = _mm256_set1_ps(eta);
+    __m256 rho_v = _mm256_set1_ps(rho);
+    __m256 one_minus_rho_v = _mm256_set1_ps(1.0f - rho);
+    __m256 epsilon_v = _mm256_set1_ps(epsilon);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        float* row = w + (unsigned long) j * cols;
+        float* square_row = s + (unsigned long) j * cols;
+        __m256 g_v = _mm256_set1_ps(g[j]);
+        unsigned i = 0;
+
+        for (; i + 8 <= cols; i += 8) {
+            __m256 d = _mm256_mul_ps(g_v, _mm256_loadu_ps(x + i));
+            __m256 square = _mm256_fmadd_ps(
+                    one_minus_rho_v, _mm256_mul_ps(d, d),
+                    _mm256_mul_ps(rho_v, _mm256_loadu_ps(square_row + i)));
+            __m256 scale = _mm256_div_ps(
+                    eta_v, _mm256_add_ps(_mm256_sqrt_ps(square), epsilon_v));
+            _mm256_storeu_ps(square_row + i, square);
+            _mm256_storeu_ps(row + i,
+                             _mm256_fmadd_ps(scale, d,
+                                             _mm256_loadu_ps(row + i)));
+        }
+        for (; i < cols; ++i) {
+            RmsPropStep(row[i], square_row[i], g[j] * x[i],
+                        eta, rho, epsilon);
+        }
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+AdamUpdateAvx2(double* w, double* m, double* v,
+               const double* x, const double* g,
+               unsigned rows, unsigned cols,
+               double eta, double beta1, double beta2, double epsilon)
+{
+    __m256d eta_v = _mm256_set1_pd(eta);
+    __m256d beta1_v = _mm256_set1_pd(beta1);
+    __m256d one_minus_beta1_v = _mm256_set1_pd(1.0f - beta1);
+    __m256d beta2_v = _mm256_set1_pd(beta2);
+    __m256d one_minus_beta2_v = _mm256_set1_pd(1.0f - beta2);
+    __m256d epsilon_v = _mm256_set1_pd(epsilon);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        unsigned long first = (unsigned long) j * cols;
+        __m256d g_v = _mm256_set1_pd(g[j]);
+        unsigned i = 0;
+
+        for (; i + 4 <= cols; i += 4) {
+            __m256d d = _mm256_mul_pd(g_v, _mm256_loadu_pd(x + i));
+            __m256d mean = _mm256_fmadd_pd(
+                    one_minus_beta1_v, d,
+                    _mm256_mul_pd(beta1_v, _mm256_loadu_pd(m + first + i)));
+            __m256d square = _mm256_fmadd_pd(
+                    one_minus_beta2_v, _mm256_mul_pd(d, d),
+                    _mm256_mul_pd(beta2_v, _mm256_loadu_pd(v + first + i)));
+            __m256d scale = _mm256_div_pd(
+                    eta_v, _mm256_add_pd(_mm256_sqrt_pd(square), epsilon_v));
+            _mm256_storeu_pd(m + first + i, mean);
+            _mm256_storeu_pd(v + first + i, square);
+            _mm256_storeu_pd(w + first + i,
+                             _mm256_fmadd_pd(scale, mean,
+                                             _mm256_loadu_pd(w + first + i)));
+        }
+        for (; i < cols; ++i) {
+            AdamStep(w[first + i], m[first + i], v[first + i],
+                     g[j] * x[i], eta, beta1, beta2, epsilon);
+        }
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+AdamUpdateAvx2(float* w, float* m, float* v,
+               const float* x, const float* g,
+               unsigned rows, unsigned cols,
+               float eta, float beta1, float beta2, float epsilon)
+{
+    __m256 eta_v = _mm256_set1_ps(eta);
+    __m256 beta1_v = _mm256_set1_ps(beta1);
+    __m256 one_minus_beta1_v = _mm256_set1_ps(1.0f - beta1);
+    __m256 beta2_v = _mm256_set1_ps(beta2);
+    __m256 one_minus_beta2_v = _mm256_set1_ps(1.0f - beta2);
+    __m256 epsilon_v = _mm256_set1_ps(epsilon);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        unsigned long first = (unsigned long) j * cols;
+        __m256 g_v = _mm256_set1_ps(g[j]);
+        unsigned i = 0;
+
+        for (; i + 8 <= cols; i += 8) {
+            __m256 d = _mm256_mul_ps(g_v, _mm256_loadu_ps(x + i));
+            __m256 mean = _mm256_fmadd_ps(
+                    one_minus_beta1_v, d,
+                    _mm256_mul_ps(beta1_v, _mm256_loadu_ps(m + first + i)));
+            __m256 square = _mm256_fmadd_ps(
+                    one_minus_beta2_v, _mm256_mul_ps(d, d),
+                    _mm256_mul_ps(beta2_v, _mm256_loadu_ps(v + first + i)));
+            __m256 scale = _mm256_div_ps(
+                    eta_v, _mm256_add_ps(_mm256_sqrt_ps(square), epsilon_v));
+            _mm256_storeu_ps(m + first + i, mean);
+            _mm256_storeu_ps(v + first + i, square);
+            _mm256_storeu_ps(w + first + i,
+                             _mm256_fmadd_ps(scale, mean,
+                                             _mm256_loadu_ps(w + first + i)));
+        }
+        for (; i < cols; ++i) {
+            AdamStep(w[first + i], m[first + i], v[first + i],
+                     g[j] * x[i], eta, beta1, beta2, epsilon);
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+inline int32_t
+SumAvx2(__m256i v)
+{
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(v),
+                                 _mm256_extracti128_si256(v, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4e));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xb1));
+    return _mm_cvtsi128_si32(half);
+}
+
+
+// Sixteen bytes sign-extended to 16 bits
+__attribute__((target("avx2,fma")))
+inline __m256i
+WidenAvx2(const int8_t* p)
+{
+    return _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*) p));
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+MatVecAvx2(const int8_t* w, const int8_t* x, int32_t* y,
+           unsigned rows, unsigned cols)
+{
+    unsigned j = 0;
+
+    // Four rows at a time, sharing every load of x
+    for (; j + 4 <= rows; j += 4) {
+        const int8_t* w0 = w + (unsigned long) j * cols;
+        const int8_t* w1 = w0 + cols;
+        const int8_t* w2 = w1 + cols;
+        const int8_t* w3 = w2 + cols;
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+        __m256i acc2 = _mm256_setzero_si256();
+        __m256i acc3 = _mm256_setzero_si256();
+        unsigned i = 0;
+
+        for (; i + 16 <= cols; i += 16) {
+            __m256i xi = WidenAvx2(x + i);
+            acc0 = _mm256_add_epi32(acc0,
+                                    _mm256_madd_epi16(WidenAvx2(w0 + i), xi));
+            acc1 = _mm256_add_epi32(acc1,
+                                    _mm256_madd_epi16(WidenAvx2(w1 + i), xi));
+            acc2 = _mm256_add_epi32(acc2,
+                                    _mm256_madd_epi16(WidenAvx2(w2 + i), xi));
+            acc3 = _mm256_add_epi32(acc3,
+                                    _mm256_madd_epi16(WidenAvx2(w3 + i), xi));
+        }
+
+        int32_t tail[4] = {0, 0, 0, 0};
+        for (; i < cols; ++i) {
+            tail[0] += (int32_t) x[i] * w0[i];
+            tail[1] += (int32_t) x[i] * w1[i];
+            tail[2] += (int32_t) x[i] * w2[i];
+            tail[3] += (int32_t) x[i] * w3[i];
+        }
+        y[j] = SumAvx2(acc0) + tail[0];
+        y[j + 1] = SumAvx2(acc1) + tail[1];
+        y[j + 2] = SumAvx2(acc2) + tail[2];
+        y[j + 3] = SumAvx2(acc3) + tail[3];
+    }
+
+    if (j < rows) {
+        MatVecScalar(w + (unsigned long) j * cols, x, y + j, rows - j, cols);
+    }
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+FastTanhAvx2(double* x, unsigned n)
+{
+    __m256d clamp = _mm256_set1_pd(kTanhClamp);
+    __m256d neg_clamp = _mm256_set1_pd(-kTanhClamp);
+    unsigned i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_min_pd(_mm256_max_pd(_mm256_loadu_pd(x + i),
+                                                neg_clamp),
+                                  clamp);
+        __m256d v2 = _mm256_mul_pd(v, v);
+        __m256d p = _mm256_set1_pd(kTanhP[0]);
+        __m256d q = _mm256_set1_pd(kTanhQ[0]);
+
+        for (unsigned c = 1; c < 7; ++c) {
+            p = _mm256_fmadd_pd(p, v2, _mm256_set1_pd(kTanhP[c]));
+        }
+        for (unsigned c = 1; c < 4; ++c) {
+            q = _mm256_fmadd_pd(q, v2, _mm256_set1_pd(kTanhQ[c]));
+        }
+        _mm256_storeu_pd(x + i, _mm256_div_pd(_mm256_mul_pd(v, p), q));
+    }
+    FastTanhScalar(x + i, n - i);
+}
+
+
+__attribute__((target("avx2,fma")))
+void
+FastTanhAvx2(float* x, unsigned n)
+{
+    __m256 clamp = _mm256_set1_ps((float) kTanhClamp);
+    __m256 neg_clamp = _mm256_set1_ps((float) -kTanhClamp);
+    unsigned i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(x + i),
+                                               neg_clamp),
+                                 clamp);
+        __m256 v2 = _mm256_mul_ps(v, v);
+        __m256 p = _mm256_set1_ps((float) kTanhP[0]);
+        __m256 q = _mm256_set1_ps((float) kTanhQ[0]);
+
+        for (unsigned c = 1; c < 7; ++c) {
+            p = _mm256_fmadd_ps(p, v2, _mm256_set1_ps((float) kTanhP[c]));
+        }
+        for (unsigned c = 1; c < 4; ++c) {
+            q = _mm256_fmadd_ps(q, v2, _mm256_set1_ps((float) kTanhQ[c]));
+        }
+        _mm256_storeu_ps(x + i, _mm256_div_ps(_mm256_mul_ps(v, p), q));
+    }
+    FastTanhScalar(x + i, n - i);
+}
+
+
+// AVX-512 ------------------------------------------------------------
+__attribute__((target("avx512f")))
+inline double
+SumAvx512(__m512d v)
+{
+    double lanes[8];
+
+    _mm512_storeu_pd(lanes, v);
+    return ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) +
+           ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+}
+
+
+__attribute__((target("avx512f")))
+inline __mmask8
+TailMaskAvx512(unsigned remaining)
+{
+    return remaining >= 8
+        ? (__mmask8) 0xff
+        : (__mmask8) ((1u << remaining) - 1);
+}
+
+
+__attribute__((target("avx512f")))
+inline double
+DotAvx512(const double* a, const double* b, unsigned k)
+{
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    unsigned i = 0;
+
+    for (; i + 16 <= k; i += 16) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i),
+                               _mm512_loadu_pd(b + i), acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8),
+                               _mm512_loadu_pd(b + i + 8), acc1);
+    }
+    for (; i < k; i += 8) {
+        __mmask8 mask = TailMaskAvx512(k - i);
+        acc0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a + i),
+                               _mm512_maskz_loadu_pd(mask, b + i), acc0);
+    }
+
+    return SumAvx512(_mm512_add_pd(acc0, acc1));
+}
+
+
+__attribute__((target("avx512f")))
+void
+MatVecAvx512(const double* w, const double* x, double* y,
+             unsigned rows, unsigned cols)
+{
+    unsigned j = 0;
+
+    // Four rows at a time, sharing every load of x
+    for (; j + 4 <= rows; j += 4) {
+        const double* w0 = w + (unsigned long) j * cols;
+        const double* w1 = w0 + cols;
+        const double* w2 = w1 + cols;
+        const double* w3 = w2 + cols;
+        __m512d acc0 = _mm512_setzero_pd();
+        __m512d acc1 = _mm512_setzero_pd();
+        __m512d acc2 = _mm512_setzero_pd();
+        __m512d acc3 = _mm512_setzero_pd();
+
+        for (unsigned i = 0; i < cols; i += 8) {
+            __mmask8 mask = TailMaskAvx512(cols - i);
+            __m512d xi = _mm512_maskz_loadu_pd(mask, x + i);
+            acc0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, w0 + i),
+                                   xi, acc0);
+            acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, w1 + i),
+                                   xi, acc1);
+            acc2 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, w2 + i),
+                                   xi, acc2);
+            acc3 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, w3 + i),
+                                   xi, acc3);
+        }
+        y[j] = SumAvx512(acc0);
+        y[j + 1] = SumAvx512(acc1);
+        y[j + 2] = SumAvx512(acc2);
+        y[j + 3] = SumAvx512(acc3);
+    }
+
+    for (; j < rows; ++j) {
+        y[j] = DotAvx512(w + (unsigned long) j * cols, x, cols);
+    }
+}
+
+
+__attribute__((target("avx512f")))
+void
+GemmNTAvx512(const double* a, const double* b, double* c,
+             unsigned m, unsigned n, unsigned k,
+             unsigned lda, unsigned ldc)
+{
+    unsigned r = 0;
+
+    /* Two rows of A against four rows of B at a time: every load is
+     * used by two or four multiply-adds */
+    for (; r + 2 <= m; r += 2) {
+        const double* a0 = a + (unsigned long) r * lda;
+        const double* a1 = a0 + lda;
+        double* c0 = c + (unsigned long) r * ldc;
+        double* c1 = c0 + ldc;
+        unsigned j = 0;
+
+        for (; j + 4 <= n; j += 4) {
+            const double* b0 = b + (unsigned long) j * k;
+            const double* b1 = b0 + k;
+            const double* b2 = b1 + k;
+            const double* b3 = b2 + k;
+            __m512d acc00 = _mm512_setzero_pd();
+            __m512d acc01 = _mm512_setzero_pd();
+            __m512d acc02 = _mm512_setzero_pd();
+            __m512d acc03 = _mm512_setzero_pd();
+            __m512d acc10 = _mm512_setzero_pd();
+            __m512d acc11 = _mm512_setzero_pd();
+            __m512d acc12 = _mm512_setzero_pd();
+            __m512d acc13 = _mm512_setzero_pd();
+
+            for (unsigned i = 0; i < k; i += 8) {
+                __mmask8 mask = TailMaskAvx512(k - i);
+                __m512d x0 = _mm512_maskz_loadu_pd(mask, a0 + i);
+                __m512d x1 = _mm512_maskz_loadu_pd(mask, a1 + i);
+                __m512d wi;
+
+                wi = _mm512_maskz_loadu_pd(mask, b0 + i);
+                acc00 = _mm512_fmadd_pd(x0, wi, acc00);
+                acc10 = _mm512_fmadd_pd(x1, wi, acc10);
+                wi = _mm512_maskz_loadu_pd(mask, b1 + i);
+                acc01 = _mm512_fmadd_pd(x0, wi, acc01);
+                acc11 = _mm512_fmadd_pd(x1, wi, acc11);
+                wi = _mm512_maskz_loadu_pd(mask, b2 + i);
+                acc02 = _mm512_fmadd_pd(x0, wi, acc02);
+                acc12 = _mm512_fmadd_pd(x1, wi, acc12);
+                wi = _mm512_maskz_loadu_pd(mask, b3 + i);
+                acc03 = _mm512_fmadd_pd(x0, wi, acc03);
+                acc13 = _mm512_fmadd_pd(x1, wi, acc13);
+            }
+            c0[j] = SumAvx512(acc00);
+            c0[j + 1] = SumAvx512(acc01);
+            c0[j + 2] = SumAvx512(acc02);
+            c0[j + 3] = SumAvx512(acc03);
+            c1[j] = SumAvx512(acc10);
+            c1[j + 1] = SumAvx512(acc11);
+            c1[j + 2] = SumAvx512(acc12);
+            c1[j + 3] = SumAvx512(acc13);
+        }
+
+        for (; j < n; ++j) {
+            c0[j] = DotAvx512(a0, b + (unsigned long) j * k, k);
+            c1[j] = DotAvx512(a1, b + (unsigned long) j * k, k);
+        }
+    }
+
+    for (; r < m; ++r) {
+        MatVecAvx512(b, a + (unsigned long) r * lda,
+                     c + (unsigned long) r * ldc, n, k);
+    }
+}
+
+
+__attribute__((target("avx512f")))
+void
+MatTVecAvx512(const double* w, const double* g, double* y,
+              unsigned rows, unsigned cols, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        y[i] = 0.0f;
+    }
+
+    for (unsigned j = 0; j < rows; ++j) {
+        const double* row = w + (unsigned long) j * cols;
+        __m512d gradient = _mm512_set1_pd(g[j]);
+        unsigned i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            _mm512_storeu_pd(y + i,
+                             _mm512_fmadd_pd(_mm512_loadu_pd(row + i),
+                                             gradient,
+                                             _mm512_loadu_pd(y + i)));
+        }
+        if (i < n) {
+            __mmask8 tail = (__mmask8) ((1u << (n - i)) - 1);
+            __m512d acc = _mm512_fmadd_pd(
+                    _mm512_maskz_loadu_pd(tail, row + i), gradient,
+                    _mm512_maskz_loadu_pd(tail, y + i));
+            _mm512_mask_storeu_pd(y + i, tail, acc);
+        }
+    }
+}
+
+
+__attribute__((target("avx512f")))
+void
+MomentumUpdateAvx512(double* w, double* dw,
+                     const double* x, const double* g,
+                     unsigned rows, unsigned cols,
+                     double eta, double alpha)
+{
+    __m512d alpha_v = _mm512_set1_pd(alpha);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        double* row = w + (unsigned long) j * cols;
+        double* delta_row = dw + (unsigned long) j * cols;
+        __m512d eta_gradient_v = _mm512_set1_pd(eta * g[j]);
+        unsigned i = 0;
+
+        for (; i < cols; i += 8) {
+            __mmask8 mask = TailMaskAvx512(cols - i);
+            __m512d delta = _mm512_fmadd_pd(
+                    eta_gradient_v, _mm512_maskz_loadu_pd(mask, x + i),
+                    _mm512_mul_pd(alpha_v,
+                                  _mm512_maskz_loadu_pd(mask,
+                                                        delta_row + i)));
+            _mm512_mask_storeu_pd(delta_row + i, mask, delta);
+            _mm512_mask_storeu_pd(
+                    row + i, mask,
+                    _mm512_add_pd(_mm512_maskz_loadu_pd(mask, row + i),
+                                  delta));
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+inline float
+SumAvx512(__m512 v)
+{
+    float lanes[16];
+
+    _mm512_storeu_ps(lanes, v);
+    for (unsigned width = 8; width > 0; width /= 2) {
+        for (unsigned i = 0; i < width; ++i) {
+            lanes[i] += lanes[i + width];
+        }
+    }
+    return lanes[0];
+}
+
+
+__attribute__((target("avx512f")))
+inline __mmask16
+TailMask16Avx512(unsigned remaining)
+{
+    return remaining >= 16
+        ? (__mmask16) 0xffff
+        : (__mmask16) ((1u << remaining) - 1);
+}
+
+
+__attribute__((target("avx512f")))
+inline float
+DotAvx512(const float* a, const float* b, unsigned k)
+{
+    __m512 acc = _mm512_setzero_ps();
+
+    for (unsigned i = 0; i < k; i += 16) {
+        __mmask16 mask = TailMask16Avx512(k - i);
+        acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                              _mm512_maskz_loadu_ps(mask, b + i), acc);
+    }
+
+    return SumAvx512(acc);
+}
+
+
+__attribute__((target("avx512f")))
+void
+MatVecAvx512(const float* w, const float* x, float* y,
+             unsigned rows, unsigned cols)
+{
+    unsigned j = 0;
+
+    // Four rows at a time, sharing every load of x
+    for (; j + 4 <= rows; j += 4) {
+        const float* w0 = w + (unsigned long) j * cols;
+        const float* w1 = w0 + cols;
+        const float* w2 = w1 + cols;
+        const float* w3 = w2 + cols;
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+        __m512 acc2 = _mm512_setzero_ps();
+        __m512 acc3 = _mm512_setzero_ps();
+
+        for (unsigned i = 0; i < cols; i += 16) {
+            __mmask16 mask = TailMask16Avx512(cols - i);
+            __m512 xi = _mm512_maskz_loadu_ps(mask, x + i);
+            acc0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, w0 + i),
+                                   xi, acc0);
+            acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, w1 + i),
+                                   xi, acc1);
+            acc2 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, w2 + i),
+                                   xi, acc2);
+            acc3 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, w3 + i),
+                                   xi, acc3);
+        }
+        y[j] = SumAvx512(acc0);
+        y[j + 1] = SumAvx512(acc1);
+        y[j + 2] = SumAvx512(acc2);
+        y[j + 3] = SumAvx512(acc3);
+    }
+
+    for (; j < rows; ++j) {
+        y[j] = DotAvx512(w + (unsigned long) j * cols, x, cols);
+    }
+}
+
+
+__attribute__((target("avx512f")))
+void
+GemmNTAvx512(const float* a, const float* b, float* c,
+             unsigned m, unsigned n, unsigned k,
+             unsigned lda, unsigned ldc)
+{
+    for (unsigned r = 0; r < m; ++r) {
+        MatVecAvx512(b, a + (unsigned long) r * lda,
+                     c + (unsigned long) r * ldc, n, k);
+    }
+}
+
+
+__attribute__((target("avx512f")))
+void
+MatTVecAvx512(const float* w, const float* g, float* y,
+              unsigned rows, unsigned cols, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        y[i] = 0.0f;
+    }
+
+    for (unsigned j = 0; j < rows; ++j) {
+        const float* row = w + (unsigned long) j * cols;
+        __m512 gradient = _mm512_set1_ps(g[j]);
+
+        for (unsigned i = 0; i < n; i += 16) {
+            __mmask16 mask = TailMask16Avx512(n - i);
+            __m512 acc = _mm512_fmadd_ps(
+                    _mm512_maskz_loadu_ps(mask, row + i), gradient,
+                    _mm512_maskz_loadu_ps(mask, y + i));
+            _mm512_mask_storeu_ps(y + i, mask, acc);
+        }
+    }
+}
+
+
+__attribute__((target("avx512f")))
+void
+MomentumUpdateAvx512(float* w, float* dw,
+                     const float* x, const float* g,
+                     unsigned rows, unsigned cols,
+                     float eta, float alpha)
+{
+    __m512 alpha_v = _mm512_set1_ps(alpha);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        float* row = w + (unsigned long) j * cols;
+        float* delta_row = dw + (unsigned long) j * cols;
+        __m512 eta_gradient_v = _mm512_set1_ps(eta * g[j]);
+
+        for (unsigned i = 0; i < cols; i += 16) {
+            __mmask16 mask = TailMask16Avx512(cols - i);
+            __m512 delta = _mm512_fmadd_ps(
+                    eta_gradient_v, _mm512_maskz_loadu_ps(mask, x + i),
+                    _mm512_mul_ps(alpha_v,
+                                  _mm512_maskz_loadu_ps(mask,
+                                                        delta_row + i)));
+            _mm512_mask_storeu_ps(delta_row + i, mask, delta);
+            _mm512_mask_storeu_ps(
+                    row + i, mask,
+                    _mm512_add_ps(_mm512_maskz_loadu_ps(mask, row + i),
+                                  delta));
+        }
+    }
+}
+
+
+__attribute__((target("avx512f")))
+void
+FastTanhAvx512(double* x, unsigned n)
+{
+    __m512d clamp = _mm512_set1_pd(kTanhClamp);
+    __m512d neg_clamp = _mm512_set1_pd(-kTanhClamp);
+
+    for (unsigned i = 0; i < n; i += 8) {
+        __mmask8 mask = TailMaskAvx512(n - i);
+        __m512d v = _mm512_maskz_min_pd(
+                mask, _mm512_maskz_max_pd(
+                        mask, _mm512_maskz_loadu_pd(mask, x + i), neg_clamp),
+                clamp);
+        __m512d v2 = _mm512_mul_pd(v, v);
+        __m512d p = _mm512_set1_pd(kTanhP[0]);
+        __m512d q = _mm512_set1_pd(kTanhQ[0]);
+
+        for (unsigned c = 1; c < 7; ++c) {
+            p = _mm512_fmadd_pd(p, v2, _mm512_set1_pd(kTanhP[c]));
+        }
+        for (unsigned c = 1; c < 4; ++c) {
+            q = _mm512_fmadd_pd(q, v2, _mm512_set1_pd(kTanhQ[c]));
+        }
+        _mm512_mask_storeu_pd(x + i, mask,
+                              _mm512_div_pd(_mm512_mul_pd(v, p), q));
+    }
+}
+
+
+__attribute__((target("avx512f")))
+void
+FastTanhAvx512(float* x, unsigned n)
+{
+    __m512 clamp = _mm512_set1_ps((float) kTanhClamp);
+    __m512 neg_clamp = _mm512_set1_ps((float) -kTanhClamp);
+
+    for (unsigned i = 0; i < n; i += 16) {
+        __mmask16 mask = TailMask16Avx512(n - i);
+        __m512 v = _mm512_maskz_min_ps(
+                mask, _mm512_maskz_max_ps(
+                        mask, _mm512_maskz_loadu_ps(mask, x + i), neg_clamp),
+                clamp);
+        __m512 v2 = _mm512_mul_ps(v, v);
+        __m512 p = _mm512_set1_ps((float) kTanhP[0]);
+        __m512 q = _mm512_set1_ps((float) kTanhQ[0]);
+
+        for (unsigned c = 1; c < 7; ++c) {
+            p = _mm512_fmadd_ps(p, v2, _mm512_set1_ps((float) kTanhP[c]));
+        }
+        for (unsigned c = 1; c < 4; ++c) {
+            q = _mm512_fmadd_ps(q, v2, _mm512_set1_ps((float) kTanhQ[c]));
+        }
+        _mm512_mask_storeu_ps(x + i, mask,
+                              _mm512_div_ps(_mm512_mul_ps(v, p), q));
+    }
+}
+
+
+#endif // MINANN_X86
+
+} // ! namespace
+
+
+// CONSTANTS
+/* Bytes of the right-hand matrix kept hot in cache by the blocked
+ * products (128 KiB, about half a typical L2) */
+static const unsigned kTileBytes = 131072;
+
+Kernels::Isa Kernels::isa_ = Kernels::kScalar;
+Kernels::MatVecFn Kernels::mat_vec_ = MatVecScalar<double>;
+Kernels::MatTVecFn Kernels::mat_t_vec_ = MatTVecScalar<double>;
+Kernels::MomentumUpdateFn Kernels::momentum_update_ =
+    MomentumUpdateScalar<double>;
+Kernels::GemmNTFn Kernels::gemm_nt_ = GemmNTScalar<double>;
+Kernels::MatVecFloatFn Kernels::mat_vec_float_ = MatVecScalar<float>;
+Kernels::MatTVecFloatFn Kernels::mat_t_vec_float_ = MatTVecScalar<float>;
+Kernels::MomentumUpdateFloatFn Kernels::momentum_update_float_ =
+    MomentumUpdateScalar<float>;
+Kernels::GemmNTFloatFn Kernels::gemm_nt_float_ = GemmNTScalar<float>;
+Kernels::MatVecInt8Fn Kernels::mat_vec_int8_ = MatVecScalar;
+Kernels::MomentumUpdateFn Kernels::nesterov_update_ =
+    NesterovUpdateScalar<double>;
+Kernels::RmsPropUpdateFn Kernels::rms_prop_update_ =
+    RmsPropUpdateScalar<double>;
+Kernels::AdamUpdateFn Kernels::adam_update_ = AdamUpdateScalar<double>;
+Kernels::MomentumUpdateFloatFn Kernels::nesterov_update_float_ =
+    NesterovUpdateScalar<float>;
+Kernels::RmsPropUpdateFloatFn Kernels::rms_prop_update_float_ =
+    RmsPropUpdateScalar<float>;
+Kernels::AdamUpdateFloatFn Kernels::adam_update_float_ =
+    AdamUpdateScalar<float>;
+Kernels::TanhMode Kernels::tanh_mode_ = Kernels::kExact;
+Kernels::TanhFn Kernels::tanh_ = TanhScalar<double>;
+Kernels::TanhFloatFn Kernels::tanh_float_ = TanhScalar<float>;
+
+namespace {
+
+// Picks the best instruction set once, before main() runs
+struct AutoSelect {
+    AutoSelect(void)
+    {
+        Kernels::Select(Kernels::Detect());
+    }
+} auto_select;
+
+
+template <typename T, typename GemmNTFn>
+void
+BlockedGemmNT(GemmNTFn gemm_nt, const T* a, const T* b, T* c,
+              unsigned m, unsigned n, unsigned k,
+              unsigned lda, unsigned ldc)
+{
+    /* Every block of rows of B is reused by all the rows of A before
+     * moving on to the next one */
+    unsigned block = std::max(1u, (unsigned) (kTileBytes / sizeof(T)) /
+                                  std::max(1u, k));
+
+    for (unsigned j0 = 0; j0 < n; j0 += block) {
+        unsigned rows = std::min(block, n - j0);
+        const T* b_block = b + (unsigned long) j0 * k;
+
+        gemm_nt(a, b_block, c + j0, m, rows, k, lda, ldc);
+    }
+}
+
+
+template <typename T, typename MatTVecFn>
+void
+BlockedGemmNN(MatTVecFn mat_t_vec, const T* a, const T* b, T* c,
+              unsigned m, unsigned n, unsigned k,
+              unsigned lda, unsigned ldb, unsigned ldc)
+{
+    /* B is split in column panels that fit in cache; every panel is
+     * reused by all the rows of A before moving on to the next one */
+    unsigned block = std::max(8u, (unsigned) (kTileBytes / sizeof(T)) /
+                                  std::max(1u, k)) & ~7u;
+
+    for (unsigned i0 = 0; i0 < n; i0 += block) {
+        unsigned cols = std::min(block, n - i0);
+
+        for (unsigned r = 0; r < m; ++r) {
+            mat_t_vec(b + i0, a + (unsigned long) r * lda,
+                      c + (unsigned long) r * ldc + i0, k, ldb, cols);
+        }
+    }
+}
+
+} // ! namespace
+
+
+// PUBLIC =============================================================
+
+// OPERATIONS ---------------------------------------------------------
+void
+Kernels::GemmNT(const double* a, const double* b, double* c,
+                unsigned m, unsigned n, unsigned k,
+                unsigned lda, unsigned ldc)
+{
+    BlockedGemmNT(gemm_nt_, a, b, c, m, n, k, lda, ldc);
+}
+
+
+void
+Kernels::GemmNT(const float* a, const float* b, float* c,
+                unsigned m, unsigned n, unsigned k,
+                unsigned lda, unsigned ldc)
+{
+    BlockedGemmNT(gemm_nt_float_, a, b, c, m, n, k, lda, ldc);
+}
+
+
+void
+Kernels::GemmNN(const double* a, const double* b, double* c,
+                unsigned m, unsigned n, unsigned k,
+                unsigned lda, unsigned ldb, unsigned ldc)
+{
+    BlockedGemmNN(mat_t_vec_, a, b, c, m, n, k, lda, ldb, ldc);
+}
+
+
+void
+Kernels::GemmNN(const float* a, const float* b, float* c,
+                unsigned m, unsigned n, unsigned k,
+                unsigned lda, unsigned ldb, unsigned ldc)
+{
+    BlockedGemmNN(mat_t_vec_float_, a, b, c, m, n, k, lda, ldb, ldc);
+}
+
+
+// ACCESSORS AND MUTATORS ---------------------------------------------
+Kernels::Isa
+Kernels::Detect(void)
+{
+#ifdef MINANN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return kAvx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return kAvx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return kSse2;
+    }
+#endif
+    return kScalar;
+}
+
+
+void
+Kernels::Select(Isa isa)
+{
+    Isa best = Detect();
+    if (isa > best) {
+        isa = best;
+    }
+
+    switch (isa) {
+#ifdef MINANN_X86
+      case kAvx512:
+        mat_vec_ = MatVecAvx512;
+        mat_t_vec_ = MatTVecAvx512;
+        momentum_update_ = MomentumUpdateAvx512;
+        gemm_nt_ = GemmNTAvx512;
+        mat_vec_float_ = MatVecAvx512;
+        mat_t_vec_float_ = MatTVecAvx512;
+        momentum_update_float_ = MomentumUpdateAvx512;
+        gemm_nt_float_ = GemmNTAvx512;
+        mat_vec_int8_ = MatVecAvx2;   // Widening needs AVX-512BW
+        SelectOptimizersAvx2();       // Bound by memory, not width
+        break;
+      case kAvx2:
+        mat_vec_ = MatVecAvx2;
+        mat_t_vec_ = MatTVecAvx2;
+        momentum_update_ = MomentumUpdateAvx2;
+        gemm_nt_ = GemmNTAvx2;
+        mat_vec_float_ = MatVecAvx2;
+        mat_t_vec_float_ = MatTVecAvx2;
+        momentum_update_float_ = MomentumUpdateAvx2;
+        gemm_nt_float_ = GemmNTAvx2;
+        mat_vec_int8_ = MatVecAvx2;
+        SelectOptimizersAvx2();
+        break;
+      case kSse2:
+        mat_vec_ = MatVecSse2;
+        mat_t_vec_ = MatTVecSse2;
+        momentum_update_ = MomentumUpdateSse2;
+        gemm_nt_ = GemmNTSse2;
+        mat_vec_float_ = MatVecSse2;
+        mat_t_vec_float_ = MatTVecSse2;
+        momentum_update_float_ = MomentumUpdateSse2;
+        gemm_nt_float_ = GemmNTSse2;
+        mat_vec_int8_ = MatVecSse2;
+        SelectOptimizersScalar();     // Vectorized from AVX2 up only
+        break;
+#endif
+      default:
+        isa = kScalar;
+        mat_vec_ = MatVecScalar<double>;
+        mat_t_vec_ = MatTVecScalar<double>;
+        momentum_update_ = MomentumUpdateScalar<double>;
+        gemm_nt_ = GemmNTScalar<double>;
+        mat_vec_float_ = MatVecScalar<float>;
+        mat_t_vec_float_ = MatTVecScalar<float>;
+        momentum_update_float_ = MomentumUpdateScalar<float>;
+        gemm_nt_float_ = GemmNTScalar<float>;
+        mat_vec_int8_ = MatVecScalar;
+        SelectOptimizersScalar();
+        break;
+    }
+
+    isa_ = isa;
+    SelectTanhMode(tanh_mode_);
+}
+
+
+void
+Kernels::SelectTanhMode(TanhMode tanh_mode)
+{
+    tanh_mode_ = tanh_mode;
+    if (tanh_mode != kFast) {
+        tanh_ = TanhScalar<double>;
+        tanh_float_ = TanhScalar<float>;
+        return;
+    }
+
+    switch (isa_) {
+#ifdef MINANN_X86
+      case kAvx512:
+        tanh_ = FastTanhAvx512;
+        tanh_float_ = FastTanhAvx512;
+        break;
+      case kAvx2:
+        tanh_ = FastTanhAvx2;
+        tanh_float_ = FastTanhAvx2;
+        break;
+      case kSse2:
+        tanh_ = FastTanhSse2;
+        tanh_float_ = FastTanhSse2;
+        break;
+#endif
+      default:
+        tanh_ = FastTanhScalar<double>;
+        tanh_float_ = FastTanhScalar<float>;
+        break;
+    }
+}
+
+
+// PRIVATE ============================================================
+
+// ACCESSORS AND MUTATORS ---------------------------------------------
+void
+Kernels::SelectOptimizersScalar(void)
+{
+    nesterov_update_ = NesterovUpdateScalar<double>;
+    rms_prop_update_ = RmsPropUpdateScalar<double>;
+    adam_update_ = AdamUpdateScalar<double>;
+    nesterov_update_float_ = NesterovUpdateScalar<float>;
+    rms_prop_update_float_ = RmsPropUpdateScalar<float>;
+    adam_update_float_ = AdamUpdateScalar<float>;
+}
+
+
+void
+Kernels::SelectOptimizersAvx2(void)
+{
+#ifdef MINANN_X86
+    nesterov_update_ = NesterovUpdateAvx2;
+    rms_prop_update_ = RmsPropUpdateAvx2;
+    adam_update_ = AdamUpdateAvx2;
+    nesterov_update_float_ = NesterovUpdateAvx2;
+    rms_prop_update_float_ = RmsPropUpdateAvx2;
+    adam_update_float_ = AdamUpdateAvx2;
+#else
+    SelectOptimizersScalar();
+#endif
+}
+
+
+const char*
+Kernels::Name(Isa isa)
+{
+    switch (isa) {
+      case kAvx512:
+        return "avx512";
+      case kAvx2:
+        return "avx2";
+      case kSse2:
+        return "sse2";
+      default:
+        return "scalar";
+    }
+}
+
+
+} // ! namespace MinAnn
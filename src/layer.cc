@@ -0,0 +1,363 @@
+/**
+ * @file layer.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib> // Randomizing related functions
+#include <vector>
+
+#include <activation.hh>
+#include <initializer.hh>
+#include <kernels.hh>
+#include <layer.hh>
+
+
+namespace MinAnn {
+
+namespace {
+
+/* Relaxed atomic loads of plain values, so that weights can be shared
+ * between threads without changing their storage */
+template <typename T>
+inline T
+LoadRelaxed(const T* p)
+{
+    T value;
+    __atomic_load(p, &value, __ATOMIC_RELAXED);
+    return value;
+}
+
+} // ! namespace
+
+
+// CONSTANTS
+template <typename T>
+double BasicLayer<T>::kEta = 0.15f;     // Overall net learning rate
+
+template <typename T>
+double BasicLayer<T>::kAlpha = 0.5f;    // Momentum; multiplier of last
+                                        // delta_weight
+
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+template <typename T>
+BasicLayer<T>::BasicLayer(unsigned num_neurons, unsigned num_inputs,
+                          Activation activation)
+    : activation_(activation),
+      num_neurons_(num_neurons),
+      num_inputs_(num_inputs == 0 ? 0 : num_inputs + 1),
+      output_values_(num_neurons + 1, 0.0f),
+      gradients_(num_neurons + 1, 0.0f),
+      weights_(num_neurons_ * num_inputs_),
+      optimizer_(kMomentum, weights_.size(), kEta, kAlpha)
+{
+    /* Weights are drawn input-major so that the random sequence
+     * matches the one of a net built neuron by neuron */
+    for (unsigned i = 0; i < num_inputs_; ++i) {
+        for (unsigned j = 0; j < num_neurons_; ++j) {
+            weights_[j * num_inputs_ + i] = rand() / double(RAND_MAX);
+        }
+    }
+
+    // Force the bias node's output to 1.0
+    output_values_[num_neurons_] = 1.0f;
+}
+
+
+template <typename T>
+BasicLayer<T>::BasicLayer(unsigned num_neurons, unsigned num_inputs,
+                          Activation activation,
+                          const Initializer& initializer,
+                          unsigned layer_num)
+    : activation_(activation),
+      num_neurons_(num_neurons),
+      num_inputs_(num_inputs == 0 ? 0 : num_inputs + 1),
+      output_values_(num_neurons + 1, 0.0f),
+      gradients_(num_neurons + 1, 0.0f),
+      weights_(num_neurons_ * num_inputs_),
+      optimizer_(kMomentum, weights_.size(), kEta, kAlpha)
+{
+    if (!weights_.empty()) {
+        initializer.Fill(&weights_[0], layer_num, num_neurons, num_inputs);
+    }
+
+    // Force the bias node's output to 1.0
+    output_values_[num_neurons_] = 1.0f;
+}
+
+
+template <typename T>
+BasicLayer<T>::BasicLayer(unsigned num_neurons, unsigned num_inputs,
+                          Activation activation, const double* weights)
+    : activation_(activation),
+      num_neurons_(num_neurons),
+      num_inputs_(num_inputs == 0 ? 0 : num_inputs + 1),
+      output_values_(num_neurons + 1, 0.0f),
+      gradients_(num_neurons + 1, 0.0f),
+      weights_(weights, weights + num_neurons_ * num_inputs_),
+      optimizer_(kMomentum, weights_.size(), kEta, kAlpha)
+{
+    // Force the bias node's output to 1.0
+    output_values_[num_neurons_] = 1.0f;
+}
+
+
+template <typename T>
+BasicLayer<T>::~BasicLayer(void)
+{
+    weights_.clear();
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+template <typename T>
+void
+BasicLayer<T>::FeedForward(const BasicLayer& prev_layer)
+{
+    /* Sum the previous layer's outputs (now our inputs); and include
+     * the bias node from the previous layer */
+    Kernels::MatVec(&weights_[0], &prev_layer.output_values_[0],
+                    &output_values_[0], num_neurons_, num_inputs_);
+    activation_.Forward(&output_values_[0], num_neurons_);
+}
+
+
+template <typename T>
+void
+BasicLayer<T>::UpdateInputWeights(const BasicLayer& prev_layer)
+{
+    /* Individual input, magnified by the gradient and the train rate,
+     * plus a fraction of the previous delta (momentum) */
+    optimizer_.Update(&weights_[0], &prev_layer.output_values_[0],
+                      &gradients_[0], num_neurons_, num_inputs_);
+}
+
+
+template <typename T>
+void
+BasicLayer<T>::CalcOutputGradients(const std::vector<T>& target_values)
+{
+    for (unsigned n = 0; n < num_neurons_; ++n) {
+        gradients_[n] = target_values[n] - output_values_[n];
+    }
+    activation_.Backward(&output_values_[0], &gradients_[0], num_neurons_);
+}
+
+
+template <typename T>
+void
+BasicLayer<T>::CalcHiddenGradients(const BasicLayer& next_layer)
+{
+    /* Sum our contributions of the errors at the nodes we feed, for
+     * every neuron of this layer (bias included) at once */
+    Kernels::MatTVec(&next_layer.weights_[0], &next_layer.gradients_[0],
+                     &gradients_[0], next_layer.num_neurons_,
+                     next_layer.num_inputs_, num_neurons_ + 1);
+
+    // The bias output is constant, so it takes no gradient
+    activation_.Backward(&output_values_[0], &gradients_[0], num_neurons_);
+    gradients_[num_neurons_] = 0.0f;
+}
+
+
+template <typename T>
+void
+BasicLayer<T>::FeedForwardBatch(const T* inputs, T* outputs,
+                        unsigned batch_size) const
+{
+    unsigned width = num_neurons_ + 1;
+
+    Kernels::GemmNT(inputs, &weights_[0], outputs, batch_size,
+                    num_neurons_, num_inputs_, num_inputs_, width);
+
+    for (unsigned b = 0; b < batch_size; ++b) {
+        T* row = outputs + (unsigned long) b * width;
+
+        activation_.Forward(row, num_neurons_);
+        row[num_neurons_] = 1.0f;
+    }
+}
+
+
+template <typename T>
+void
+BasicLayer<T>::CalcOutputGradientsBatch(const T* outputs,
+                                const T* targets,
+                                T* gradients,
+                                unsigned batch_size) const
+{
+    unsigned width = num_neurons_ + 1;
+
+    for (unsigned b = 0; b < batch_size; ++b) {
+        const T* output_row = outputs + (unsigned long) b * width;
+        const T* target_row = targets +
+            (unsigned long) b * num_neurons_;
+        T* gradient_row = gradients + (unsigned long) b * width;
+
+        for (unsigned n = 0; n < num_neurons_; ++n) {
+            gradient_row[n] = target_row[n] - output_row[n];
+        }
+        activation_.Backward(output_row, gradient_row, num_neurons_);
+        gradient_row[num_neurons_] = 0.0f;
+    }
+}
+
+
+template <typename T>
+void
+BasicLayer<T>::CalcHiddenGradientsBatch(const BasicLayer& next_layer,
+                                const T* next_gradients,
+                                const T* outputs,
+                                T* gradients,
+                                unsigned batch_size) const
+{
+    unsigned width = num_neurons_ + 1;
+
+    Kernels::GemmNN(next_gradients, &next_layer.weights_[0], gradients,
+                    batch_size, width, next_layer.num_neurons_,
+                    next_layer.num_neurons_ + 1, next_layer.num_inputs_,
+                    width);
+
+    for (unsigned b = 0; b < batch_size; ++b) {
+        unsigned long row = (unsigned long) b * width;
+
+        activation_.Backward(outputs + row, gradients + row, num_neurons_);
+        gradients[row + num_neurons_] = 0.0f;
+    }
+}
+
+
+template <typename T>
+void
+BasicLayer<T>::CalcWeightGradientsBatch(const T* inputs,
+                                const T* gradients,
+                                T* weight_gradients,
+                                T* scratch,
+                                unsigned batch_size) const
+{
+    unsigned width = num_neurons_ + 1;
+
+    // Transpose the gradients so every neuron's column is contiguous
+    for (unsigned b = 0; b < batch_size; ++b) {
+        for (unsigned j = 0; j < num_neurons_; ++j) {
+            scratch[(unsigned long) j * batch_size + b] =
+                gradients[(unsigned long) b * width + j];
+        }
+    }
+
+    Kernels::GemmNN(scratch, inputs, weight_gradients, num_neurons_,
+                    num_inputs_, batch_size, batch_size, num_inputs_,
+                    num_inputs_);
+}
+
+
+template <typename T>
+void
+BasicLayer<T>::ApplyWeightGradients(const T* weight_gradients, T scale)
+{
+    /* The whole matrix is updated as a single row whose gradient is
+     * the scale, so the input is the summed gradient itself */
+    optimizer_.Update(&weights_[0], weight_gradients, &scale,
+                      1, num_neurons_ * num_inputs_);
+}
+
+
+template <typename T>
+void
+BasicLayer<T>::FeedForwardShared(const T* inputs, T* outputs) const
+{
+    for (unsigned j = 0; j < num_neurons_; ++j) {
+        const T* row = &weights_[j * num_inputs_];
+        T sum = 0.0f;
+
+        for (unsigned i = 0; i < num_inputs_; ++i) {
+            sum += inputs[i] * LoadRelaxed(row + i);
+        }
+        outputs[j] = sum;
+    }
+    activation_.Forward(outputs, num_neurons_);
+    outputs[num_neurons_] = 1.0f;
+}
+
+
+template <typename T>
+void
+BasicLayer<T>::CalcHiddenGradientsShared(const BasicLayer& next_layer,
+                                 const T* next_gradients,
+                                 const T* outputs,
+                                 T* gradients) const
+{
+    for (unsigned n = 0; n <= num_neurons_; ++n) {
+        gradients[n] = 0.0f;
+    }
+
+    for (unsigned j = 0; j < next_layer.num_neurons_; ++j) {
+        const T* row = &next_layer.weights_[j * next_layer.num_inputs_];
+
+        for (unsigned n = 0; n <= num_neurons_; ++n) {
+            gradients[n] += LoadRelaxed(row + n) * next_gradients[j];
+        }
+    }
+
+    activation_.Backward(outputs, gradients, num_neurons_);
+    gradients[num_neurons_] = 0.0f;
+}
+
+
+template <typename T>
+void
+BasicLayer<T>::UpdateInputWeightsShared(const T* inputs,
+                                const T* gradients)
+{
+    optimizer_.UpdateShared(&weights_[0], inputs, gradients,
+                            num_neurons_, num_inputs_);
+}
+
+
+// ACCESSORS AND MUTATORS ---------------------------------------------
+template <typename T>
+void
+BasicLayer<T>::Weights(const T* weights)
+{
+    std::copy(weights, weights + weights_.size(), weights_.begin());
+    optimizer_.Reset();
+}
+
+
+// Single and double precision layers
+template class BasicLayer<float>;
+template class BasicLayer<double>;
+
+
+} // ! namespace MinAnn
@@ -0,0 +1,183 @@
+/**
+ * @file live_model.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include <inference_model.hh>
+#include <live_model.hh>
+#include <net.hh>
+
+
+namespace MinAnn {
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+LiveModel::LiveModel(const Net& net)
+    : current_(new InferenceModel(net)),
+      epoch_(1)
+{
+    for (unsigned s = 0; s < kMaxReaders; ++s) {
+        slots_[s].epoch.store(kIdle);
+        slots_[s].taken.store(false);
+    }
+}
+
+
+LiveModel::~LiveModel(void)
+{
+    for (unsigned r = 0; r < retired_.size(); ++r) {
+        delete retired_[r].first;
+    }
+    delete current_.load();
+}
+
+
+LiveModel::Reader::Reader(LiveModel& live_model)
+    : live_model_(live_model),
+      slot_(kMaxReaders)
+{
+    for (unsigned s = 0; s < kMaxReaders && slot_ == kMaxReaders; ++s) {
+        bool taken = false;
+
+        if (live_model_.slots_[s].taken.compare_exchange_strong(taken,
+                                                                true)) {
+            slot_ = s;
+        }
+    }
+    if (slot_ == kMaxReaders) {
+        abort();
+    }
+}
+
+
+LiveModel::Reader::~Reader(void)
+{
+    live_model_.slots_[slot_].epoch.store(kIdle);
+    live_model_.slots_[slot_].taken.store(false);
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+const InferenceModel&
+LiveModel::Reader::Acquire(void)
+{
+    /* Announce the epoch before reading the pointer; the trainer swaps
+     * the pointer before moving to the next epoch, so whatever this
+     * loads was not retired before the announced epoch */
+    live_model_.slots_[slot_].epoch.store(live_model_.epoch_.load());
+    return *live_model_.current_.load();
+}
+
+
+void
+LiveModel::Reader::Release(void)
+{
+    live_model_.slots_[slot_].epoch.store(kIdle,
+                                          std::memory_order_release);
+}
+
+
+void
+LiveModel::Reader::Predict(const double* input_values,
+                           double* result_values)
+{
+    Acquire().Predict(input_values, result_values);
+    Release();
+}
+
+
+void
+LiveModel::Reader::Predict(const double* input_values, std::size_t rows,
+                           double* result_values)
+{
+    Acquire().Predict(input_values, rows, result_values);
+    Release();
+}
+
+
+void
+LiveModel::Publish(const Net& net)
+{
+    const InferenceModel* previous =
+        current_.exchange(new InferenceModel(net));
+
+    // Readers announcing this epoch or a later one see the new model
+    uint64_t epoch = epoch_.fetch_add(1) + 1;
+    retired_.push_back(std::make_pair(previous, epoch));
+
+    Reclaim();
+}
+
+
+std::size_t
+LiveModel::Reclaim(void)
+{
+    // Oldest epoch any reader is pinned at
+    uint64_t oldest = UINT64_MAX;
+    for (unsigned s = 0; s < kMaxReaders; ++s) {
+        uint64_t epoch = slots_[s].epoch.load();
+
+        if (epoch != kIdle && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+
+    std::size_t kept = 0;
+    for (unsigned r = 0; r < retired_.size(); ++r) {
+        if (retired_[r].second <= oldest) {
+            delete retired_[r].first;
+        } else {
+            retired_[kept++] = retired_[r];
+        }
+    }
+    retired_.resize(kept);
+
+    return kept;
+}
+
+
+// ACCESSORS AND MUTATORS ---------------------------------------------
+uint64_t
+LiveModel::Version(void) const
+{
+    return epoch_.load();
+}
+
+
+} // ! namespace MinAnn
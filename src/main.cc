@@ -27,6 +27,18 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */ 
 /*
+ * Usage: main [-q] [-r interval] [-m file] [-j] [training_data.dat]
+ *
+ *   -q           quiet, do not report the training samples
+ *   -r interval  report one training sample out of 'interval' (1 by
+ *                default, every sample)
+ *   -m file      write the errors of every reported sample to 'file',
+ *                as CSV
+ *   -j           write the metrics as JSON lines instead
+ *
+ * The training data is read from 'training_data.dat' unless another
+ * file is given.
+ *
  * 'minann' usage sample file:
  * An example of training data could be:
  *
@@ -47,110 +59,187 @@
  */
 
 #include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <string>
 #include <vector>
-#include <iostream>
-#include <iomanip>
 
+#include <async_loader.hh>
+#include <metrics_writer.hh>
 #include <net.hh>
+#include <profiler.hh>
 #include <training_data.hh>
 
 
-// Print a label and vector values to screen
-void VectorVals(std::string label, std::vector<double>& v,
-                std::string end_line="\n");
-
+// Samples parsed ahead of training, and batches of them in flight
+const unsigned kLoaderBatchSize = 256;
+const unsigned kLoaderDepth = 4;
 
-// Main entry
-int main(void)
-{
-    std::vector<double> input_values, target_values, result_values;
-    std::vector<unsigned> topology;
-    TrainingData training_data("training_data.dat");
-    training_data.Topology(topology);
-    MinAnn::Net net(topology);
-    int training_pass = 0;
 
-    while (!training_data.IsEof()) {
-        // Get new input data and feed it forward
-        if (training_data.NextInputs(input_values) != topology[0]) {
-            break;
-        }
-
-        // Print iteration number
-        ++training_pass;
-        std::cout << std::endl << "Iter #" << training_pass << ":" <<
-            std::endl;
-
-        VectorVals(":  Inputs:", input_values);
-        net.FeedForward(input_values);
+// Print a label and vector values to screen
+void VectorVals(const char* label, const std::vector<double>& v,
+                const char* end_line="\n");
 
-        // Collect the net's actual results
-        net.Results(result_values);
-        VectorVals(": Outputs:", result_values);
-        assert(result_values.size() == topology.back());
 
-        // Train the net what the outputs should have been
-        training_data.TargetOutputs(target_values);
-        VectorVals(": Targets:", target_values);
-        assert(target_values.size() == topology.back());
+int
+Usage(const char* program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [-q] [-r interval] [-m file] [-j] "
+                 "[training_data.dat]\n", program);
+    return 2;
+}
 
-        net.BackPropagation(target_values);
 
-        // Report how well training is working, averaged over recent
-        // samples
-        std::cout << "  Net recent avg. error: " << net.RecentAvgError() <<
-            std::endl;
+// Main entry
+int main(int argc, char* argv[])
+{
+    const char* data_filename = "training_data.dat";
+    const char* metrics_filename = 0;
+    MinAnn::MetricsWriter::Format metrics_format =
+        MinAnn::MetricsWriter::kCsv;
+    unsigned long report_interval = 1;
+    bool quiet = false;
+    int arg = 1;
+
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        if (strcmp(argv[arg], "-q") == 0) {
+            quiet = true;
+        } else if (strcmp(argv[arg], "-r") == 0 && arg + 1 < argc) {
+            report_interval = strtoul(argv[++arg], 0, 10);
+        } else if (strcmp(argv[arg], "-m") == 0 && arg + 1 < argc) {
+            metrics_filename = argv[++arg];
+        } else if (strcmp(argv[arg], "-j") == 0) {
+            metrics_format = MinAnn::MetricsWriter::kJsonLines;
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+    if (argc - arg > 1 || report_interval == 0) {
+        return Usage(argv[0]);
+    }
+    if (arg < argc) {
+        data_filename = argv[arg];
     }
-    std::cout << std::endl << "Done training!" << std::endl;
-
-    // Using the net after training. Sending input and getting results
-    std::vector<double> input;
-
-    std::cout << "\n-------------------------------------\n" << std::endl;
 
-    input = {0, 0};
-    net.FeedForward(input);
-    net.Results(result_values);
-    VectorVals("IN: ", input, "  ::  ");
-    VectorVals("OUT: ", result_values);
+    std::unique_ptr<MinAnn::MetricsWriter> metrics;
+    if (metrics_filename != 0) {
+        metrics.reset(new MinAnn::MetricsWriter(metrics_filename,
+                                                metrics_format));
+        if (!metrics->IsOpen()) {
+            std::fprintf(stderr, "%s: could not create '%s'\n",
+                         argv[0], metrics_filename);
+            return 1;
+        }
+    }
 
-    input = {0, 1};
-    net.FeedForward(input);
-    net.Results(result_values);
-    VectorVals("IN: ", input, "  ::  ");
-    VectorVals("OUT: ", result_values);
+    // Reading a missing or empty file would abort in the loader
+    TrainingData training_data(data_filename);
+    if (!training_data.IsOpen() || training_data.IsEof()) {
+        std::fprintf(stderr, "%s: could not read '%s'\n",
+                     argv[0], data_filename);
+        return 1;
+    }
 
-    input = {1, 0};
-    net.FeedForward(input);
-    net.Results(result_values);
-    VectorVals("IN: ", input, "  ::  ");
-    VectorVals("OUT: ", result_values);
+    std::vector<double> input_values, target_values, result_values;
+    MinAnn::AsyncLoader loader(training_data, kLoaderBatchSize,
+                               kLoaderDepth);
+    const std::vector<unsigned>& topology = loader.Topology();
+    MinAnn::Net net(topology);
+    unsigned long training_pass = 0;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    /* Samples are read on a background thread while the net trains.
+     * Output goes through stdio buffers and is never flushed by hand,
+     * so reporting costs little even for every sample */
+    while (const MinAnn::AsyncLoader::Batch* batch = loader.Next()) {
+        for (unsigned s = 0; s < batch->size; ++s) {
+            bool report = ++training_pass % report_interval == 0;
+            bool print = report && !quiet;
+
+            // Get new input data and feed it forward
+            input_values.assign(
+                batch->inputs.begin() + s * topology.front(),
+                batch->inputs.begin() + (s + 1) * topology.front());
+            target_values.assign(
+                batch->targets.begin() + s * topology.back(),
+                batch->targets.begin() + (s + 1) * topology.back());
+
+            net.FeedForward(input_values);
+
+            if (print) {
+                // Collect the net's actual results
+                net.Results(result_values);
+                assert(result_values.size() == topology.back());
+
+                std::printf("\nIter #%lu:\n", training_pass);
+                VectorVals(":  Inputs:", input_values);
+                VectorVals(": Outputs:", result_values);
+                VectorVals(": Targets:", target_values);
+            }
+
+            // Train the net what the outputs should have been
+            net.BackPropagation(target_values);
+
+            // Report how well training is working, averaged over recent
+            // samples
+            if (print) {
+                std::printf("  Net recent avg. error: %.3g\n",
+                            net.RecentAvgError());
+            }
+            if (report && metrics) {
+                std::chrono::duration<double> elapsed =
+                    std::chrono::steady_clock::now() - start;
+
+                metrics->Write(training_pass, net.Error(),
+                              net.RecentAvgError(), elapsed.count());
+            }
+        }
+    }
+    std::printf("\nDone training!\n");
+
+    /* Using the net after training. Sending input and getting results;
+     * the probes are those of the XOR sample data, so they are only
+     * sent to nets of two inputs */
+    if (topology.front() == 2) {
+        const double probes[][2] = {{0, 0}, {0, 1}, {1, 0}, {1, 1}};
+        std::vector<double> input;
+
+        std::printf("\n-------------------------------------\n\n");
+
+        for (unsigned p = 0; p < sizeof(probes) / sizeof(probes[0]); ++p) {
+            input.assign(probes[p], probes[p] + 2);
+            net.FeedForward(input);
+            net.Results(result_values);
+            VectorVals("IN: ", input, "  ::  ");
+            VectorVals("OUT: ", result_values);
+        }
 
-    input = {1, 1};
-    net.FeedForward(input);
-    net.Results(result_values);
-    VectorVals("IN: ", input, "  ::  ");
-    VectorVals("OUT: ", result_values);
+        std::printf("\n-------------------------------------\n\n");
+    }
 
-    std::cout << "\n-------------------------------------\n" << std::endl;
+    // Only with `make PROFILE=1', where the time went
+    if (MinAnn::Profiler::Enabled()) {
+        std::fflush(stdout);
+        MinAnn::Profiler::PrintSummary(stderr);
+        MinAnn::Profiler::WriteTrace("minann_trace.json");
+    }
 
     return 0;
 }
 
 
 void
-VectorVals(std::string label, std::vector<double>& v, std::string end_line)
+VectorVals(const char* label, const std::vector<double>& v,
+           const char* end_line)
 {
-    std::cout << label << " ";
-    std::cout << "{";
+    std::printf("%s {", label);
     for (unsigned i = 0; i < v.size(); ++i) {
-        std::cout << std::setprecision(3) << v[i];
-        if (i != v.size() - 1) {
-            std::cout << ", ";
-        }
+        std::printf(i != v.size() - 1 ? "%.3g, " : "%.3g", v[i]);
     }
-    std::cout << "}";
-    std::cout << end_line;
+    std::printf("}%s", end_line);
 }
-
@@ -0,0 +1,91 @@
+/**
+ * @file metrics_writer.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <metrics_writer.hh>
+
+
+namespace MinAnn {
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+MetricsWriter::MetricsWriter(const std::string& filename, Format format)
+    : buffer_(kBufferSize),
+      file_(std::fopen(filename.c_str(), "w")),
+      format_(format)
+{
+    if (file_ == 0) {
+        return;
+    }
+
+    std::setvbuf(file_, &buffer_[0], _IOFBF, buffer_.size());
+    if (format_ == kCsv) {
+        std::fputs("sample,error,recent_avg_error,seconds\n", file_);
+    }
+}
+
+
+MetricsWriter::~MetricsWriter(void)
+{
+    if (file_ != 0) {
+        std::fclose(file_);
+    }
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+void
+MetricsWriter::Write(unsigned long sample, double error,
+                     double recent_avg_error, double seconds)
+{
+    if (file_ == 0) {
+        return;
+    }
+
+    if (format_ == kCsv) {
+        std::fprintf(file_, "%lu,%.9g,%.9g,%.6f\n",
+                     sample, error, recent_avg_error, seconds);
+    } else {
+        std::fprintf(file_,
+                     "{\"sample\": %lu, \"error\": %.9g, "
+                     "\"recent_avg_error\": %.9g, \"seconds\": %.6f}\n",
+                     sample, error, recent_avg_error, seconds);
+    }
+}
+
+
+} // ! namespace MinAnn
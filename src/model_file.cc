@@ -0,0 +1,204 @@
+/**
+ * @file model_file.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <cstring>
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <model_file.hh>
+
+
+namespace MinAnn {
+
+namespace {
+
+const char kMagic[8] = {'M', 'I', 'N', 'A', 'N', 'N', '\0', '\0'};
+const uint32_t kByteOrder = 0x01020304;
+const uint64_t kAlignment = 64;
+
+static_assert(sizeof(ModelFile::Header) == 64, "Header must be 64 bytes");
+static_assert(sizeof(ModelFile::LayerEntry) == 8,
+              "LayerEntry must be 8 bytes");
+
+
+uint64_t
+AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // ! namespace
+
+
+// PUBLIC =============================================================
+
+// OPERATIONS ---------------------------------------------------------
+uint64_t
+ModelFile::Layout(const std::vector<unsigned>& topology,
+                  std::vector<uint64_t>& offsets)
+{
+    uint64_t size = 0;
+
+    offsets.assign(topology.size(), 0);
+    for (unsigned l = 1; l < topology.size(); ++l) {
+        offsets[l] = size;
+        size += AlignUp((uint64_t) topology[l] *
+                            ((uint64_t) topology[l - 1] + 1),
+                        kAlignment / sizeof(double));
+    }
+
+    return size;
+}
+
+
+bool
+ModelFile::Write(const std::string& filename,
+                 const std::vector<unsigned>& topology,
+                 const std::vector<Activation>& activations,
+                 const std::vector<const double*>& weights)
+{
+    std::vector<uint64_t> offsets;
+    uint64_t num_weights = Layout(topology, offsets);
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.byte_order = kByteOrder;
+    header.version = kVersion;
+    header.num_layers = topology.size();
+    header.layers_offset = sizeof(Header);
+    header.weights_offset = AlignUp(sizeof(Header) +
+                                    topology.size() * sizeof(LayerEntry),
+                                    kAlignment);
+    header.num_weights = num_weights;
+
+    std::vector<LayerEntry> layers(topology.size());
+    for (unsigned l = 0; l < topology.size(); ++l) {
+        layers[l].size = topology[l];
+        layers[l].activation = activations[l];
+    }
+
+    std::vector<double> block(num_weights, 0.0f);
+    for (unsigned l = 1; l < topology.size(); ++l) {
+        memcpy(&block[offsets[l]], weights[l],
+               (std::size_t) topology[l] *
+                   ((std::size_t) topology[l - 1] + 1) * sizeof(double));
+    }
+
+    std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+    std::vector<char> padding(header.weights_offset -
+                              header.layers_offset -
+                              layers.size() * sizeof(LayerEntry), 0);
+
+    file.write((const char*) &header, sizeof(header));
+    file.write((const char*) &layers[0], layers.size() * sizeof(LayerEntry));
+    file.write(padding.empty() ? "" : &padding[0], padding.size());
+    file.write((const char*) &block[0], block.size() * sizeof(double));
+    file.close();
+
+    return !file.fail();
+}
+
+
+bool
+ModelFile::Parse(const char* data, std::size_t size,
+                 std::vector<unsigned>& topology,
+                 std::vector<Activation>& activations,
+                 const double*& weights)
+{
+    Header header;
+
+    if (size < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    /* Offsets and counts come from the file: every bound is checked by
+     * subtraction from the size, so that no sum can wrap around */
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.byte_order != kByteOrder ||
+        header.version != kVersion ||
+        header.num_layers < 2 ||
+        header.layers_offset > size ||
+        header.num_layers > (size - header.layers_offset) /
+                            sizeof(LayerEntry) ||
+        header.weights_offset > size ||
+        header.num_weights > (size - header.weights_offset) /
+                             sizeof(double) ||
+        header.weights_offset % kAlignment != 0) {
+        return false;
+    }
+
+    std::vector<unsigned> sizes(header.num_layers);
+    std::vector<Activation> kinds(header.num_layers);
+    for (unsigned l = 0; l < header.num_layers; ++l) {
+        LayerEntry entry;
+
+        memcpy(&entry, data + header.layers_offset + l * sizeof(entry),
+               sizeof(entry));
+        if (entry.size == 0 || entry.activation >= kNumActivations) {
+            return false;
+        }
+        sizes[l] = entry.size;
+        kinds[l] = (Activation) entry.activation;
+    }
+
+    // Every layer must fit in the weights before the layout is summed
+    uint64_t num_weights = 0;
+    for (unsigned l = 1; l < header.num_layers; ++l) {
+        uint64_t count = (uint64_t) sizes[l] * ((uint64_t) sizes[l - 1] + 1);
+
+        if (count > header.num_weights - num_weights) {
+            return false;
+        }
+        num_weights += AlignUp(count, kAlignment / sizeof(double));
+        if (num_weights > header.num_weights) {
+            return false;
+        }
+    }
+
+    std::vector<uint64_t> offsets;
+    if (Layout(sizes, offsets) != header.num_weights) {
+        return false;
+    }
+
+    topology.swap(sizes);
+    activations.swap(kinds);
+    weights = (const double*) (data + header.weights_offset);
+
+    return true;
+}
+
+
+} // ! namespace MinAnn
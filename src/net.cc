@@ -30,110 +30,153 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */ 
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <string>
 #include <vector>
 
-#include <neuron.hh>
+#include <layer.hh>
+#include <model_file.hh>
 #include <net.hh>
+#include <profiler.hh>
 
 namespace MinAnn {
 
+namespace {
+
+// Weights as doubles, converted into @e storage if need be
+inline const double*
+AsDoubles(const double* values, std::size_t, std::vector<double>&)
+{
+    return values;
+}
+
+
+inline const double*
+AsDoubles(const float* values, std::size_t size,
+          std::vector<double>& storage)
+{
+    storage.assign(values, values + size);
+    return &storage[0];
+}
+
+} // ! namespace
+
+
 // CONSTANTS
-double Net::recent_avg_smoothing_factor_ = 100.0f;
+template <typename T>
+double BasicNet<T>::recent_avg_smoothing_factor_ = 100.0f;
 
 
 // PUBLIC =============================================================
 
 // LIFE CYCLE ---------------------------------------------------------
-Net::Net(const std::vector<unsigned>& topology)
+template <typename T>
+BasicNet<T>::BasicNet(const std::vector<unsigned>& topology)
+    : topology_(topology),
+      workspace_(topology, 0),
+      error_(0.0f),
+      recent_avg_error_(0.0f)
 {
-    unsigned numLayers = topology.size();
+    Build(std::vector<Activation>(topology.size(), kTanh));
+}
 
-    for (unsigned layer_num = 0; layer_num < numLayers; ++layer_num) {
-        layers_.push_back(Layer());
-        unsigned num_outputs = layer_num == topology.size() - 1
-            ? 0
-            : topology[layer_num + 1];
-
-        /* We have a new layer, now fill it with neurons, and add a bias
-         * neuron in each layer */
-        for (unsigned neuron_num = 0;
-             neuron_num <= topology[layer_num];
-             ++neuron_num) {
-            layers_.back().push_back(Neuron(num_outputs, neuron_num));
-        }
 
-        /* Force the bias node's output to 1.0 (it was the last neuron
-         * pushed in this layer) */
-        layers_.back().back().OutputValue(1.0f);
-    }
+template <typename T>
+BasicNet<T>::BasicNet(const std::vector<unsigned>& topology,
+                      const std::vector<Activation>& activations)
+    : topology_(topology),
+      workspace_(topology, 0),
+      error_(0.0f),
+      recent_avg_error_(0.0f)
+{
+    assert(activations.size() == topology.size());
+
+    Build(activations);
+}
+
+
+template <typename T>
+BasicNet<T>::BasicNet(const std::vector<unsigned>& topology,
+                      const std::vector<Activation>& activations,
+                      const Initializer& initializer)
+    : topology_(topology),
+      workspace_(topology, 0),
+      error_(0.0f),
+      recent_avg_error_(0.0f)
+{
+    assert(activations.size() == topology.size());
+
+    Build(activations, &initializer);
 }
 
 
-Net::~Net(void)
+template <typename T>
+BasicNet<T>::~BasicNet(void)
 {
     layers_.clear();
 }
 
 
 // OPERATIONS ---------------------------------------------------------
+template <typename T>
 void
-Net::FeedForward(const std::vector<double>& input_values)
+BasicNet<T>::FeedForward(const std::vector<T>& input_values)
 {
-    assert(input_values.size() == layers_[0].size() - 1);
+    assert(input_values.size() == layers_[0].Size());
 
     // Assign (latch) the input values into the input neurons
     for (unsigned i = 0; i < input_values.size(); ++i) {
-        layers_[0][i].OutputValue(input_values[i]);
+        layers_[0].OutputValue(i, input_values[i]);
     }
 
     // Forward propagate
     for (unsigned layer_num = 1;
          layer_num < layers_.size();
          ++layer_num) {
-        Layer& prev_layer = layers_[layer_num - 1];
-        for (unsigned n = 0; n < layers_[layer_num].size() - 1; ++n) {
-            layers_[layer_num][n].FeedForward(prev_layer);
-        }
+        MINANN_PROFILE_SCOPE(kForward, layer_num);
+        layers_[layer_num].FeedForward(layers_[layer_num - 1]);
     }
 }
 
 
+template <typename T>
 void
-Net::BackPropagation(const std::vector<double>& target_values)
+BasicNet<T>::BackPropagation(const std::vector<T>& target_values)
 {
     // Calculate overall net error (RMS of output neuron errors)
-    Layer& output_layer = layers_.back();
+    BasicLayer<T>& output_layer = layers_.back();
     error_ = 0.0f;
 
-    for (unsigned n = 0; n < output_layer.size() - 1; ++n) {
-        double delta = target_values[n] - output_layer[n].OutputValue();
+    for (unsigned n = 0; n < output_layer.Size(); ++n) {
+        double delta = target_values[n] - output_layer.OutputValue(n);
         error_ += delta * delta;
     }
-    error_ /= output_layer.size() - 1; // Get avg. error squared
-    error_ = sqrt(error_);             // RMS (root mean square error)
+    error_ /= output_layer.Size();  // Get avg. error squared
+    error_ = sqrt(error_);          // RMS (root mean square error)
 
     // Implement a recent average measurement
     recent_avg_error_ =
         (recent_avg_error_ * recent_avg_smoothing_factor_ + error_) /
             (recent_avg_smoothing_factor_ + 1.0f);
 
+    MINANN_PROFILE_COUNT(kSamples, 1);
+
     // Calculate output layer gradients
-    for (unsigned n = 0; n < output_layer.size() - 1; ++n) {
-        output_layer[n].CalcOutputGradients(target_values[n]);
+    {
+        MINANN_PROFILE_SCOPE(kBackward, layers_.size() - 1);
+        output_layer.CalcOutputGradients(target_values);
     }
 
     // Calculate hidden layer gradients
     for (unsigned layer_num = layers_.size() - 2;
          layer_num > 0;
          --layer_num) {
-        Layer& hidden_layer = layers_[layer_num];
-        Layer& next_layer = layers_[layer_num + 1];
-
-        for (unsigned n = 0; n < hidden_layer.size(); ++n) {
-            hidden_layer[n].CalcHiddenGradients(next_layer);
-        }
+        MINANN_PROFILE_SCOPE(kBackward, layer_num);
+        layers_[layer_num].CalcHiddenGradients(layers_[layer_num + 1]);
     }
 
     /* For all layers from outputs to first hidden layer, update
@@ -141,26 +184,426 @@ Net::BackPropagation(const std::vector<double>& target_values)
     for (unsigned layer_num = layers_.size() - 1;
          layer_num > 0;
          --layer_num) {
-        Layer& layer = layers_[layer_num];
-        Layer& prev_layer = layers_[layer_num - 1];
+        MINANN_PROFILE_SCOPE(kUpdate, layer_num);
+        layers_[layer_num].UpdateInputWeights(layers_[layer_num - 1]);
+    }
+}
+
+
+template <typename T>
+void
+BasicNet<T>::Results(std::vector<T>& result_values) const
+{
+    result_values.clear();
+
+    for (unsigned n = 0; n < layers_.back().Size(); ++n) {
+        result_values.push_back(layers_.back().OutputValue(n));
+    }
+}
+
+
+template <typename T>
+void
+BasicNet<T>::TrainBatch(const std::vector<T>& input_values,
+                const std::vector<T>& target_values,
+                unsigned batch_size)
+{
+    unsigned num_inputs = topology_.front();
+    unsigned num_outputs = topology_.back();
+    unsigned num_samples = input_values.size() / num_inputs;
+
+    assert(batch_size > 0);
+    assert(input_values.size() == num_samples * num_inputs);
+    assert(target_values.size() == num_samples * num_outputs);
+
+    if (workspace_.Capacity() < batch_size) {
+        workspace_ = BasicWorkspace<T>(topology_, batch_size);
+    }
+
+    for (unsigned first = 0; first < num_samples; first += batch_size) {
+        unsigned count = std::min(batch_size, num_samples - first);
+
+        CalcGradients(&input_values[first * num_inputs],
+                      &target_values[first * num_outputs],
+                      count, workspace_);
+        ApplyGradients(workspace_);
+    }
+}
+
+
+template <typename T>
+void
+BasicNet<T>::CalcGradients(const T* input_values,
+                   const T* target_values,
+                   unsigned batch_size,
+                   BasicWorkspace<T>& workspace) const
+{
+    unsigned num_layers = layers_.size();
+
+    assert(batch_size <= workspace.Capacity());
+
+    LatchInputs(input_values, batch_size, workspace);
+
+    // Forward propagate
+    for (unsigned layer_num = 1; layer_num < num_layers; ++layer_num) {
+        MINANN_PROFILE_SCOPE(kForward, layer_num);
+        layers_[layer_num].FeedForwardBatch(
+                &workspace.outputs_[layer_num - 1][0],
+                &workspace.outputs_[layer_num][0], batch_size);
+    }
+
+    workspace.errors_.clear();
+    CalcErrors(target_values, batch_size, workspace);
+    MINANN_PROFILE_COUNT(kSamples, batch_size);
+
+    // Output and hidden layer gradients
+    {
+        MINANN_PROFILE_SCOPE(kBackward, num_layers - 1);
+        layers_.back().CalcOutputGradientsBatch(
+                &workspace.outputs_.back()[0], target_values,
+                &workspace.gradients_.back()[0], batch_size);
+    }
+
+    for (unsigned layer_num = num_layers - 2;
+         layer_num > 0;
+         --layer_num) {
+        MINANN_PROFILE_SCOPE(kBackward, layer_num);
+        layers_[layer_num].CalcHiddenGradientsBatch(
+                layers_[layer_num + 1],
+                &workspace.gradients_[layer_num + 1][0],
+                &workspace.outputs_[layer_num][0],
+                &workspace.gradients_[layer_num][0], batch_size);
+    }
+
+    // Weight gradients, summed over the batch
+    for (unsigned layer_num = num_layers - 1;
+         layer_num > 0;
+         --layer_num) {
+        MINANN_PROFILE_SCOPE(kBackward, layer_num);
+        layers_[layer_num].CalcWeightGradientsBatch(
+                &workspace.outputs_[layer_num - 1][0],
+                &workspace.gradients_[layer_num][0],
+                &workspace.weight_gradients_[layer_num][0],
+                &workspace.scratch_[0], batch_size);
+    }
+
+    workspace.num_samples_ = batch_size;
+}
+
+
+template <typename T>
+void
+BasicNet<T>::ApplyGradients(const BasicWorkspace<T>& workspace)
+{
+    if (workspace.num_samples_ == 0) {
+        return;
+    }
+
+    T scale = 1.0f / workspace.num_samples_;
+    for (unsigned layer_num = layers_.size() - 1;
+         layer_num > 0;
+         --layer_num) {
+        MINANN_PROFILE_SCOPE(kUpdate, layer_num);
+        layers_[layer_num].ApplyWeightGradients(
+                &workspace.weight_gradients_[layer_num][0], scale);
+    }
+
+    RecordErrors(workspace);
+}
+
+
+template <typename T>
+void
+BasicNet<T>::TrainShared(const T* input_values,
+                 const T* target_values,
+                 BasicWorkspace<T>& workspace)
+{
+    unsigned num_layers = layers_.size();
+
+    assert(workspace.Capacity() > 0);
+
+    LatchInputs(input_values, 1, workspace);
+    for (unsigned layer_num = 1; layer_num < num_layers; ++layer_num) {
+        MINANN_PROFILE_SCOPE(kForward, layer_num);
+        layers_[layer_num].FeedForwardShared(
+                &workspace.outputs_[layer_num - 1][0],
+                &workspace.outputs_[layer_num][0]);
+    }
+
+    CalcErrors(target_values, 1, workspace);
+    ++workspace.num_samples_;
+    MINANN_PROFILE_COUNT(kSamples, 1);
+
+    /* Every gradient is computed before any weight is touched, as in
+     * BackPropagation() */
+    {
+        MINANN_PROFILE_SCOPE(kBackward, num_layers - 1);
+        layers_.back().CalcOutputGradientsBatch(
+                &workspace.outputs_.back()[0], target_values,
+                &workspace.gradients_.back()[0], 1);
+    }
+
+    for (unsigned layer_num = num_layers - 2;
+         layer_num > 0;
+         --layer_num) {
+        MINANN_PROFILE_SCOPE(kBackward, layer_num);
+        layers_[layer_num].CalcHiddenGradientsShared(
+                layers_[layer_num + 1],
+                &workspace.gradients_[layer_num + 1][0],
+                &workspace.outputs_[layer_num][0],
+                &workspace.gradients_[layer_num][0]);
+    }
+
+    for (unsigned layer_num = num_layers - 1;
+         layer_num > 0;
+         --layer_num) {
+        MINANN_PROFILE_SCOPE(kUpdate, layer_num);
+        layers_[layer_num].UpdateInputWeightsShared(
+                &workspace.outputs_[layer_num - 1][0],
+                &workspace.gradients_[layer_num][0]);
+    }
+}
+
+
+template <typename T>
+void
+BasicNet<T>::RecordErrors(const BasicWorkspace<T>& workspace)
+{
+    // Same recent average measurement as in online training
+    for (unsigned b = 0; b < workspace.errors_.size(); ++b) {
+        error_ = workspace.errors_[b];
+        recent_avg_error_ =
+            (recent_avg_error_ * recent_avg_smoothing_factor_ + error_) /
+                (recent_avg_smoothing_factor_ + 1.0f);
+    }
+}
+
+
+template <typename T>
+bool
+BasicNet<T>::Save(const std::string& filename) const
+{
+    std::vector<std::vector<double> > storage(layers_.size());
+    std::vector<const double*> weights;
+
+    for (unsigned layer_num = 0; layer_num < layers_.size(); ++layer_num) {
+        const BasicLayer<T>& layer = layers_[layer_num];
+
+        weights.push_back(layer.Weights() == 0
+                          ? 0
+                          : AsDoubles(layer.Weights(),
+                                      layer.Size() * layer.NumInputs(),
+                                      storage[layer_num]));
+    }
+
+    return ModelFile::Write(filename, topology_, Activations(), weights);
+}
+
+
+template <typename T>
+bool
+BasicNet<T>::Load(const std::string& filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Read into doubles, so that the weights in the buffer are aligned
+    std::streamoff end = file.tellg();
+    if (end <= 0) {
+        return false;
+    }
+    std::size_t size = end;
+    std::vector<double> buffer((size + sizeof(double) - 1) / sizeof(double));
+    file.seekg(0);
+    file.read((char*) &buffer[0], size);
+    if (file.fail()) {
+        return false;
+    }
+
+    std::vector<unsigned> topology;
+    std::vector<Activation> activations;
+    const double* weights;
+    if (!ModelFile::Parse((const char*) &buffer[0], size, topology,
+                          activations, weights)) {
+        return false;
+    }
+
+    std::vector<uint64_t> offsets;
+    ModelFile::Layout(topology, offsets);
+
+    // The hyperparameters are not part of the model
+    double eta = LearningRate();
+    double alpha = Momentum();
+    Optimizer optimizer = OptimizerKind();
+
+    /* Layers are built straight from the saved weights, so that loading
+     * draws no random number: the caller's rand() sequence is left as
+     * it was, and nets can be loaded from several threads at once */
+    std::vector<BasicLayer<T> > layers;
+    for (unsigned layer_num = 0; layer_num < topology.size(); ++layer_num) {
+        layers.push_back(BasicLayer<T>(
+            topology[layer_num],
+            layer_num == 0 ? 0 : topology[layer_num - 1],
+            activations[layer_num], weights + offsets[layer_num]));
+    }
+
+    topology_.swap(topology);
+    layers_.swap(layers);
+    workspace_ = BasicWorkspace<T>(topology_, 0);
+    error_ = 0.0f;
+    recent_avg_error_ = 0.0f;
+    LearningRate(eta);
+    Momentum(alpha);
+    OptimizerKind(optimizer);
+
+    return true;
+}
+
+
+// ACCESSORS AND MUTATORS ---------------------------------------------
+template <typename T>
+std::vector<Activation>
+BasicNet<T>::Activations(void) const
+{
+    std::vector<Activation> activations;
+
+    for (unsigned layer_num = 0; layer_num < layers_.size(); ++layer_num) {
+        activations.push_back(layers_[layer_num].TransferKind());
+    }
+
+    return activations;
+}
+
+
+template <typename T>
+double
+BasicNet<T>::LearningRate(void) const
+{
+    return layers_.back().LearningRate();
+}
+
 
-        for (unsigned n = 0; n < layer.size() - 1; ++n) {
-            layer[n].UpdateInputWeights(prev_layer);
+template <typename T>
+void
+BasicNet<T>::LearningRate(double eta)
+{
+    for (unsigned layer_num = 0; layer_num < layers_.size(); ++layer_num) {
+        layers_[layer_num].LearningRate(eta);
+    }
+}
+
+
+template <typename T>
+double
+BasicNet<T>::Momentum(void) const
+{
+    return layers_.back().Momentum();
+}
+
+
+template <typename T>
+void
+BasicNet<T>::Momentum(double alpha)
+{
+    for (unsigned layer_num = 0; layer_num < layers_.size(); ++layer_num) {
+        layers_[layer_num].Momentum(alpha);
+    }
+}
+
+
+template <typename T>
+Optimizer
+BasicNet<T>::OptimizerKind(void) const
+{
+    return layers_.back().OptimizerKind();
+}
+
+
+template <typename T>
+void
+BasicNet<T>::OptimizerKind(Optimizer kind)
+{
+    for (unsigned layer_num = 0; layer_num < layers_.size(); ++layer_num) {
+        layers_[layer_num].OptimizerKind(kind);
+    }
+}
+
+
+// PRIVATE ============================================================
+
+// OPERATIONS ---------------------------------------------------------
+template <typename T>
+void
+BasicNet<T>::Build(const std::vector<Activation>& activations,
+                   const Initializer* initializer)
+{
+    unsigned numLayers = topology_.size();
+
+    /* Every layer owns the weights coming from the previous one; the
+     * input layer has none.  Each layer carries its own bias neuron */
+    for (unsigned layer_num = 0; layer_num < numLayers; ++layer_num) {
+        unsigned num_inputs = layer_num == 0
+            ? 0
+            : topology_[layer_num - 1];
+
+        if (initializer != 0) {
+            layers_.push_back(BasicLayer<T>(topology_[layer_num],
+                                            num_inputs,
+                                            activations[layer_num],
+                                            *initializer, layer_num));
+        } else {
+            layers_.push_back(BasicLayer<T>(topology_[layer_num],
+                                            num_inputs,
+                                            activations[layer_num]));
         }
     }
 }
 
 
+template <typename T>
 void
-Net::Results(std::vector<double>& result_values) const
+BasicNet<T>::LatchInputs(const T* input_values, unsigned batch_size,
+                 BasicWorkspace<T>& workspace) const
 {
-    result_values.clear();
+    unsigned num_inputs = topology_.front();
+    T* inputs = &workspace.outputs_[0][0];
 
-    for (unsigned n = 0; n < layers_.back().size() - 1; ++n) {
-        result_values.push_back(layers_.back()[n].OutputValue());
+    // One row per sample, plus the bias column
+    for (unsigned b = 0; b < batch_size; ++b) {
+        std::copy(input_values + b * num_inputs,
+                  input_values + (b + 1) * num_inputs,
+                  inputs + b * (num_inputs + 1));
+        inputs[b * (num_inputs + 1) + num_inputs] = 1.0f;
     }
 }
 
 
-} // ! namespace MinAnn
+template <typename T>
+void
+BasicNet<T>::CalcErrors(const T* target_values, unsigned batch_size,
+                BasicWorkspace<T>& workspace) const
+{
+    unsigned num_outputs = topology_.back();
+    const T* outputs = &workspace.outputs_.back()[0];
+
+    for (unsigned b = 0; b < batch_size; ++b) {
+        double error = 0.0f;
 
+        for (unsigned n = 0; n < num_outputs; ++n) {
+            double delta = target_values[b * num_outputs + n] -
+                outputs[b * (num_outputs + 1) + n];
+            error += delta * delta;
+        }
+        workspace.errors_.push_back(sqrt(error / num_outputs));
+    }
+}
+
+
+// Single and double precision nets
+template class BasicNet<float>;
+template class BasicNet<double>;
+
+
+} // ! namespace MinAnn
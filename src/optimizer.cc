@@ -0,0 +1,254 @@
+/**
+ * @file optimizer.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <kernels.hh>
+#include <optimizer.hh>
+
+
+namespace MinAnn {
+
+namespace {
+
+/* Relaxed atomic accesses to plain values, so that weights and state
+ * can be shared between threads without changing their storage */
+template <typename T>
+inline void
+LoadRelaxed(const T* from, T* to, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i) {
+        __atomic_load(from + i, to + i, __ATOMIC_RELAXED);
+    }
+}
+
+
+template <typename T>
+inline void
+StoreRelaxed(const T* from, T* to, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i) {
+        T value = from[i];
+        __atomic_store(to + i, &value, __ATOMIC_RELAXED);
+    }
+}
+
+
+template <typename T>
+inline T*
+Data(std::vector<T>& values)
+{
+    return values.empty() ? 0 : &values[0];
+}
+
+} // ! namespace
+
+
+// CONSTANTS
+template <typename T>
+const double BasicOptimizer<T>::kRho = 0.9;
+
+template <typename T>
+const double BasicOptimizer<T>::kBeta1 = 0.9;
+
+template <typename T>
+const double BasicOptimizer<T>::kBeta2 = 0.999;
+
+template <typename T>
+const double BasicOptimizer<T>::kEpsilon = 1e-8;
+
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+template <typename T>
+BasicOptimizer<T>::BasicOptimizer(Optimizer kind, std::size_t num_weights,
+                                  double eta, double alpha)
+    : kind_(kind),
+      eta_(eta),
+      alpha_(alpha),
+      num_weights_(num_weights),
+      steps_(0)
+{
+    Allocate();
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+template <typename T>
+void
+BasicOptimizer<T>::Update(T* w, const T* x, const T* g, unsigned rows,
+                          unsigned cols)
+{
+    Step(w, Data(first_), Data(second_), x, g, rows, cols, ++steps_);
+}
+
+
+template <typename T>
+void
+BasicOptimizer<T>::UpdateShared(T* w, const T* x, const T* g,
+                                unsigned rows, unsigned cols)
+{
+    static thread_local std::vector<T> w_row;
+    static thread_local std::vector<T> first_row;
+    static thread_local std::vector<T> second_row;
+    T* first = Data(first_);
+    T* second = Data(second_);
+    unsigned long step = __atomic_add_fetch(&steps_, 1, __ATOMIC_RELAXED);
+
+    w_row.resize(cols);
+    first_row.resize(first != 0 ? cols : 0);
+    second_row.resize(second != 0 ? cols : 0);
+
+    for (unsigned j = 0; j < rows; ++j) {
+        std::size_t row = (std::size_t) j * cols;
+
+        LoadRelaxed(w + row, &w_row[0], cols);
+        if (first != 0) {
+            LoadRelaxed(first + row, &first_row[0], cols);
+        }
+        if (second != 0) {
+            LoadRelaxed(second + row, &second_row[0], cols);
+        }
+
+        Step(&w_row[0], Data(first_row), Data(second_row), x, g + j,
+             1, cols, step);
+
+        StoreRelaxed(&w_row[0], w + row, cols);
+        if (first != 0) {
+            StoreRelaxed(&first_row[0], first + row, cols);
+        }
+        if (second != 0) {
+            StoreRelaxed(&second_row[0], second + row, cols);
+        }
+    }
+}
+
+
+template <typename T>
+void
+BasicOptimizer<T>::Reset(void)
+{
+    std::fill(first_.begin(), first_.end(), 0.0f);
+    std::fill(second_.begin(), second_.end(), 0.0f);
+    steps_ = 0;
+}
+
+
+// ACCESSORS AND MUTATORS ---------------------------------------------
+template <typename T>
+void
+BasicOptimizer<T>::Kind(Optimizer kind)
+{
+    kind_ = kind;
+    Allocate();
+    Reset();
+}
+
+
+template <typename T>
+const char*
+BasicOptimizer<T>::Name(Optimizer kind)
+{
+    switch (kind) {
+      case kNesterov:
+        return "nesterov";
+      case kRmsProp:
+        return "rmsprop";
+      case kAdam:
+        return "adam";
+      default:
+        return "momentum";
+    }
+}
+
+
+// PRIVATE ============================================================
+
+// OPERATIONS ---------------------------------------------------------
+template <typename T>
+void
+BasicOptimizer<T>::Allocate(void)
+{
+    // Momentum and Nesterov keep deltas, RMSProp squares, Adam both
+    first_.assign(kind_ != kRmsProp ? num_weights_ : 0, 0.0f);
+    second_.assign(kind_ == kRmsProp || kind_ == kAdam ? num_weights_ : 0,
+                   0.0f);
+}
+
+
+template <typename T>
+void
+BasicOptimizer<T>::Step(T* w, T* first, T* second, const T* x,
+                        const T* g, unsigned rows, unsigned cols,
+                        unsigned long step) const
+{
+    switch (kind_) {
+      case kNesterov:
+        Kernels::NesterovUpdate(w, first, x, g, rows, cols,
+                                (T) eta_, (T) alpha_);
+        break;
+      case kRmsProp:
+        Kernels::RmsPropUpdate(w, second, x, g, rows, cols,
+                               (T) eta_, (T) kRho, (T) kEpsilon);
+        break;
+      case kAdam: {
+        // Bias correction of both averages, folded into the step
+        double first_correction = 1.0f - std::pow(kBeta1, step);
+        double second_correction = std::sqrt(1.0f - std::pow(kBeta2,
+                                                             step));
+
+        Kernels::AdamUpdate(w, first, second, x, g, rows, cols,
+                            (T) (eta_ * second_correction /
+                                 first_correction),
+                            (T) kBeta1, (T) kBeta2,
+                            (T) (kEpsilon * second_correction));
+        break;
+      }
+      default:
+        Kernels::MomentumUpdate(w, first, x, g, rows, cols,
+                                (T) eta_, (T) alpha_);
+        break;
+    }
+}
+
+
+// Single and double precision optimizers
+template class BasicOptimizer<float>;
+template class BasicOptimizer<double>;
+
+
+} // ! namespace MinAnn
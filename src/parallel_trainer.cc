@@ -0,0 +1,110 @@
+/**
+ * @file parallel_trainer.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <parallel_trainer.hh>
+
+
+namespace MinAnn {
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+ParallelTrainer::ParallelTrainer(Net& net, unsigned num_threads)
+    : net_(net),
+      pool_(std::max(1u, num_threads)),
+      workspaces_(pool_.Size(), Workspace(net.Topology(), 0))
+{
+}
+
+
+ParallelTrainer::~ParallelTrainer(void)
+{
+    workspaces_.clear();
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+void
+ParallelTrainer::Train(const std::vector<double>& input_values,
+                       const std::vector<double>& target_values,
+                       unsigned batch_size)
+{
+    const std::vector<unsigned>& topology = net_.Topology();
+    unsigned num_inputs = topology.front();
+    unsigned num_outputs = topology.back();
+    unsigned num_samples = input_values.size() / num_inputs;
+    unsigned num_threads = pool_.Size();
+
+    assert(batch_size > 0);
+    assert(input_values.size() == num_samples * num_inputs);
+    assert(target_values.size() == num_samples * num_outputs);
+
+    unsigned shard_capacity = (batch_size + num_threads - 1) / num_threads;
+    if (workspaces_[0].Capacity() < shard_capacity) {
+        for (unsigned t = 0; t < num_threads; ++t) {
+            workspaces_[t] = Workspace(topology, shard_capacity);
+        }
+    }
+
+    for (unsigned first = 0; first < num_samples; first += batch_size) {
+        unsigned count = std::min(batch_size, num_samples - first);
+
+        pool_.Run([&](unsigned t) {
+            // Contiguous shards, the first ones one sample larger
+            unsigned begin = first + t * (count / num_threads) +
+                std::min(t, count % num_threads);
+            unsigned size = count / num_threads +
+                (t < count % num_threads ? 1 : 0);
+
+            if (size == 0) {
+                workspaces_[t].Clear();
+                return;
+            }
+            net_.CalcGradients(&input_values[begin * num_inputs],
+                               &target_values[begin * num_outputs],
+                               size, workspaces_[t]);
+        });
+
+        // Fixed order reduction, so results do not depend on timing
+        for (unsigned t = 1; t < num_threads; ++t) {
+            workspaces_[0].Accumulate(workspaces_[t]);
+        }
+        net_.ApplyGradients(workspaces_[0]);
+    }
+}
+
+
+} // ! namespace MinAnn
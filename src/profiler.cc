@@ -0,0 +1,387 @@
+/**
+ * @file profiler.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <profiler.hh>
+
+
+namespace MinAnn {
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Event {
+    long long start_ns;
+    long long duration_ns;
+    Profiler::Section section;
+    unsigned layer;
+};
+
+
+struct Totals {
+    unsigned long calls;
+    long long ns;
+};
+
+
+// Everything one thread records, merged only when reporting
+struct ThreadLog {
+    unsigned id;
+    std::vector<Event> events;
+    unsigned long dropped;
+    Totals totals[Profiler::kNumSections][Profiler::kMaxLayers];
+    unsigned long counters[Profiler::kNumCounters];
+
+    void Clear(void)
+    {
+        events.clear();
+        dropped = 0;
+        for (unsigned s = 0; s < Profiler::kNumSections; ++s) {
+            for (unsigned l = 0; l < Profiler::kMaxLayers; ++l) {
+                totals[s][l].calls = 0;
+                totals[s][l].ns = 0;
+            }
+        }
+        for (unsigned c = 0; c < Profiler::kNumCounters; ++c) {
+            counters[c] = 0;
+        }
+    }
+};
+
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadLog*> logs;   // Never freed, threads may come back
+    Clock::time_point start;
+
+    Registry(void) : start(Clock::now()) {}
+};
+
+
+/* Bumped by operator new, which may run before any static object is
+ * built, hence a constant-initialized atomic rather than a log */
+std::atomic<unsigned long> allocations(0);
+
+
+Registry&
+GetRegistry(void)
+{
+    static Registry registry;
+    return registry;
+}
+
+
+ThreadLog&
+GetThreadLog(void)
+{
+    static thread_local ThreadLog* log = 0;
+
+    if (log == 0) {
+        Registry& registry = GetRegistry();
+        ThreadLog* new_log = new ThreadLog;
+
+        // Reserved up front, so that recording never allocates
+        new_log->events.reserve(Profiler::kMaxEvents);
+        new_log->Clear();
+
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        new_log->id = registry.logs.size();
+        registry.logs.push_back(new_log);
+        log = new_log;
+    }
+    return *log;
+}
+
+
+long long
+Nanoseconds(Clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            duration).count();
+}
+
+} // ! namespace
+
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+Profiler::Scope::Scope(Section section, unsigned layer)
+    : section_(section),
+      layer_(layer < kMaxLayers ? layer : kMaxLayers - 1),
+      start_(Clock::now())
+{
+}
+
+
+Profiler::Scope::~Scope(void)
+{
+    Clock::time_point end = Clock::now();
+    ThreadLog& log = GetThreadLog();
+    Totals& totals = log.totals[section_][layer_];
+    long long duration = Nanoseconds(end - start_);
+
+    ++totals.calls;
+    totals.ns += duration;
+
+    if (log.events.size() < kMaxEvents) {
+        Event event;
+
+        event.start_ns = Nanoseconds(start_ - GetRegistry().start);
+        event.duration_ns = duration;
+        event.section = section_;
+        event.layer = layer_;
+        log.events.push_back(event);
+    } else {
+        ++log.dropped;
+    }
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+void
+Profiler::Count(Counter counter, unsigned long n)
+{
+    if (counter == kAllocations) {
+        allocations.fetch_add(n, std::memory_order_relaxed);
+    } else {
+        GetThreadLog().counters[counter] += n;
+    }
+}
+
+
+void
+Profiler::Reset(void)
+{
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    for (unsigned t = 0; t < registry.logs.size(); ++t) {
+        registry.logs[t]->Clear();
+    }
+    allocations.store(0, std::memory_order_relaxed);
+    registry.start = Clock::now();
+}
+
+
+void
+Profiler::PrintSummary(std::FILE* file)
+{
+    if (!Enabled()) {
+        std::fprintf(file, "Profiling is disabled, "
+                     "rebuild with `make PROFILE=1'\n");
+        return;
+    }
+
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    double elapsed = Nanoseconds(Clock::now() - registry.start) * 1e-9;
+
+    // Merge every thread
+    Totals totals[kNumSections][kMaxLayers] = {};
+    unsigned long counters[kNumCounters] = {};
+    unsigned long dropped = 0;
+    long long total_ns = 0;
+
+    for (unsigned t = 0; t < registry.logs.size(); ++t) {
+        const ThreadLog& log = *registry.logs[t];
+
+        for (unsigned s = 0; s < kNumSections; ++s) {
+            for (unsigned l = 0; l < kMaxLayers; ++l) {
+                totals[s][l].calls += log.totals[s][l].calls;
+                totals[s][l].ns += log.totals[s][l].ns;
+                total_ns += log.totals[s][l].ns;
+            }
+        }
+        for (unsigned c = 0; c < kNumCounters; ++c) {
+            counters[c] += log.counters[c];
+        }
+        dropped += log.dropped;
+    }
+    counters[kAllocations] = allocations.load(std::memory_order_relaxed);
+
+    std::fprintf(file, "%-9s %5s %12s %12s %10s %7s\n",
+                 "section", "layer", "calls", "total ms", "mean ns",
+                 "share");
+    for (unsigned s = 0; s < kNumSections; ++s) {
+        for (unsigned l = 0; l < kMaxLayers; ++l) {
+            const Totals& entry = totals[s][l];
+
+            if (entry.calls == 0) {
+                continue;
+            }
+            std::fprintf(file, "%-9s %5u %12lu %12.3f %10.1f %6.1f%%\n",
+                         Name(Section(s)), l, entry.calls,
+                         entry.ns * 1e-6, double(entry.ns) / entry.calls,
+                         100.0 * entry.ns / (total_ns > 0 ? total_ns : 1));
+        }
+    }
+
+    std::fprintf(file, "\nelapsed        %14.3f s\n", elapsed);
+    std::fprintf(file, "samples        %14lu (%.1f/s)\n",
+                 counters[kSamples], counters[kSamples] / elapsed);
+    std::fprintf(file, "bytes parsed   %14lu (%.2f MB/s)\n",
+                 counters[kBytesParsed],
+                 counters[kBytesParsed] / elapsed * 1e-6);
+    std::fprintf(file, "allocations    %14lu\n", counters[kAllocations]);
+    if (dropped > 0) {
+        std::fprintf(file, "untraced       %14lu sections\n", dropped);
+    }
+}
+
+
+bool
+Profiler::WriteTrace(const std::string& filename)
+{
+    std::FILE* file = std::fopen(filename.c_str(), "w");
+
+    if (file == 0) {
+        return false;
+    }
+
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    const char* separator = "\n";
+
+    // Complete events ("X"), timestamps in microseconds
+    std::fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+    for (unsigned t = 0; t < registry.logs.size(); ++t) {
+        const ThreadLog& log = *registry.logs[t];
+
+        for (unsigned e = 0; e < log.events.size(); ++e) {
+            const Event& event = log.events[e];
+
+            std::fprintf(file,
+                         "%s{\"name\": \"%s %u\", \"cat\": \"%s\", "
+                         "\"ph\": \"X\", \"pid\": 1, \"tid\": %u, "
+                         "\"ts\": %.3f, \"dur\": %.3f}",
+                         separator, Name(event.section), event.layer,
+                         Name(event.section), log.id,
+                         event.start_ns * 1e-3, event.duration_ns * 1e-3);
+            separator = ",\n";
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+
+    return std::fclose(file) == 0;
+}
+
+
+// ACCESSORS AND MUTATORS ---------------------------------------------
+bool
+Profiler::Enabled(void)
+{
+#ifdef MINANN_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+unsigned long
+Profiler::Total(Counter counter)
+{
+    if (counter == kAllocations) {
+        return allocations.load(std::memory_order_relaxed);
+    }
+
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    unsigned long total = 0;
+
+    for (unsigned t = 0; t < registry.logs.size(); ++t) {
+        total += registry.logs[t]->counters[counter];
+    }
+    return total;
+}
+
+
+const char*
+Profiler::Name(Section section)
+{
+    static const char* const kNames[kNumSections] = {
+        "forward", "backward", "update", "parse"
+    };
+
+    return kNames[section];
+}
+
+
+} // ! namespace MinAnn
+
+
+#ifdef MINANN_PROFILE
+// Replacement global allocation functions, counting every allocation
+void*
+operator new(std::size_t size)
+{
+    MinAnn::Profiler::Count(MinAnn::Profiler::kAllocations, 1);
+
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (p == 0) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+
+void*
+operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+
+void
+operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+#endif // ! MINANN_PROFILE
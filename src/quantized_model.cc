@@ -0,0 +1,263 @@
+/**
+ * @file quantized_model.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <kernels.hh>
+#include <layer.hh>
+#include <quantized_model.hh>
+
+
+namespace MinAnn {
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+QuantizedModel::Context::Context(const QuantizedModel& model)
+    : values_(model.max_width_, 0),
+      sums_(model.max_width_, 0),
+      outputs_(model.max_width_, 0.0f)
+{
+}
+
+
+QuantizedModel::QuantizedModel(const Net& net, const double* input_values,
+                               std::size_t rows)
+    : topology_(net.Topology()),
+      offsets_(topology_.size(), 0),
+      bias_offsets_(topology_.size(), 0),
+      input_scales_(topology_.size(), 1.0f),
+      sum_scales_(topology_.size(), 1.0f),
+      max_width_(0)
+{
+    const std::vector<Layer>& layers = net.Layers();
+    std::vector<double> ranges;
+    std::size_t num_weights = 0;
+    std::size_t num_biases = 0;
+
+    Calibrate(net, input_values, rows, ranges);
+
+    for (unsigned l = 0; l < layers.size(); ++l) {
+        activations_.push_back(ActivationFunction(layers[l].TransferKind()));
+    }
+
+    for (unsigned l = 1; l < topology_.size(); ++l) {
+        offsets_[l] = num_weights;
+        bias_offsets_[l] = num_biases;
+        num_weights += (std::size_t) topology_[l] * topology_[l - 1];
+        num_biases += topology_[l];
+    }
+    weights_.assign(num_weights, 0);
+    biases_.assign(num_biases, 0);
+
+    for (unsigned l = 1; l < topology_.size(); ++l) {
+        unsigned num_neurons = topology_[l];
+        unsigned num_inputs = topology_[l - 1];
+        unsigned cols = num_inputs + 1;
+        const double* w = layers[l].Weights();
+        double range = 0.0f;
+
+        for (unsigned j = 0; j < num_neurons; ++j) {
+            for (unsigned i = 0; i < num_inputs; ++i) {
+                range = std::max(range, fabs(w[j * cols + i]));
+            }
+        }
+        double weight_scale = range > 0.0f ? range / 127 : 1.0f;
+
+        if (ranges[l - 1] > 0.0f) {
+            input_scales_[l] = ranges[l - 1] / 127;
+        }
+        sum_scales_[l] = weight_scale * input_scales_[l];
+
+        for (unsigned j = 0; j < num_neurons; ++j) {
+            int8_t* row =
+                &weights_[offsets_[l] + (std::size_t) j * num_inputs];
+            double bias = w[j * cols + num_inputs] / sum_scales_[l];
+
+            for (unsigned i = 0; i < num_inputs; ++i) {
+                row[i] = Quantize(w[j * cols + i], weight_scale);
+            }
+            bias = std::min(std::max(bias, (double) INT32_MIN),
+                            (double) INT32_MAX);
+            biases_[bias_offsets_[l] + j] = (int32_t) lrint(bias);
+        }
+    }
+
+    for (unsigned l = 0; l < topology_.size(); ++l) {
+        max_width_ = std::max(max_width_, topology_[l]);
+    }
+}
+
+
+QuantizedModel::~QuantizedModel(void)
+{
+    weights_.clear();
+    biases_.clear();
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+void
+QuantizedModel::Predict(const double* input_values, double* result_values,
+                        Context& context) const
+{
+    assert(context.values_.size() >= max_width_);
+
+    Forward(input_values, result_values, &context.values_[0],
+            &context.sums_[0], &context.outputs_[0]);
+}
+
+
+void
+QuantizedModel::Predict(const double* input_values,
+                        double* result_values) const
+{
+    static thread_local std::vector<int8_t> values;
+    static thread_local std::vector<int32_t> sums;
+    static thread_local std::vector<double> outputs;
+
+    if (values.size() < max_width_) {
+        values.resize(max_width_);
+        sums.resize(max_width_);
+        outputs.resize(max_width_);
+    }
+    Forward(input_values, result_values, &values[0], &sums[0],
+            &outputs[0]);
+}
+
+
+// ACCESSORS AND MUTATORS ---------------------------------------------
+std::size_t
+QuantizedModel::MemorySize(void) const
+{
+    return weights_.size() * sizeof(int8_t) +
+           biases_.size() * sizeof(int32_t) +
+           (input_scales_.size() + sum_scales_.size()) * sizeof(double);
+}
+
+
+// PRIVATE ============================================================
+
+// OPERATIONS ---------------------------------------------------------
+void
+QuantizedModel::Calibrate(const Net& net, const double* input_values,
+                          std::size_t rows, std::vector<double>& ranges)
+{
+    const std::vector<unsigned>& topology = net.Topology();
+    const std::vector<Layer>& layers = net.Layers();
+    unsigned num_layers = topology.size();
+    unsigned max_width = 0;
+
+    for (unsigned l = 0; l < num_layers; ++l) {
+        max_width = std::max(max_width, topology[l] + 1);
+    }
+    std::vector<double> inputs(max_width), outputs(max_width);
+
+    ranges.assign(num_layers, 0.0f);
+    for (std::size_t r = 0; r < rows; ++r) {
+        const double* row = input_values + r * topology[0];
+
+        for (unsigned i = 0; i < topology[0]; ++i) {
+            inputs[i] = row[i];
+            ranges[0] = std::max(ranges[0], fabs(row[i]));
+        }
+        inputs[topology[0]] = 1.0f;
+
+        // The output layer is not quantized, so it needs no range
+        for (unsigned l = 1; l + 1 < num_layers; ++l) {
+            unsigned num_neurons = topology[l];
+
+            Kernels::MatVec(layers[l].Weights(), &inputs[0], &outputs[0],
+                            num_neurons, topology[l - 1] + 1);
+            ActivationFunction(layers[l].TransferKind())
+                .Forward(&outputs[0], num_neurons);
+            for (unsigned j = 0; j < num_neurons; ++j) {
+                ranges[l] = std::max(ranges[l], fabs(outputs[j]));
+            }
+            outputs[num_neurons] = 1.0f;
+            std::swap(inputs, outputs);
+        }
+    }
+}
+
+
+int8_t
+QuantizedModel::Quantize(double x, double scale)
+{
+    double q = std::min(std::max(x / scale, -127.0), 127.0);
+
+    return (int8_t) lrint(q);
+}
+
+
+void
+QuantizedModel::Forward(const double* input_values, double* result_values,
+                        int8_t* values, int32_t* sums,
+                        double* outputs) const
+{
+    unsigned num_layers = topology_.size();
+
+    for (unsigned i = 0; i < topology_[0]; ++i) {
+        values[i] = Quantize(input_values[i], input_scales_[1]);
+    }
+
+    for (unsigned l = 1; l < num_layers; ++l) {
+        unsigned num_neurons = topology_[l];
+        const int32_t* biases = &biases_[bias_offsets_[l]];
+        bool last = l == num_layers - 1;
+
+        // The last layer writes straight into the caller's buffer
+        if (last) {
+            outputs = result_values;
+        }
+
+        Kernels::MatVec(&weights_[offsets_[l]], values, sums, num_neurons,
+                        topology_[l - 1]);
+        for (unsigned j = 0; j < num_neurons; ++j) {
+            outputs[j] = ((double) sums[j] + biases[j]) * sum_scales_[l];
+        }
+        activations_[l].Forward(outputs, num_neurons);
+
+        if (!last) {
+            for (unsigned j = 0; j < num_neurons; ++j) {
+                values[j] = Quantize(outputs[j], input_scales_[l + 1]);
+            }
+        }
+    }
+}
+
+
+} // ! namespace MinAnn
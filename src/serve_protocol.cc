@@ -0,0 +1,256 @@
+/**
+ * @file serve_protocol.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <serve_protocol.hh>
+
+
+namespace MinAnn {
+
+namespace {
+
+/* Loopback TCP address from "host:port"; false for any other host, so
+ * that the server is only ever reachable locally */
+bool
+ParseTcpAddress(const std::string& address, sockaddr_in& tcp_address)
+{
+    std::size_t colon = address.rfind(':');
+    std::string host = address.substr(0, colon);
+    const char* port = address.c_str() + colon + 1;
+    char* port_end;
+    unsigned long port_num = strtoul(port, &port_end, 10);
+
+    if (*port == '\0' || *port_end != '\0' || port_num > 65535) {
+        return false;
+    }
+    if (!host.empty() && host != "localhost" && host != "127.0.0.1") {
+        return false;
+    }
+
+    memset(&tcp_address, 0, sizeof(tcp_address));
+    tcp_address.sin_family = AF_INET;
+    tcp_address.sin_port = htons((uint16_t) port_num);
+    tcp_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    return true;
+}
+
+
+bool
+ParseUnixAddress(const std::string& address, sockaddr_un& unix_address)
+{
+    memset(&unix_address, 0, sizeof(unix_address));
+    if (address.empty() ||
+        address.size() >= sizeof(unix_address.sun_path)) {
+        return false;
+    }
+    unix_address.sun_family = AF_UNIX;
+    memcpy(unix_address.sun_path, address.c_str(), address.size());
+
+    return true;
+}
+
+
+/* Small requests and responses are not held back waiting for more */
+void
+NoDelay(int fd)
+{
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+} // ! namespace
+
+
+// PUBLIC =============================================================
+
+// OPERATIONS ---------------------------------------------------------
+int
+ServeProtocol::Listen(const std::string& address)
+{
+    int fd;
+
+    if (IsUnixAddress(address)) {
+        sockaddr_un unix_address;
+
+        if (!ParseUnixAddress(address, unix_address) ||
+            (fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+            return -1;
+        }
+        unlink(address.c_str());
+        if (bind(fd, (sockaddr*) &unix_address, sizeof(unix_address)) < 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        sockaddr_in tcp_address;
+        int on = 1;
+
+        if (!ParseTcpAddress(address, tcp_address) ||
+            (fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+            return -1;
+        }
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, (sockaddr*) &tcp_address, sizeof(tcp_address)) < 0) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    if (listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+int
+ServeProtocol::Accept(int listen_fd)
+{
+    for (;;) {
+        int fd = accept(listen_fd, 0, 0);
+
+        if (fd >= 0) {
+            NoDelay(fd);    // Fails harmlessly on Unix sockets
+            return fd;
+        }
+        if (errno != EINTR && errno != ECONNABORTED) {
+            return -1;
+        }
+    }
+}
+
+
+int
+ServeProtocol::Connect(const std::string& address)
+{
+    int fd;
+
+    if (IsUnixAddress(address)) {
+        sockaddr_un unix_address;
+
+        if (!ParseUnixAddress(address, unix_address) ||
+            (fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+            return -1;
+        }
+        if (connect(fd, (sockaddr*) &unix_address,
+                    sizeof(unix_address)) < 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        sockaddr_in tcp_address;
+
+        if (!ParseTcpAddress(address, tcp_address) ||
+            (fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+            return -1;
+        }
+        if (connect(fd, (sockaddr*) &tcp_address,
+                    sizeof(tcp_address)) < 0) {
+            close(fd);
+            return -1;
+        }
+        NoDelay(fd);
+    }
+
+    return fd;
+}
+
+
+bool
+ServeProtocol::ReadFully(int fd, void* data, std::size_t size)
+{
+    char* p = (char*) data;
+
+    while (size > 0) {
+        ssize_t count = recv(fd, p, size, 0);
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        p += count;
+        size -= count;
+    }
+
+    return true;
+}
+
+
+bool
+ServeProtocol::WriteFully(int fd, const void* data, std::size_t size)
+{
+    const char* p = (const char*) data;
+
+    while (size > 0) {
+        // A peer gone away is an error, not a SIGPIPE
+        ssize_t count = send(fd, p, size, MSG_NOSIGNAL);
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        p += count;
+        size -= count;
+    }
+
+    return true;
+}
+
+
+bool
+ServeProtocol::IsUnixAddress(const std::string& address)
+{
+    return address.find(':') == std::string::npos ||
+           address.find('/') != std::string::npos;
+}
+
+
+} // ! namespace MinAnn
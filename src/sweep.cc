@@ -0,0 +1,202 @@
+/**
+ * @file sweep.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <data_set.hh>
+#include <epoch_trainer.hh>
+#include <initializer.hh>
+#include <net.hh>
+#include <sweep.hh>
+#include <thread_pool.hh>
+
+
+namespace MinAnn {
+
+namespace {
+
+// Lower error first; faster first among equals
+bool
+IsBetter(const Sweep::Result& a, const Sweep::Result& b)
+{
+    if (a.error != b.error) {
+        return a.error < b.error;
+    }
+    return a.seconds < b.seconds;
+}
+
+} // ! namespace
+
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+Sweep::Sweep(const DataSet& training_set,
+             const EpochTrainer::Options& options)
+    : training_set_(training_set),
+      validation_set_(0),
+      options_(options)
+{
+}
+
+
+Sweep::Sweep(const DataSet& training_set, const DataSet& validation_set,
+             const EpochTrainer::Options& options)
+    : training_set_(training_set),
+      validation_set_(&validation_set),
+      options_(options)
+{
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+void
+Sweep::Add(const std::vector<unsigned>& hidden, double eta, double alpha)
+{
+    Config config;
+
+    config.topology.push_back(training_set_.Topology().front());
+    config.topology.insert(config.topology.end(),
+                           hidden.begin(), hidden.end());
+    config.topology.push_back(training_set_.Topology().back());
+    config.eta = eta;
+    config.alpha = alpha;
+    configs_.push_back(config);
+}
+
+
+void
+Sweep::AddGrid(const std::vector<std::vector<unsigned> >& hidden,
+               const std::vector<double>& etas,
+               const std::vector<double>& alphas)
+{
+    for (unsigned h = 0; h < hidden.size(); ++h) {
+        for (unsigned e = 0; e < etas.size(); ++e) {
+            for (unsigned a = 0; a < alphas.size(); ++a) {
+                Add(hidden[h], etas[e], alphas[a]);
+            }
+        }
+    }
+}
+
+
+std::vector<Sweep::Result>
+Sweep::Run(unsigned num_threads, uint64_t seed) const
+{
+    std::vector<Result> results(configs_.size());
+    std::atomic<unsigned> next(0);
+    ThreadPool pool(std::max(1u, std::min<unsigned>(num_threads,
+                                                    configs_.size())));
+
+    // Configurations are handed out one at a time, as threads free up
+    pool.Run([&](unsigned) {
+        for (unsigned c = next++; c < configs_.size(); c = next++) {
+            results[c] = Train(configs_[c], seed);
+        }
+    });
+
+    std::stable_sort(results.begin(), results.end(), IsBetter);
+
+    return results;
+}
+
+
+void
+Sweep::Print(const std::vector<Result>& results, std::FILE* file)
+{
+    std::fprintf(file, "%4s  %-20s %8s %8s %12s %7s %10s\n",
+                 "rank", "topology", "eta", "alpha", "error", "epochs",
+                 "seconds");
+
+    for (unsigned r = 0; r < results.size(); ++r) {
+        const Result& result = results[r];
+        std::string topology;
+
+        for (unsigned l = 0; l < result.config.topology.size(); ++l) {
+            char size[16];
+
+            std::snprintf(size, sizeof(size), l == 0 ? "%u" : "-%u",
+                          result.config.topology[l]);
+            topology += size;
+        }
+        std::fprintf(file, "%4u  %-20s %8.4f %8.4f %12.6g %7u %10.3f\n",
+                     r + 1, topology.c_str(), result.config.eta,
+                     result.config.alpha, result.error, result.epochs,
+                     result.seconds);
+    }
+}
+
+
+// PRIVATE ============================================================
+
+// OPERATIONS ---------------------------------------------------------
+Sweep::Result
+Sweep::Train(const Config& config, uint64_t seed) const
+{
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    std::vector<Activation> activations(config.topology.size(), kTanh);
+    Net net(config.topology, activations, Initializer(seed));
+
+    net.LearningRate(config.eta);
+    net.Momentum(config.alpha);
+
+    Result result;
+    result.config = config;
+
+    if (validation_set_ != 0) {
+        EpochTrainer trainer(net, training_set_, *validation_set_,
+                             options_);
+        result.epochs = trainer.Train();
+        result.error = trainer.BestError();
+    } else {
+        EpochTrainer trainer(net, training_set_, options_);
+        result.epochs = trainer.Train();
+        result.error = EpochTrainer::Error(net, training_set_);
+    }
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+
+    return result;
+}
+
+
+} // ! namespace MinAnn
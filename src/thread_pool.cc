@@ -0,0 +1,121 @@
+/**
+ * @file thread_pool.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <thread_pool.hh>
+
+
+namespace MinAnn {
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+ThreadPool::ThreadPool(unsigned num_threads)
+    : task_(0),
+      generation_(0),
+      pending_(0),
+      stop_(false)
+{
+    for (unsigned i = 1; i < num_threads; ++i) {
+        workers_.push_back(std::thread(&ThreadPool::Work, this, i));
+    }
+}
+
+
+ThreadPool::~ThreadPool(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+
+    for (unsigned i = 0; i < workers_.size(); ++i) {
+        workers_[i].join();
+    }
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+void
+ThreadPool::Run(const Task& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        pending_ = workers_.size();
+        ++generation_;
+    }
+    start_.notify_all();
+
+    task(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (pending_ > 0) {
+        done_.wait(lock);
+    }
+    task_ = 0;
+}
+
+
+// PRIVATE ============================================================
+
+// OPERATIONS ---------------------------------------------------------
+void
+ThreadPool::Work(unsigned index)
+{
+    unsigned long seen = 0;
+
+    for (;;) {
+        const Task* task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stop_ && generation_ == seen) {
+                start_.wait(lock);
+            }
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+            task = task_;
+        }
+
+        (*task)(index);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pending_ == 0) {
+            done_.notify_one();
+        }
+    }
+}
+
+
+} // ! namespace MinAnn
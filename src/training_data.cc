@@ -0,0 +1,363 @@
+/**
+ * @file training_data.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <profiler.hh>
+#include <training_data.hh>
+
+
+namespace {
+
+// Powers of ten that are exact as doubles
+const double kPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Integers up to this one are exact as doubles
+const uint64_t kMaxExactMantissa = (uint64_t) 1 << 53;
+
+
+inline bool
+IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+
+inline bool
+IsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+
+inline const char*
+SkipSpaces(const char* p, const char* end)
+{
+    while (p < end && IsSpace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+
+/* Parse a decimal number at the start of [p, end).  A number whose
+ * significant digits fit in an integer mantissa of at most 2^53 (about
+ * 16 digits, trailing zeros aside) and whose decimal exponent is within
+ * +/-22, or a larger one that still leaves the mantissa times the
+ * excess power below 2^53, is built with a single correctly rounded
+ * operation, the same double strtod() gives.  Any other number (more
+ * significant digits, or an exponent below -22 or too large) is handed
+ * to strtod() on purpose: rounding those right takes big integer or
+ * 128 bit arithmetic, and they are rare in training data.  Returns
+ * false, not moving p, if there is no number */
+bool
+ParseDouble(const char*& p, const char* end, double& value)
+{
+    const char* s = p;
+    bool negative = false;
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    bool any = false;
+    bool exact = true;
+
+    if (s < end && (*s == '-' || *s == '+')) {
+        negative = *s == '-';
+        ++s;
+    }
+
+    for (; s < end && IsDigit(*s); ++s) {
+        if (exact && mantissa <= (kMaxExactMantissa - 9) / 10) {
+            mantissa = mantissa * 10 + (*s - '0');
+        } else {
+            ++exponent;
+            exact = exact && *s == '0';
+        }
+        any = true;
+    }
+
+    if (s < end && *s == '.') {
+        for (++s; s < end && IsDigit(*s); ++s) {
+            if (exact && mantissa <= (kMaxExactMantissa - 9) / 10) {
+                mantissa = mantissa * 10 + (*s - '0');
+                --exponent;
+            } else {
+                exact = exact && *s == '0';
+            }
+            any = true;
+        }
+    }
+
+    if (!any) {
+        return false;
+    }
+
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        const char* e = s + 1;
+        bool negative_exponent = false;
+        int value_exponent = 0;
+
+        if (e < end && (*e == '-' || *e == '+')) {
+            negative_exponent = *e == '-';
+            ++e;
+        }
+        if (e < end && IsDigit(*e)) {
+            for (; e < end && IsDigit(*e); ++e) {
+                if (value_exponent < 10000) {
+                    value_exponent = value_exponent * 10 + (*e - '0');
+                }
+            }
+            exponent += negative_exponent ? -value_exponent : value_exponent;
+            s = e;
+        }
+    }
+
+    // Shift the excess of a large exponent into the mantissa while it
+    // stays exact, so that 1e25 and alike take the fast path too
+    for (; exact && exponent > 22 && mantissa != 0 &&
+             mantissa <= kMaxExactMantissa / 10;
+         --exponent) {
+        mantissa *= 10;
+    }
+
+    if (exact && exponent >= -22 && exponent <= 22) {
+        value = exponent < 0
+            ? mantissa / kPowersOfTen[-exponent]
+            : mantissa * kPowersOfTen[exponent];
+    } else {
+        std::string token(p, s);
+        value = std::fabs(strtod(token.c_str(), 0));
+    }
+
+    if (negative) {
+        value = -value;
+    }
+    p = s;
+
+    return true;
+}
+
+
+bool
+ParseUnsigned(const char*& p, const char* end, unsigned& value)
+{
+    const char* s = p;
+
+    value = 0;
+    for (; s < end && IsDigit(*s); ++s) {
+        value = value * 10 + (*s - '0');
+    }
+    if (s == p) {
+        return false;
+    }
+    p = s;
+
+    return true;
+}
+
+} // ! namespace
+
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+TrainingData::TrainingData(const std::string filename)
+    : training_data_file_(std::fopen(filename.c_str(), "rb")),
+      buffer_(kBufferSize),
+      begin_(0),
+      end_(0),
+      file_eof_(training_data_file_ == 0),
+      bytes_read_(0)
+{
+}
+
+
+TrainingData::~TrainingData(void)
+{
+    if (training_data_file_ != 0) {
+        std::fclose(training_data_file_);
+    }
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+bool
+TrainingData::IsEof(void)
+{
+    if (begin_ == end_ && !file_eof_) {
+        Fill();
+    }
+    return begin_ == end_ && file_eof_;
+}
+
+
+void
+TrainingData::Topology(std::vector<unsigned>& topology)
+{
+    const char* p;
+    const char* end;
+    const char label[] = "Topology:";
+
+    if (!NextLine(p, end)) {
+        abort();
+    }
+    p = SkipSpaces(p, end);
+    if ((std::size_t) (end - p) < sizeof(label) - 1 ||
+        memcmp(p, label, sizeof(label) - 1) != 0) {
+        abort();
+    }
+    p += sizeof(label) - 1;
+
+    unsigned n;
+    for (p = SkipSpaces(p, end);
+         ParseUnsigned(p, end, n);
+         p = SkipSpaces(p, end)) {
+        topology.push_back(n);
+    }
+}
+
+
+unsigned
+TrainingData::NextInputs(std::vector<double>& input_values)
+{
+    return NextValues("i:", input_values);
+}
+
+
+unsigned
+TrainingData::TargetOutputs(std::vector<double>& target_output_values)
+{
+    return NextValues("o:", target_output_values);
+}
+
+
+// PRIVATE ============================================================
+
+// OPERATIONS ---------------------------------------------------------
+unsigned
+TrainingData::NextValues(const char* label, std::vector<double>& values)
+{
+    const char* p;
+    const char* end;
+    std::size_t label_size = strlen(label);
+    MINANN_PROFILE_SCOPE(kParse, 0);
+
+    values.clear();
+    if (!NextLine(p, end)) {
+        return 0;
+    }
+
+    // The label must be a whole word
+    p = SkipSpaces(p, end);
+    if ((std::size_t) (end - p) < label_size ||
+        memcmp(p, label, label_size) != 0 ||
+        (p + label_size < end && !IsSpace(p[label_size]))) {
+        return 0;
+    }
+
+    double value;
+    for (p = SkipSpaces(p + label_size, end);
+         ParseDouble(p, end, value);
+         p = SkipSpaces(p, end)) {
+        values.push_back(value);
+    }
+
+    return values.size();
+}
+
+
+bool
+TrainingData::NextLine(const char*& line, const char*& line_end)
+{
+    std::size_t scanned = begin_;
+
+    for (;;) {
+        const char* newline = (const char*)
+            memchr(&buffer_[0] + scanned, '\n', end_ - scanned);
+
+        if (newline != 0) {
+            line = &buffer_[0] + begin_;
+            line_end = newline;
+            bytes_read_ += newline + 1 - line;
+            begin_ = newline + 1 - &buffer_[0];
+            return true;
+        }
+
+        if (file_eof_) {
+            // Last line, with no end of line
+            if (begin_ == end_) {
+                return false;
+            }
+            line = &buffer_[0] + begin_;
+            line_end = &buffer_[0] + end_;
+            bytes_read_ += end_ - begin_;
+            begin_ = end_;
+            return true;
+        }
+
+        scanned = end_ - begin_;
+        Fill();
+    }
+}
+
+
+void
+TrainingData::Fill(void)
+{
+    // Keep the unparsed tail at the front, growing for very long lines
+    std::size_t pending = end_ - begin_;
+    if (begin_ > 0) {
+        memmove(&buffer_[0], &buffer_[0] + begin_, pending);
+    }
+    if (pending == buffer_.size()) {
+        buffer_.resize(2 * buffer_.size());
+    }
+    begin_ = 0;
+    end_ = pending;
+
+    std::size_t count = std::fread(&buffer_[0] + end_, 1,
+                                   buffer_.size() - end_,
+                                   training_data_file_);
+    end_ += count;
+    MINANN_PROFILE_COUNT(kBytesParsed, count);
+    if (count == 0) {
+        file_eof_ = true;
+    }
+}
@@ -0,0 +1,126 @@
+/**
+ * @file workspace.cc
+ */
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <workspace.hh>
+
+
+namespace MinAnn {
+
+// PUBLIC =============================================================
+
+// LIFE CYCLE ---------------------------------------------------------
+template <typename T>
+BasicWorkspace<T>::BasicWorkspace(const std::vector<unsigned>& topology,
+                                  unsigned capacity)
+    : capacity_(capacity),
+      num_samples_(0)
+{
+    unsigned num_layers = topology.size();
+    unsigned max_neurons = 0;
+
+    outputs_.resize(num_layers);
+    gradients_.resize(num_layers);
+    weight_gradients_.resize(num_layers);
+
+    for (unsigned layer_num = 0; layer_num < num_layers; ++layer_num) {
+        unsigned width = topology[layer_num] + 1;
+
+        outputs_[layer_num].assign(capacity * width, 0.0f);
+        gradients_[layer_num].assign(capacity * width, 0.0f);
+        if (layer_num > 0) {
+            weight_gradients_[layer_num].assign(
+                    topology[layer_num] * (topology[layer_num - 1] + 1),
+                    0.0f);
+        }
+        max_neurons = std::max(max_neurons, topology[layer_num]);
+    }
+
+    scratch_.assign(capacity * max_neurons, 0.0f);
+    errors_.reserve(capacity);
+}
+
+
+template <typename T>
+BasicWorkspace<T>::~BasicWorkspace(void)
+{
+    outputs_.clear();
+    gradients_.clear();
+    weight_gradients_.clear();
+}
+
+
+// OPERATIONS ---------------------------------------------------------
+template <typename T>
+void
+BasicWorkspace<T>::Clear(void)
+{
+    for (unsigned l = 0; l < weight_gradients_.size(); ++l) {
+        std::fill(weight_gradients_[l].begin(),
+                  weight_gradients_[l].end(), 0.0f);
+    }
+    errors_.clear();
+    num_samples_ = 0;
+}
+
+
+template <typename T>
+void
+BasicWorkspace<T>::Accumulate(const BasicWorkspace& other)
+{
+    assert(other.weight_gradients_.size() == weight_gradients_.size());
+
+    for (unsigned l = 0; l < weight_gradients_.size(); ++l) {
+        std::vector<T>& sum = weight_gradients_[l];
+        const std::vector<T>& add = other.weight_gradients_[l];
+
+        assert(sum.size() == add.size());
+        for (unsigned i = 0; i < sum.size(); ++i) {
+            sum[i] += add[i];
+        }
+    }
+
+    errors_.insert(errors_.end(), other.errors_.begin(),
+                   other.errors_.end());
+    num_samples_ += other.num_samples_;
+}
+
+
+// Single and double precision workspaces
+template class BasicWorkspace<float>;
+template class BasicWorkspace<double>;
+
+
+} // ! namespace MinAnn
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Convert text training data to a binary training file.
+ *
+ * Usage: minann-convert [-f] [-c samples] input.dat output.bin
+ *
+ *   -f          store values as floats instead of doubles
+ *   -c samples  samples per chunk (4096 by default)
+ *
+ * The binary file is read back by 'BinaryTrainingData', which maps it
+ * and uses the samples in place instead of parsing them.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <binary_training_data.hh>
+#include <training_data.hh>
+
+
+namespace {
+
+const unsigned long kDefaultChunkSize = 4096;
+
+
+int
+Usage(const char* program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [-f] [-c samples] input.dat output.bin\n",
+                 program);
+    return 2;
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(int argc, char* argv[])
+{
+    unsigned value_size = sizeof(double);
+    unsigned long chunk_size = kDefaultChunkSize;
+    int arg = 1;
+
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        if (strcmp(argv[arg], "-f") == 0) {
+            value_size = sizeof(float);
+        } else if (strcmp(argv[arg], "-c") == 0 && arg + 1 < argc) {
+            chunk_size = strtoul(argv[++arg], 0, 10);
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+    if (argc - arg != 2 || chunk_size == 0) {
+        return Usage(argv[0]);
+    }
+
+    TrainingData training_data(argv[arg]);
+    unsigned long samples =
+        BinaryTrainingData::Convert(training_data, argv[arg + 1],
+                                    value_size, chunk_size);
+    if (samples == 0) {
+        std::fprintf(stderr, "%s: could not convert '%s' to '%s'\n",
+                     argv[0], argv[arg], argv[arg + 1]);
+        return 1;
+    }
+
+    std::printf("%s: %lu samples, %s values, %lu samples per chunk\n",
+                argv[arg + 1], samples,
+                value_size == sizeof(float) ? "float" : "double",
+                chunk_size);
+
+    return 0;
+}
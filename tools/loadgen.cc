@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Put an inference server under load.
+ *
+ * Usage: minann-loadgen [-c connections] [-n requests] [-r rows] address
+ *
+ *   -c connections  concurrent clients, one thread each (8 by default)
+ *   -n requests     sent by every client, one after the other (10000 by
+ *                   default)
+ *   -r rows         random samples per request (1 by default)
+ *
+ * Prints the requests per second and the latencies seen by the clients,
+ * then the counters of the server.  Fails if any request fails or any
+ * output is not finite.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <inference_client.hh>
+#include <serve_protocol.hh>
+
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const unsigned kDefaultConnections = 8;
+const unsigned long kDefaultRequests = 10000;
+const unsigned kDefaultRows = 1;
+
+
+int
+Usage(const char* program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [-c connections] [-n requests] [-r rows] "
+                 "address\n",
+                 program);
+    return 2;
+}
+
+
+/* One client, recording the latency of every request in
+ * microseconds; false if any request failed */
+bool
+RunClient(const char* address, unsigned client, unsigned long requests,
+          unsigned rows, std::vector<float>& latencies_us)
+{
+    MinAnn::InferenceClient inference_client(address);
+    bool ok = inference_client.IsOpen();
+
+    if (!ok) {
+        return false;
+    }
+
+    std::mt19937 rng(client + 1);
+    std::uniform_real_distribution<double> uniform(0.0f, 1.0f);
+    std::vector<double> input_values(rows * inference_client.NumInputs());
+    std::vector<double> result_values(rows *
+                                      inference_client.NumOutputs());
+
+    latencies_us.reserve(requests);
+    for (unsigned long r = 0; r < requests && ok; ++r) {
+        for (std::size_t i = 0; i < input_values.size(); ++i) {
+            input_values[i] = uniform(rng);
+        }
+
+        Clock::time_point start = Clock::now();
+        ok = inference_client.Predict(&input_values[0], rows,
+                                      &result_values[0]);
+        latencies_us.push_back(std::chrono::duration<float, std::micro>(
+            Clock::now() - start).count());
+
+        for (std::size_t o = 0; o < result_values.size() && ok; ++o) {
+            ok = std::isfinite(result_values[o]);
+        }
+    }
+
+    return ok;
+}
+
+
+float
+Percentile(std::vector<float>& values, unsigned percent)
+{
+    std::size_t n = values.size() * percent / 100;
+
+    std::nth_element(values.begin(), values.begin() + n, values.end());
+    return values[n];
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(int argc, char* argv[])
+{
+    unsigned connections = kDefaultConnections;
+    unsigned long requests = kDefaultRequests;
+    unsigned rows = kDefaultRows;
+    int arg = 1;
+
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        if (strcmp(argv[arg], "-c") == 0 && arg + 1 < argc) {
+            connections = strtoul(argv[++arg], 0, 10);
+        } else if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+            requests = strtoul(argv[++arg], 0, 10);
+        } else if (strcmp(argv[arg], "-r") == 0 && arg + 1 < argc) {
+            rows = strtoul(argv[++arg], 0, 10);
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+    if (argc - arg != 1 || connections == 0 || requests == 0 ||
+        rows == 0 || rows > MinAnn::ServeProtocol::kMaxRows) {
+        return Usage(argv[0]);
+    }
+    const char* address = argv[arg];
+
+    std::vector<std::vector<float> > latencies_us(connections);
+    std::vector<char> ok(connections, false);
+    std::vector<std::thread> clients;
+
+    Clock::time_point start = Clock::now();
+    for (unsigned c = 0; c < connections; ++c) {
+        clients.push_back(std::thread([&, c]() {
+            ok[c] = RunClient(address, c, requests, rows, latencies_us[c]);
+        }));
+    }
+    for (unsigned c = 0; c < connections; ++c) {
+        clients[c].join();
+    }
+    double seconds = std::chrono::duration<double>(
+        Clock::now() - start).count();
+
+    std::vector<float> all_latencies_us;
+    unsigned failed = 0;
+    for (unsigned c = 0; c < connections; ++c) {
+        failed += !ok[c];
+        all_latencies_us.insert(all_latencies_us.end(),
+                                latencies_us[c].begin(),
+                                latencies_us[c].end());
+    }
+    if (all_latencies_us.empty()) {
+        std::fprintf(stderr, "%s: could not send a request to '%s'\n",
+                     argv[0], address);
+        return 1;
+    }
+
+    std::printf("client: %lu requests of %u rows over %u connections in "
+                "%.2f s, %.0f qps, p50 %.0f us, p99 %.0f us\n",
+                (unsigned long) all_latencies_us.size(), rows, connections,
+                seconds, all_latencies_us.size() / seconds,
+                Percentile(all_latencies_us, 50),
+                Percentile(all_latencies_us, 99));
+
+    MinAnn::InferenceClient inference_client(address);
+    MinAnn::ServeProtocol::ServerStats stats;
+    if (inference_client.Stats(stats)) {
+        std::printf("server: %lu requests, %lu rows in %lu batches "
+                    "(%.2f rows each), %.0f qps overall, p50 %.0f us, "
+                    "p99 %.0f us\n",
+                    (unsigned long) stats.requests,
+                    (unsigned long) stats.rows,
+                    (unsigned long) stats.batches,
+                    stats.batches > 0 ? (double) stats.rows / stats.batches
+                                      : 0.0f,
+                    stats.qps, stats.p50_us, stats.p99_us);
+    }
+
+    if (failed > 0) {
+        std::fprintf(stderr, "%s: %u of %u connections failed\n",
+                     argv[0], failed, connections);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2019, J. A. Corbal
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY
+ * WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+/*
+ * Serve predictions of a saved model over a local socket.
+ *
+ * Usage: minann-serve [-b rows] [-l microseconds] [-r seconds]
+ *                     model.bin address
+ *
+ *   -b rows          largest micro-batch (256 by default)
+ *   -l microseconds  longest a request waits for others to join its
+ *                    batch (200 by default)
+ *   -r seconds       report interval on the standard error, 0 for
+ *                    none (10 by default)
+ *
+ * The address is a Unix socket path, or "127.0.0.1:port" for TCP.  The
+ * model is a file written by 'Net::Save()'.  Serves until interrupted,
+ * then prints the final counters; 'minann-loadgen' puts it under load.
+ */
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <signal.h>
+
+#include <inference_model.hh>
+#include <inference_server.hh>
+#include <serve_protocol.hh>
+
+
+namespace {
+
+const unsigned kDefaultReportSeconds = 10;
+
+
+int
+Usage(const char* program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [-b rows] [-l microseconds] [-r seconds] "
+                 "model.bin address\n",
+                 program);
+    return 2;
+}
+
+
+/* Requests per second since the last report; the counters themselves
+ * are totals since the server started */
+void
+Report(const MinAnn::ServeProtocol::ServerStats& stats,
+       const MinAnn::ServeProtocol::ServerStats& last)
+{
+    double seconds = stats.seconds - last.seconds;
+    double qps = seconds > 0.0f
+        ? (stats.requests - last.requests) / seconds : 0.0f;
+
+    std::fprintf(stderr,
+                 "server: %lu requests, %lu rows in %lu batches "
+                 "(%.2f rows each), %lu connections, %.0f qps "
+                 "(%.0f overall), p50 %.0f us, p99 %.0f us\n",
+                 (unsigned long) stats.requests,
+                 (unsigned long) stats.rows,
+                 (unsigned long) stats.batches,
+                 stats.batches > 0 ? (double) stats.rows / stats.batches
+                                   : 0.0f,
+                 (unsigned long) stats.connections, qps, stats.qps,
+                 stats.p50_us, stats.p99_us);
+}
+
+} // ! namespace
+
+
+// Main entry
+int main(int argc, char* argv[])
+{
+    MinAnn::InferenceServer::Options options;
+    unsigned long report_seconds = kDefaultReportSeconds;
+    int arg = 1;
+
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        if (strcmp(argv[arg], "-b") == 0 && arg + 1 < argc) {
+            options.max_batch_rows = strtoul(argv[++arg], 0, 10);
+        } else if (strcmp(argv[arg], "-l") == 0 && arg + 1 < argc) {
+            options.budget_us = strtoul(argv[++arg], 0, 10);
+        } else if (strcmp(argv[arg], "-r") == 0 && arg + 1 < argc) {
+            report_seconds = strtoul(argv[++arg], 0, 10);
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+    if (argc - arg != 2 || options.max_batch_rows == 0) {
+        return Usage(argv[0]);
+    }
+
+    MinAnn::InferenceModel model(argv[arg]);
+    if (!model.IsOpen()) {
+        std::fprintf(stderr, "%s: could not load model '%s'\n",
+                     argv[0], argv[arg]);
+        return 1;
+    }
+
+    /* Signals are taken synchronously below; blocked before any thread
+     * starts, so that none of the server's threads receives them */
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, 0);
+
+    MinAnn::InferenceServer server(model, options);
+    if (!server.Start(argv[arg + 1])) {
+        std::fprintf(stderr, "%s: could not listen on '%s'\n",
+                     argv[0], argv[arg + 1]);
+        return 1;
+    }
+    std::fprintf(stderr, "%s: serving '%s' (%u inputs, %u outputs) on "
+                 "'%s'\n", argv[0], argv[arg], model.NumInputs(),
+                 model.NumOutputs(), argv[arg + 1]);
+
+    MinAnn::ServeProtocol::ServerStats last = server.Stats();
+    for (;;) {
+        int signal_num;
+
+        if (report_seconds == 0) {
+            sigwait(&signals, &signal_num);
+            break;
+        }
+
+        timespec timeout = { (time_t) report_seconds, 0 };
+        if (sigtimedwait(&signals, 0, &timeout) >= 0) {
+            break;
+        }
+
+        MinAnn::ServeProtocol::ServerStats stats = server.Stats();
+        Report(stats, last);
+        last = stats;
+    }
+
+    server.Stop();
+    Report(server.Stats(), MinAnn::ServeProtocol::ServerStats());
+
+    return 0;
+}